@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstring>
+
+// Starting value for a fingerprint (the FNV-1a 64 bit offset basis)
+constexpr unsigned long long FingerprintSeed = 14695981039346656037ULL;
+
+// Mixes the exact bits of an array of 4 byte values (floats, ints) into a fingerprint, FNV-1a over 32 bit words instead of bytes.
+// Used to detect data that didn't change since last frame, equal data always gives equal fingerprints. -0.0f and 0.0f differ.
+inline unsigned long long Fingerprint(const void* words, unsigned int numbWords, unsigned long long fingerprint) {
+	const unsigned long long prime = 1099511628211ULL;
+	const unsigned char* bytes = (const unsigned char*) words;
+	for (unsigned int i = 0; i < numbWords; i++) {
+		unsigned int word;
+		memcpy(&word, bytes + i * 4, 4);
+		fingerprint = (fingerprint ^ word) * prime;
+	}
+	return fingerprint;
+}
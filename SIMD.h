@@ -0,0 +1,62 @@
+#pragma once
+
+// What the SIMD kernels (skinning, batched FABRIK, batched rays) share: which instruction sets the compiler can emit,
+// and which ones the CPU running the program has.
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC lets any function use AVX2 intrinsics, other compilers need to be told which functions may use them
+#if defined(SIMD_X86) && !defined(_MSC_VER)
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SIMD_TARGET_AVX2
+#endif
+
+// Floats in the widest register a kernel uses (AVX2). Batches are padded to a multiple of it so the kernels never need a leftover loop.
+constexpr unsigned int SIMDWidestLanes = 8;
+
+enum class SIMDLevel {
+	Scalar,
+	SSE,
+	AVX2
+};
+
+inline SIMDLevel DetectSIMDLevel() {
+#if defined(SIMD_X86)
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	int highestLeaf = info[0];
+	__cpuid(info, 1);
+	bool hasSSE = (info[3] & (1 << 25)) != 0;
+	bool hasOSXSAVE = (info[2] & (1 << 27)) != 0;
+	bool hasAVX = (info[2] & (1 << 28)) != 0;
+	bool hasAVX2 = false;
+	if (highestLeaf >= 7) {
+		__cpuidex(info, 7, 0);
+		hasAVX2 = (info[1] & (1 << 5)) != 0;
+	}
+	// the OS has to save the upper halves of the ymm registers on a context switch, or AVX can't be used
+	bool osSavesYMM = hasOSXSAVE && hasAVX && (_xgetbv(0) & 0x6) == 0x6;
+	if (hasAVX2 && osSavesYMM) { return SIMDLevel::AVX2; }
+	if (hasSSE) { return SIMDLevel::SSE; }
+#else
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) { return SIMDLevel::AVX2; }
+	if (__builtin_cpu_supports("sse")) { return SIMDLevel::SSE; }
+#endif
+#endif
+	return SIMDLevel::Scalar;
+}
+
+// The widest instruction set the CPU running the program supports. Checked once and cached.
+inline SIMDLevel GetSIMDLevel() {
+	static const SIMDLevel level = DetectSIMDLevel();
+	return level;
+}
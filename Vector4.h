@@ -23,3 +23,5 @@ struct TVec4 {
 typedef TVec4<float> f4;
 typedef TVec4<int> i4;
 typedef TVec4<unsigned int> ui4;
+typedef TVec4<unsigned short> us4; // compact bone indices for big rigs, or 16 bit normalized bone weights
+typedef TVec4<unsigned char> ub4; // compact bone indices, or 8 bit normalized bone weights
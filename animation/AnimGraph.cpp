@@ -0,0 +1,747 @@
+#include "AnimGraph.h"
+#include <iostream>
+#include <cmath>
+#include "Blending.h"
+
+namespace anim {
+
+	template IAnimGraph<Clip>;
+	template IAnimGraph<QuickClip>;
+	template IAnimGraphInstance<Clip>;
+	template IAnimGraphInstance<QuickClip>;
+
+	// === helpers ===
+
+	/// <summary>
+	/// Same as Blend, but uses a precomputed bone mask instead of walking the bone hierarchy for every bone.
+	/// </summary>
+	static void BlendMasked(Pose& poseOut, Pose& a, Pose& b, float t, const std::vector<unsigned char>* mask) {
+		unsigned int numbBones = poseOut.Size();
+		for (unsigned int bone = 0; bone < numbBones; bone++) {
+			if (mask != NULL && (*mask)[bone] == 0) { continue; }
+			poseOut.SetLocalTransform(bone, transforms::mix(a.GetLocalTransform(bone), b.GetLocalTransform(bone), t));
+		}
+	}
+
+	/// <summary>
+	/// Same as AddToPose with a weight, but uses a precomputed bone mask.
+	/// </summary>
+	static void AddMasked(Pose& poseOut, Pose& poseToAdd, Pose& baseAddPose, float weight, const std::vector<unsigned char>* mask) {
+		unsigned int numbBones = poseOut.Size();
+		for (unsigned int bone = 0; bone < numbBones; bone++) {
+			if (mask != NULL && (*mask)[bone] == 0) { continue; }
+			transforms::srt input = poseOut.GetLocalTransform(bone);
+			transforms::srt add = poseToAdd.GetLocalTransform(bone);
+			transforms::srt addBase = baseAddPose.GetLocalTransform(bone);
+			transforms::srt result(
+				input.position + (add.position - addBase.position),
+				normalized(input.rotation * (inverse(addBase.rotation) * add.rotation)),
+				input.scale + (add.scale - addBase.scale)
+			);
+			if (weight < 1.0f) {
+				result = transforms::mix(input, result, weight);
+			}
+			poseOut.SetLocalTransform(bone, result);
+		}
+	}
+
+	static void CopyMasked(Pose& poseOut, Pose& in, const std::vector<unsigned char>& mask) {
+		unsigned int numbBones = poseOut.Size();
+		for (unsigned int bone = 0; bone < numbBones; bone++) {
+			if (mask[bone] == 0) { continue; }
+			poseOut.SetLocalTransform(bone, in.GetLocalTransform(bone));
+		}
+	}
+
+	static float Clamp01(float value) {
+		return value > 1.0f ? 1.0f : (value < 0.0f ? 0.0f : value);
+	}
+
+	// === graph definition ===
+
+	template<typename CLIPTYPE>
+	IAnimGraph<CLIPTYPE>::IAnimGraph() {
+		this->numbSlots = 0;
+		this->numbClipNodes = 0;
+		this->numbIKNodes = 0;
+		this->numbStateMachines = 0;
+		this->isCompiled = false;
+	}
+
+	template<typename CLIPTYPE>
+	IAnimGraph<CLIPTYPE>::IAnimGraph(const Armature& armature) {
+		this->numbSlots = 0;
+		this->numbClipNodes = 0;
+		this->numbIKNodes = 0;
+		this->numbStateMachines = 0;
+		this->isCompiled = false;
+		this->SetArmature(armature);
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimGraph<CLIPTYPE>::SetArmature(const Armature& armature) {
+		this->restPose = armature.GetRestPose();
+		// masks depend on the bone hierarchy
+		this->isCompiled = false;
+	}
+
+	template<typename CLIPTYPE>
+	unsigned int IAnimGraph<CLIPTYPE>::AddNode(const AnimGraphNode& node) {
+		this->nodes.push_back(node);
+		this->isCompiled = false;
+		return (unsigned int) this->nodes.size() - 1;
+	}
+
+	template<typename CLIPTYPE>
+	unsigned int IAnimGraph<CLIPTYPE>::AddParameter(const std::string& name, float defaultValue) {
+		this->parameterNames.push_back(name);
+		this->parameterDefaults.push_back(defaultValue);
+		return (unsigned int) this->parameterNames.size() - 1;
+	}
+
+	template<typename CLIPTYPE>
+	int IAnimGraph<CLIPTYPE>::FindParameter(const std::string& name) {
+		unsigned int numbParameters = this->parameterNames.size();
+		for (unsigned int i = 0; i < numbParameters; i++) {
+			if (this->parameterNames[i] == name) { return (int) i; }
+		}
+		return -1;
+	}
+
+	template<typename CLIPTYPE>
+	unsigned int IAnimGraph<CLIPTYPE>::AddClip(const CLIPTYPE* clip, int timeParameter) {
+		AnimGraphNode node;
+		node.type = AnimGraphNodeType::Clip;
+		node.clip = (unsigned int) this->clips.size();
+		node.timeParameter = timeParameter;
+		node.inputA = node.inputB = 0;
+		node.weightParameter = -1;
+		node.rootBone = -1;
+		node.mask = -1;
+		node.runtimeIndex = this->numbClipNodes++;
+		this->clips.push_back(clip);
+		return this->AddNode(node);
+	}
+
+	template<typename CLIPTYPE>
+	unsigned int IAnimGraph<CLIPTYPE>::AddBlend(unsigned int a, unsigned int b, int weightParameter, int rootBone) {
+		AnimGraphNode node;
+		node.type = AnimGraphNodeType::Blend;
+		node.clip = 0;
+		node.timeParameter = -1;
+		node.inputA = a;
+		node.inputB = b;
+		node.weightParameter = weightParameter;
+		node.rootBone = rootBone;
+		node.mask = -1;
+		node.runtimeIndex = 0;
+		return this->AddNode(node);
+	}
+
+	template<typename CLIPTYPE>
+	unsigned int IAnimGraph<CLIPTYPE>::AddAdditive(unsigned int base, unsigned int additive, const Pose& referencePose, int weightParameter, int rootBone) {
+		AnimGraphNode node;
+		node.type = AnimGraphNodeType::Additive;
+		node.clip = 0;
+		node.timeParameter = -1;
+		node.inputA = base;
+		node.inputB = additive;
+		node.weightParameter = weightParameter;
+		node.rootBone = rootBone;
+		node.mask = -1;
+		node.runtimeIndex = (unsigned int) this->referencePoses.size();
+		this->referencePoses.push_back(referencePose);
+		return this->AddNode(node);
+	}
+
+	template<typename CLIPTYPE>
+	unsigned int IAnimGraph<CLIPTYPE>::AddMask(unsigned int a, unsigned int b, unsigned int rootBone) {
+		AnimGraphNode node;
+		node.type = AnimGraphNodeType::Mask;
+		node.clip = 0;
+		node.timeParameter = -1;
+		node.inputA = a;
+		node.inputB = b;
+		node.weightParameter = -1;
+		node.rootBone = (int) rootBone;
+		node.mask = -1;
+		node.runtimeIndex = 0;
+		return this->AddNode(node);
+	}
+
+	template<typename CLIPTYPE>
+	unsigned int IAnimGraph<CLIPTYPE>::AddIK(unsigned int input, const std::vector<unsigned int>& boneChain, int weightParameter) {
+		AnimGraphNode node;
+		node.type = AnimGraphNodeType::IK;
+		node.clip = 0;
+		node.timeParameter = -1;
+		node.inputA = input;
+		node.inputB = 0;
+		node.weightParameter = weightParameter;
+		node.rootBone = -1;
+		node.mask = -1;
+		node.children = boneChain;
+		node.runtimeIndex = this->numbIKNodes++;
+		return this->AddNode(node);
+	}
+
+	template<typename CLIPTYPE>
+	unsigned int IAnimGraph<CLIPTYPE>::AddStateMachine(const std::vector<unsigned int>& states) {
+		AnimGraphNode node;
+		node.type = AnimGraphNodeType::StateMachine;
+		node.clip = 0;
+		node.timeParameter = -1;
+		node.inputA = node.inputB = 0;
+		node.weightParameter = -1;
+		node.rootBone = -1;
+		node.mask = -1;
+		node.children = states;
+		node.runtimeIndex = this->numbStateMachines++;
+		return this->AddNode(node);
+	}
+
+	template<typename CLIPTYPE>
+	int IAnimGraph<CLIPTYPE>::FindMask(int rootBone) {
+		if (rootBone < 0) { return -1; }
+		unsigned int numbBones = this->restPose.Size();
+		// nodes that share a root bone share a mask
+		unsigned int numbMasks = this->masks.size();
+		for (unsigned int i = 0; i < numbMasks; i++) {
+			std::vector<unsigned char>& mask = this->masks[i];
+			if (mask[rootBone] == 2) { return (int) i; }
+		}
+		// mark the root bone with a 2 so the mask can be found again, non zero still means 'in mask'
+		std::vector<unsigned char> mask(numbBones);
+		for (unsigned int bone = 0; bone < numbBones; bone++) {
+			mask[bone] = IsBoneChildOf(this->restPose, (unsigned int) rootBone, bone) ? 1 : 0;
+		}
+		mask[rootBone] = 2;
+		this->masks.push_back(mask);
+		return (int) this->masks.size() - 1;
+	}
+
+	template<typename CLIPTYPE>
+	bool IAnimGraph<CLIPTYPE>::Emit(unsigned int nodeIndex, unsigned int slot, std::vector<bool>& visiting) {
+		if (nodeIndex >= this->nodes.size()) {
+			std::cout << "animation graph node " << nodeIndex << " does not exist\n";
+			return false;
+		}
+		if (visiting[nodeIndex]) {
+			std::cout << "animation graph contains a cycle at node " << nodeIndex << "\n";
+			return false;
+		}
+		if (slot + 1 > this->numbSlots) { this->numbSlots = slot + 1; }
+		visiting[nodeIndex] = true;
+		AnimGraphNode& node = this->nodes[nodeIndex];
+		if (node.rootBone >= 0 && node.rootBone >= (int) this->restPose.Size()) {
+			std::cout << "animation graph node " << nodeIndex << " uses a bone that is not in the armature\n";
+			return false;
+		}
+		node.mask = this->FindMask(node.rootBone);
+
+		AnimGraphInstruction instruction;
+		instruction.node = nodeIndex;
+		instruction.out = slot;
+		instruction.in = slot + 1;
+		instruction.state = 0;
+		instruction.jump = 0;
+
+		switch (node.type) {
+		case AnimGraphNodeType::Clip: {
+			instruction.op = AnimGraphOp::SampleClip;
+			this->instructions.push_back(instruction);
+			break;
+		}
+		case AnimGraphNodeType::Blend: {
+			// a masked blend always needs branch 'a' for the bones outside the mask
+			bool isFullBlend = node.rootBone < 0;
+			unsigned int skipA = 0;
+			if (isFullBlend) {
+				skipA = this->instructions.size();
+				instruction.op = AnimGraphOp::SkipIfWeightOne;
+				this->instructions.push_back(instruction);
+			}
+			if (!this->Emit(node.inputA, slot, visiting)) { return false; }
+			unsigned int skipB = this->instructions.size();
+			instruction.op = AnimGraphOp::SkipIfWeightZero;
+			this->instructions.push_back(instruction);
+			if (isFullBlend) {
+				this->instructions[skipA].jump = this->instructions.size();
+			}
+			if (!this->Emit(node.inputB, slot + 1, visiting)) { return false; }
+			instruction.op = AnimGraphOp::Blend;
+			this->instructions.push_back(instruction);
+			this->instructions[skipB].jump = this->instructions.size();
+			break;
+		}
+		case AnimGraphNodeType::Additive: {
+			if (!this->Emit(node.inputA, slot, visiting)) { return false; }
+			unsigned int skip = this->instructions.size();
+			instruction.op = AnimGraphOp::SkipIfWeightZero;
+			this->instructions.push_back(instruction);
+			if (!this->Emit(node.inputB, slot + 1, visiting)) { return false; }
+			instruction.op = AnimGraphOp::Add;
+			this->instructions.push_back(instruction);
+			this->instructions[skip].jump = this->instructions.size();
+			break;
+		}
+		case AnimGraphNodeType::Mask: {
+			if (!this->Emit(node.inputA, slot, visiting)) { return false; }
+			if (!this->Emit(node.inputB, slot + 1, visiting)) { return false; }
+			instruction.op = AnimGraphOp::Mask;
+			this->instructions.push_back(instruction);
+			break;
+		}
+		case AnimGraphNodeType::IK: {
+			unsigned int chainSize = node.children.size();
+			if (chainSize < 2) {
+				std::cout << "animation graph IK node " << nodeIndex << " needs a chain of 2 or more bones\n";
+				return false;
+			}
+			for (unsigned int i = 0; i < chainSize; i++) {
+				if (node.children[i] >= this->restPose.Size()) {
+					std::cout << "animation graph IK node " << nodeIndex << " uses a bone that is not in the armature\n";
+					return false;
+				}
+				if (i > 0 && this->restPose.ParentIndexOf(node.children[i]) != (int) node.children[i - 1]) {
+					std::cout << "animation graph IK node " << nodeIndex << " bone chain is not a parent to child chain\n";
+					return false;
+				}
+			}
+			if (!this->Emit(node.inputA, slot, visiting)) { return false; }
+			unsigned int skip = this->instructions.size();
+			instruction.op = AnimGraphOp::SkipIfWeightZero;
+			this->instructions.push_back(instruction);
+			instruction.op = AnimGraphOp::IK;
+			this->instructions.push_back(instruction);
+			this->instructions[skip].jump = this->instructions.size();
+			break;
+		}
+		case AnimGraphNodeType::StateMachine: {
+			// slot holds the current state, slot + 1 the state being faded into, the states themselves are evaluated in slot + 2
+			unsigned int numbStates = node.children.size();
+			if (numbStates == 0) {
+				std::cout << "animation graph state machine " << nodeIndex << " has no states\n";
+				return false;
+			}
+			if (slot + 3 > this->numbSlots) { this->numbSlots = slot + 3; }
+			for (unsigned int state = 0; state < numbStates; state++) {
+				unsigned int skip = this->instructions.size();
+				instruction.op = AnimGraphOp::SkipIfStateInactive;
+				instruction.state = state;
+				this->instructions.push_back(instruction);
+				if (!this->Emit(node.children[state], slot + 2, visiting)) { return false; }
+				instruction.op = AnimGraphOp::StateStore;
+				instruction.in = slot + 2;
+				this->instructions.push_back(instruction);
+				this->instructions[skip].jump = this->instructions.size();
+			}
+			instruction.op = AnimGraphOp::StateBlend;
+			instruction.in = slot + 1;
+			instruction.state = 0;
+			this->instructions.push_back(instruction);
+			break;
+		}
+		}
+		visiting[nodeIndex] = false;
+		return true;
+	}
+
+	template<typename CLIPTYPE>
+	bool IAnimGraph<CLIPTYPE>::Compile(unsigned int rootNode) {
+		this->instructions.clear();
+		this->masks.clear();
+		this->numbSlots = 0;
+		this->isCompiled = false;
+		if (this->restPose.Size() == 0) {
+			std::cout << "animation graph has no armature, can't compile\n";
+			return false;
+		}
+		std::vector<bool> visiting(this->nodes.size(), false);
+		if (!this->Emit(rootNode, 0, visiting)) {
+			this->instructions.clear();
+			return false;
+		}
+		this->isCompiled = true;
+		return true;
+	}
+
+	template<typename CLIPTYPE>
+	bool IAnimGraph<CLIPTYPE>::IsCompiled() {
+		return this->isCompiled;
+	}
+
+	template<typename CLIPTYPE>
+	unsigned int IAnimGraph<CLIPTYPE>::NumbNodes() {
+		return (unsigned int) this->nodes.size();
+	}
+
+	template<typename CLIPTYPE>
+	unsigned int IAnimGraph<CLIPTYPE>::NumbParameters() {
+		return (unsigned int) this->parameterNames.size();
+	}
+
+	template<typename CLIPTYPE>
+	unsigned int IAnimGraph<CLIPTYPE>::NumbInstructions() {
+		return (unsigned int) this->instructions.size();
+	}
+
+	template<typename CLIPTYPE>
+	unsigned int IAnimGraph<CLIPTYPE>::NumbSlots() {
+		return this->numbSlots;
+	}
+
+	template<typename CLIPTYPE>
+	AnimGraphNode& IAnimGraph<CLIPTYPE>::GetNode(unsigned int node) {
+		return this->nodes[node];
+	}
+
+	template<typename CLIPTYPE>
+	Pose& IAnimGraph<CLIPTYPE>::GetRestPose() {
+		return this->restPose;
+	}
+
+	// === graph instance ===
+
+	template<typename CLIPTYPE>
+	IAnimGraphInstance<CLIPTYPE>::IAnimGraphInstance() {
+		this->graph = NULL;
+		this->activeBones = NULL;
+	}
+
+	template<typename CLIPTYPE>
+	IAnimGraphInstance<CLIPTYPE>::IAnimGraphInstance(IAnimGraph<CLIPTYPE>* graph) {
+		this->graph = NULL;
+		this->activeBones = NULL;
+		this->SetGraph(graph);
+	}
+
+	template<typename CLIPTYPE>
+	IAnimGraphInstance<CLIPTYPE>::IAnimGraphInstance(const IAnimGraphInstance& other) {
+		this->graph = NULL;
+		this->activeBones = NULL;
+		*this = other;
+	}
+
+	template<typename CLIPTYPE>
+	IAnimGraphInstance<CLIPTYPE>& IAnimGraphInstance<CLIPTYPE>::operator=(const IAnimGraphInstance& other) {
+		if (&other == this) { return *this; }
+		this->graph = other.graph;
+		this->parameters = other.parameters;
+		this->clipTimes = other.clipTimes;
+		this->ikTargets = other.ikTargets;
+		this->ikSolvers = other.ikSolvers;
+		this->twoBoneSolvers = other.twoBoneSolvers;
+		this->stateMachines = other.stateMachines;
+		this->posePool = other.posePool;
+		this->activeBones = other.activeBones;
+		// the slots have to point into our own pool, in the same arrangement as the other instance's slots
+		unsigned int numbSlots = other.slots.size();
+		this->slots.resize(numbSlots);
+		for (unsigned int i = 0; i < numbSlots; i++) {
+			unsigned int poolIndex = (unsigned int) (other.slots[i] - &other.posePool[0]);
+			this->slots[i] = &this->posePool[poolIndex];
+		}
+		return *this;
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimGraphInstance<CLIPTYPE>::SetGraph(IAnimGraph<CLIPTYPE>* graph) {
+		this->graph = graph;
+		this->slots.clear();
+		this->posePool.clear();
+		if (graph == NULL) { return; }
+		if (!graph->IsCompiled()) {
+			std::cout << "animation graph instance was given a graph that hasn't been compiled\n";
+			this->graph = NULL;
+			return;
+		}
+		this->parameters = graph->parameterDefaults;
+		this->clipTimes.resize(graph->numbClipNodes);
+		this->ikTargets.assign(graph->numbIKNodes, transforms::srt());
+		this->ikSolvers.resize(graph->numbIKNodes);
+		this->twoBoneSolvers.resize(graph->numbIKNodes);
+		this->stateMachines.assign(graph->numbStateMachines, AnimGraphStateMachine());
+		unsigned int numbNodes = graph->nodes.size();
+		for (unsigned int i = 0; i < numbNodes; i++) {
+			AnimGraphNode& node = graph->nodes[i];
+			if (node.type == AnimGraphNodeType::Clip) {
+				this->clipTimes[node.runtimeIndex] = graph->clips[node.clip]->GetStartTime();
+			} else if (node.type == AnimGraphNodeType::IK && node.children.size() != 3) {
+				ik::FABRIKSolver& solver = this->ikSolvers[node.runtimeIndex];
+				solver.ResizeChain(node.children.size());
+				// the chain is set from the animated pose before every solve, warm starting carries last frame's solution over
+				solver.GetWarmStart().SetEnabled(true);
+				solver.GetWarmStart().Reset();
+			}
+		}
+		// allocate every scratch pose up front so evaluation never allocates
+		this->posePool.assign(graph->numbSlots, graph->restPose);
+		this->slots.resize(graph->numbSlots);
+		for (unsigned int i = 0; i < graph->numbSlots; i++) {
+			this->slots[i] = &this->posePool[i];
+		}
+	}
+
+	template<typename CLIPTYPE>
+	IAnimGraph<CLIPTYPE>* IAnimGraphInstance<CLIPTYPE>::GetGraph() {
+		return this->graph;
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimGraphInstance<CLIPTYPE>::SetParameter(unsigned int parameter, float value) {
+		this->parameters[parameter] = value;
+	}
+
+	template<typename CLIPTYPE>
+	float IAnimGraphInstance<CLIPTYPE>::GetParameter(unsigned int parameter) {
+		return this->parameters[parameter];
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimGraphInstance<CLIPTYPE>::SetIKTarget(unsigned int node, const transforms::srt& target) {
+		this->ikTargets[this->graph->nodes[node].runtimeIndex] = target;
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimGraphInstance<CLIPTYPE>::SetIKIterationBudget(ik::IterationBudget* budget) {
+		unsigned int numbSolvers = this->ikSolvers.size();
+		for (unsigned int i = 0; i < numbSolvers; i++) {
+			this->ikSolvers[i].SetIterationBudget(budget);
+		}
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimGraphInstance<CLIPTYPE>::ResetIKWarmStart() {
+		unsigned int numbSolvers = this->ikSolvers.size();
+		for (unsigned int i = 0; i < numbSolvers; i++) {
+			this->ikSolvers[i].GetWarmStart().Reset();
+		}
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimGraphInstance<CLIPTYPE>::SetIKStats(ik::SolverStats* stats) {
+		unsigned int numbSolvers = this->ikSolvers.size();
+		for (unsigned int i = 0; i < numbSolvers; i++) {
+			this->ikSolvers[i].SetStats(stats);
+		}
+	}
+
+	template<typename CLIPTYPE>
+	unsigned int IAnimGraphInstance<CLIPTYPE>::GetIKIterations(unsigned int node) {
+		const AnimGraphNode& ikNode = this->graph->nodes[node];
+		if (ikNode.children.size() == 3) { return 0; }
+		return this->ikSolvers[ikNode.runtimeIndex].GetLastIterations();
+	}
+
+	template<typename CLIPTYPE>
+	float IAnimGraphInstance<CLIPTYPE>::GetIKError(unsigned int node) {
+		const AnimGraphNode& ikNode = this->graph->nodes[node];
+		unsigned int index = ikNode.runtimeIndex;
+		if (ikNode.children.size() == 3) {
+			// length() would report errors under about 0.003 as 0
+			return sqrtf(lengthSquared(this->ikTargets[index].position - this->twoBoneSolvers[index].GetBoneAt(2).position));
+		}
+		return this->ikSolvers[index].GetLastError();
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimGraphInstance<CLIPTYPE>::SetState(unsigned int node, unsigned int state) {
+		AnimGraphStateMachine& machine = this->stateMachines[this->graph->nodes[node].runtimeIndex];
+		machine.current = state;
+		machine.next = -1;
+		machine.elapsed = 0.0f;
+		machine.duration = 0.0f;
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimGraphInstance<CLIPTYPE>::TransitionTo(unsigned int node, unsigned int state, float fadeDuration) {
+		AnimGraphStateMachine& machine = this->stateMachines[this->graph->nodes[node].runtimeIndex];
+		if (machine.next == (int) state) { return; } // already fading to the state
+		if (machine.next < 0 && machine.current == state) { return; } // state is already playing
+		if (machine.next >= 0) {
+			// interrupting a fade, snap to the state that was being faded into
+			machine.current = (unsigned int) machine.next;
+			if (machine.current == state) {
+				machine.next = -1;
+				return;
+			}
+		}
+		if (fadeDuration <= 0.0f) {
+			this->SetState(node, state);
+			return;
+		}
+		machine.next = (int) state;
+		machine.elapsed = 0.0f;
+		machine.duration = fadeDuration;
+	}
+
+	template<typename CLIPTYPE>
+	unsigned int IAnimGraphInstance<CLIPTYPE>::GetCurrentState(unsigned int node) {
+		return this->stateMachines[this->graph->nodes[node].runtimeIndex].current;
+	}
+
+	template<typename CLIPTYPE>
+	float IAnimGraphInstance<CLIPTYPE>::GetWeight(int parameter) {
+		if (parameter < 0) { return 1.0f; }
+		return Clamp01(this->parameters[parameter]);
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimGraphInstance<CLIPTYPE>::SetActiveBones(const std::vector<bool>* activeBones) {
+		this->activeBones = activeBones;
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimGraphInstance<CLIPTYPE>::AdvanceClocks(float deltaTime) {
+		// every clock advances, even for clips that end up being skipped, so branches stay in sync when they fade back in
+		unsigned int numbNodes = this->graph->nodes.size();
+		for (unsigned int i = 0; i < numbNodes; i++) {
+			AnimGraphNode& node = this->graph->nodes[i];
+			if (node.type != AnimGraphNodeType::Clip || node.timeParameter >= 0) { continue; }
+			const CLIPTYPE* clip = this->graph->clips[node.clip];
+			float& time = this->clipTimes[node.runtimeIndex];
+			time += deltaTime;
+			// keep skipped clocks in the clip's range, so they don't lose precision over time
+			float duration = clip->GetDuration();
+			if (duration > 0.0f && time > clip->GetEndTime()) {
+				time = clip->DoesClipLoop() ? clip->GetStartTime() + fmodf(time - clip->GetStartTime(), duration) : clip->GetEndTime();
+			}
+		}
+		unsigned int numbMachines = this->stateMachines.size();
+		for (unsigned int i = 0; i < numbMachines; i++) {
+			AnimGraphStateMachine& machine = this->stateMachines[i];
+			if (machine.next < 0) { continue; }
+			machine.elapsed += deltaTime;
+			if (machine.elapsed >= machine.duration) {
+				machine.current = (unsigned int) machine.next;
+				machine.next = -1;
+			}
+		}
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimGraphInstance<CLIPTYPE>::Execute() {
+		IAnimGraph<CLIPTYPE>& def = *this->graph;
+		unsigned int numbInstructions = def.instructions.size();
+		unsigned int pc = 0;
+		while (pc < numbInstructions) {
+			const AnimGraphInstruction& instruction = def.instructions[pc];
+			const AnimGraphNode& node = def.nodes[instruction.node];
+			const std::vector<unsigned char>* mask = node.mask >= 0 ? &def.masks[node.mask] : NULL;
+			pc++;
+			switch (instruction.op) {
+			case AnimGraphOp::SampleClip: {
+				Pose& out = *this->slots[instruction.out];
+				out = def.restPose;
+				const CLIPTYPE* clip = def.clips[node.clip];
+				float& time = this->clipTimes[node.runtimeIndex];
+				if (node.timeParameter >= 0) {
+					time = clip->GetStartTime() + Clamp01(this->parameters[node.timeParameter]) * clip->GetDuration();
+				}
+				time = this->activeBones == NULL ? clip->Sample(out, time) : clip->Sample(out, time, *this->activeBones);
+				break;
+			}
+			case AnimGraphOp::Blend: {
+				float weight = this->GetWeight(node.weightParameter);
+				if (weight >= 1.0f && mask == NULL) {
+					// branch 'a' was skipped, the result is all branch 'b'
+					Pose* temp = this->slots[instruction.out];
+					this->slots[instruction.out] = this->slots[instruction.in];
+					this->slots[instruction.in] = temp;
+					break;
+				}
+				Pose& out = *this->slots[instruction.out];
+				BlendMasked(out, out, *this->slots[instruction.in], weight, mask);
+				break;
+			}
+			case AnimGraphOp::Add: {
+				AddMasked(*this->slots[instruction.out], *this->slots[instruction.in], def.referencePoses[node.runtimeIndex], this->GetWeight(node.weightParameter), mask);
+				break;
+			}
+			case AnimGraphOp::Mask: {
+				CopyMasked(*this->slots[instruction.out], *this->slots[instruction.in], *mask);
+				break;
+			}
+			case AnimGraphOp::IK: {
+				Pose& pose = *this->slots[instruction.out];
+				ik::FABRIKSolver& solver = this->ikSolvers[node.runtimeIndex];
+				ik::TwoBoneSolver& twoBoneSolver = this->twoBoneSolvers[node.runtimeIndex];
+				const std::vector<unsigned int>& chain = node.children;
+				unsigned int chainSize = chain.size();
+				// limbs have an exact solution, longer chains are solved iteratively
+				bool isLimb = chainSize == 3;
+				// the first bone of the chain is in model space, the rest are local to their parent
+				if (isLimb) {
+					twoBoneSolver[0] = pose.GetWorldTransform(chain[0]);
+					twoBoneSolver[1] = pose.GetLocalTransform(chain[1]);
+					twoBoneSolver[2] = pose.GetLocalTransform(chain[2]);
+					twoBoneSolver.SolveChain(this->ikTargets[node.runtimeIndex]);
+				} else {
+					solver.SetLocalBone(0, pose.GetWorldTransform(chain[0]));
+					for (unsigned int i = 1; i < chainSize; i++) {
+						solver.SetLocalBone(i, pose.GetLocalTransform(chain[i]));
+					}
+					solver.SolveChain(this->ikTargets[node.runtimeIndex]);
+				}
+				int parent = pose.ParentIndexOf(chain[0]);
+				transforms::srt root = parent >= 0 ? pose.GetWorldTransform(parent) : transforms::srt();
+				float weight = this->GetWeight(node.weightParameter);
+				for (unsigned int i = 0; i < chainSize; i++) {
+					transforms::srt solved = isLimb ? twoBoneSolver[i] : solver.GetLocalBone(i);
+					if (i == 0) {
+						solved = transforms::combine(transforms::inverse(root), solved);
+					}
+					if (weight < 1.0f) {
+						solved = transforms::mix(pose.GetLocalTransform(chain[i]), solved, weight);
+					}
+					pose.SetLocalTransform(chain[i], solved);
+				}
+				break;
+			}
+			case AnimGraphOp::SkipIfWeightZero: {
+				if (this->GetWeight(node.weightParameter) <= 0.0f) { pc = instruction.jump; }
+				break;
+			}
+			case AnimGraphOp::SkipIfWeightOne: {
+				if (this->GetWeight(node.weightParameter) >= 1.0f) { pc = instruction.jump; }
+				break;
+			}
+			case AnimGraphOp::SkipIfStateInactive: {
+				AnimGraphStateMachine& machine = this->stateMachines[node.runtimeIndex];
+				if (machine.current != instruction.state && machine.next != (int) instruction.state) { pc = instruction.jump; }
+				break;
+			}
+			case AnimGraphOp::StateStore: {
+				AnimGraphStateMachine& machine = this->stateMachines[node.runtimeIndex];
+				unsigned int target = machine.current == instruction.state ? instruction.out : instruction.out + 1;
+				Pose* temp = this->slots[target];
+				this->slots[target] = this->slots[instruction.in];
+				this->slots[instruction.in] = temp;
+				break;
+			}
+			case AnimGraphOp::StateBlend: {
+				AnimGraphStateMachine& machine = this->stateMachines[node.runtimeIndex];
+				if (machine.next < 0) { break; }
+				float percentage = Clamp01(machine.elapsed / machine.duration);
+				Pose& out = *this->slots[instruction.out];
+				BlendMasked(out, out, *this->slots[instruction.in], percentage, NULL);
+				break;
+			}
+			}
+		}
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimGraphInstance<CLIPTYPE>::Update(float deltaTime) {
+		if (this->graph == NULL) { return; }
+		this->AdvanceClocks(deltaTime);
+		this->Execute();
+	}
+
+	template<typename CLIPTYPE>
+	Pose& IAnimGraphInstance<CLIPTYPE>::GetPose() {
+		// the graph's result always ends up in the first slot
+		return *this->slots[0];
+	}
+}
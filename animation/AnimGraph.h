@@ -0,0 +1,346 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "Pose.h"
+#include "Armature.h"
+#include "Clip.h"
+#include "../ik/FABRIKSolver.h"
+#include "../ik/TwoBoneSolver.h"
+#include "../transforms/srt.h"
+
+namespace anim {
+
+	/// <summary>
+	/// The kinds of node that can be placed in an animation graph.
+	/// </summary>
+	enum class AnimGraphNodeType {
+		Clip,			// samples an animation clip
+		Blend,			// blends two child nodes together using a weight parameter
+		Additive,		// adds a child node onto a base child node
+		Mask,			// replaces a branch of the skeleton in one child node with the same branch from another child node
+		IK,				// runs an inverse kinematic solver over a bone chain of a child node
+		StateMachine	// plays one child node (state) at a time, cross fading between states on transitions
+	};
+
+	/// <summary>
+	/// The instructions that a compiled animation graph is flattened into.
+	/// </summary>
+	enum class AnimGraphOp {
+		SampleClip,				// slot[out] = rest pose sampled by the node's clip
+		Blend,					// slot[out] = blend(slot[out], slot[in], weight)
+		Add,					// slot[out] = slot[out] + (slot[in] - reference pose) * weight
+		Mask,					// slot[out] = slot[out] with the node's bone branch copied from slot[in]
+		IK,						// solve the node's bone chain in slot[out]
+		SkipIfWeightZero,		// jump if the node's weight parameter is <= 0
+		SkipIfWeightOne,		// jump if the node's weight parameter is >= 1
+		SkipIfStateInactive,	// jump if state 'state' of the node's state machine is neither playing nor being faded into
+		StateStore,				// move slot[in] into the state machine's current (slot[out]) or next (slot[out + 1]) slot
+		StateBlend				// slot[out] = blend(slot[out], slot[in], fade percentage), if the state machine is fading
+	};
+
+	/// <summary>
+	/// A single node in the graph definition. Nodes reference each other by their index in the graph's node array.
+	/// </summary>
+	struct AnimGraphNode {
+		AnimGraphNodeType type;
+		/// <summary>
+		/// The index of the clip this node samples. Clip nodes only.
+		/// </summary>
+		unsigned int clip;
+		/// <summary>
+		/// Normalized [0,1] parameter used as the playback position of the clip. Negative when the clip plays on its own clock.
+		/// </summary>
+		int timeParameter;
+		/// <summary>
+		/// Child node indices. For an additive node inputB is the additive pose, for a mask node inputB provides the masked branch.
+		/// </summary>
+		unsigned int inputA, inputB;
+		/// <summary>
+		/// The parameter that controls the strength of the node. Negative means the node is always fully applied.
+		/// </summary>
+		int weightParameter;
+		/// <summary>
+		/// The bone the node's effect starts from. Negative to affect the entire pose.
+		/// </summary>
+		int rootBone;
+		/// <summary>
+		/// Index into the graph's precomputed bone masks, negative when the node affects the entire pose.
+		/// </summary>
+		int mask;
+		/// <summary>
+		/// Bone chain for IK nodes (chain root first, end effector last), child state nodes for state machines.
+		/// </summary>
+		std::vector<unsigned int> children;
+		/// <summary>
+		/// Index into the per-instance runtime storage for this node type (clip clocks, IK solvers, state machines).
+		/// Also the index of the reference pose for additive nodes.
+		/// </summary>
+		unsigned int runtimeIndex;
+	};
+
+	/// <summary>
+	/// A single flattened graph instruction.
+	/// </summary>
+	struct AnimGraphInstruction {
+		AnimGraphOp op;
+		/// <summary>
+		/// The node that emitted this instruction
+		/// </summary>
+		unsigned int node;
+		/// <summary>
+		/// Scratch pose slots read and written by the instruction
+		/// </summary>
+		unsigned int out, in;
+		/// <summary>
+		/// State index for the state machine instructions
+		/// </summary>
+		unsigned int state;
+		/// <summary>
+		/// The instruction to continue from when a skip instruction is taken
+		/// </summary>
+		unsigned int jump;
+	};
+
+	/// <summary>
+	/// Per-instance playback state of a state machine node.
+	/// </summary>
+	struct AnimGraphStateMachine {
+		unsigned int current;
+		/// <summary>
+		/// The state being faded into, negative if no transition is happening
+		/// </summary>
+		int next;
+		float elapsed;
+		float duration;
+		AnimGraphStateMachine() : current(0), next(-1), elapsed(0.0f), duration(0.0f) {}
+	};
+
+	template<typename CLIPTYPE>
+	class IAnimGraphInstance;
+
+	/// <summary>
+	/// An animation graph definition.
+	/// Nodes are added with the Add functions, then the graph is compiled into a linear instruction list that is
+	/// evaluated by animation graph instances. The definition is read only once compiled, so one definition can be shared
+	/// by any number of characters; each character owns an instance that stores its parameters, clocks and scratch poses.
+	/// </summary>
+	/// <typeparam name="CLIPTYPE">The clip type sampled by the graph's clip nodes</typeparam>
+	template<typename CLIPTYPE>
+	class IAnimGraph {
+		friend class IAnimGraphInstance<CLIPTYPE>;
+	protected:
+		Pose restPose;
+		std::vector<AnimGraphNode> nodes;
+		/// <summary>
+		/// Clips are not owned by the graph, they must outlive it. Clips are only sampled, so they can be shared with other graphs and threads.
+		/// </summary>
+		std::vector<const CLIPTYPE*> clips;
+		std::vector<std::string> parameterNames;
+		std::vector<float> parameterDefaults;
+		/// <summary>
+		/// Reference poses that additive nodes subtract from their additive input.
+		/// </summary>
+		std::vector<Pose> referencePoses;
+		/// <summary>
+		/// One entry per bone, 1 if the bone is affected by nodes using the mask.
+		/// Precomputed so evaluation doesn't need to walk the bone hierarchy for every bone like IsBoneChildOf does.
+		/// </summary>
+		std::vector<std::vector<unsigned char>> masks;
+		std::vector<AnimGraphInstruction> instructions;
+		/// <summary>
+		/// The number of scratch poses an instance needs to evaluate the graph.
+		/// </summary>
+		unsigned int numbSlots;
+		unsigned int numbClipNodes;
+		unsigned int numbIKNodes;
+		unsigned int numbStateMachines;
+		bool isCompiled;
+	protected:
+		unsigned int AddNode(const AnimGraphNode& node);
+		int FindMask(int rootBone);
+		/// <summary>
+		/// Recursively flatten a node into the instruction list.
+		/// </summary>
+		/// <param name="node">The node to emit</param>
+		/// <param name="slot">The scratch pose slot the node should write its result into</param>
+		/// <param name="visiting">Nodes on the current path, used to reject cycles</param>
+		/// <returns>False if the node could not be emitted</returns>
+		bool Emit(unsigned int node, unsigned int slot, std::vector<bool>& visiting);
+	public:
+		IAnimGraph();
+		IAnimGraph(const Armature& armature);
+		/// <summary>
+		/// Set the armature whose rest pose every clip node is sampled on top of.
+		/// </summary>
+		/// <param name="armature"></param>
+		void SetArmature(const Armature& armature);
+		/// <summary>
+		/// Add a named float parameter that instances can change at runtime.
+		/// </summary>
+		/// <returns>The index of the parameter</returns>
+		unsigned int AddParameter(const std::string& name, float defaultValue);
+		/// <summary>
+		/// Find a parameter by name.
+		/// </summary>
+		/// <returns>The index of the parameter, negative if the parameter doesn't exist</returns>
+		int FindParameter(const std::string& name);
+		/// <summary>
+		/// Add a node that samples a clip.
+		/// </summary>
+		/// <param name="clip">The clip to sample, not owned by the graph</param>
+		/// <param name="timeParameter">Normalized parameter to scrub the clip with, negative to let the clip play in real time</param>
+		/// <returns>The index of the node</returns>
+		unsigned int AddClip(const CLIPTYPE* clip, int timeParameter);
+		/// <summary>
+		/// Add a node that blends from node 'a' to node 'b'.
+		/// Branch 'b' is not evaluated while the weight is zero, branch 'a' is not evaluated while the weight is one (full pose blends only).
+		/// </summary>
+		/// <param name="weightParameter">0 is all of node 'a', 1 is all of node 'b', negative to always be all of node 'b'</param>
+		/// <param name="rootBone">-ve to blend the entire pose, otherwise the bone the blend starts from</param>
+		unsigned int AddBlend(unsigned int a, unsigned int b, int weightParameter, int rootBone);
+		/// <summary>
+		/// Add a node that adds the difference between node 'additive' and a reference pose onto node 'base'.
+		/// The additive branch is not evaluated while the weight is zero.
+		/// </summary>
+		/// <param name="referencePose">The pose the additive pose is relative to, see MakePoseForAdding</param>
+		/// <param name="weightParameter">Strength of the addition, negative to always fully add</param>
+		/// <param name="rootBone">-ve to add onto the entire pose, otherwise the bone the addition starts from</param>
+		unsigned int AddAdditive(unsigned int base, unsigned int additive, const Pose& referencePose, int weightParameter, int rootBone);
+		/// <summary>
+		/// Add a node that takes node 'a' and replaces the bones from rootBone downwards with the bones from node 'b'.
+		/// </summary>
+		unsigned int AddMask(unsigned int a, unsigned int b, unsigned int rootBone);
+		/// <summary>
+		/// Add a node that runs an IK solver over a bone chain of its input. The target is set per instance with SetIKTarget.
+		/// Three bone chains (arms and legs) are solved exactly with a TwoBoneSolver, longer chains with FABRIK.
+		/// </summary>
+		/// <param name="boneChain">Bone indices, chain root first and end effector last. Each bone must be the parent of the next.</param>
+		/// <param name="weightParameter">How much of the solved chain replaces the input pose, negative to always fully apply</param>
+		unsigned int AddIK(unsigned int input, const std::vector<unsigned int>& boneChain, int weightParameter);
+		/// <summary>
+		/// Add a state machine node. Only the playing state, and the state being faded into, are evaluated.
+		/// </summary>
+		/// <param name="states">The nodes that make up the states, the first state plays by default</param>
+		unsigned int AddStateMachine(const std::vector<unsigned int>& states);
+		/// <summary>
+		/// Flatten the graph into a linear instruction list. Must be called before instances are made from the graph.
+		/// </summary>
+		/// <param name="rootNode">The node whose result is the final pose</param>
+		/// <returns>True if the graph compiled</returns>
+		bool Compile(unsigned int rootNode);
+		bool IsCompiled();
+		unsigned int NumbNodes();
+		unsigned int NumbParameters();
+		unsigned int NumbInstructions();
+		unsigned int NumbSlots();
+		AnimGraphNode& GetNode(unsigned int node);
+		Pose& GetRestPose();
+	};
+
+	/// <summary>
+	/// A character's playback state for a shared animation graph definition.
+	/// All scratch poses are allocated when the graph is set, evaluation does not allocate.
+	/// </summary>
+	/// <typeparam name="CLIPTYPE"></typeparam>
+	template<typename CLIPTYPE>
+	class IAnimGraphInstance {
+	protected:
+		IAnimGraph<CLIPTYPE>* graph;
+		std::vector<float> parameters;
+		std::vector<float> clipTimes;
+		std::vector<transforms::srt> ikTargets;
+		std::vector<ik::FABRIKSolver> ikSolvers;
+		/// <summary>
+		/// Used instead of ikSolvers[node] for three bone chains
+		/// </summary>
+		std::vector<ik::TwoBoneSolver> twoBoneSolvers;
+		std::vector<AnimGraphStateMachine> stateMachines;
+		/// <summary>
+		/// The fixed pool of scratch poses
+		/// </summary>
+		std::vector<Pose> posePool;
+		/// <summary>
+		/// The pose pool is accessed through slots, so results can be moved between slots by swapping pointers instead of copying bones
+		/// </summary>
+		std::vector<Pose*> slots;
+		/// <summary>
+		/// Bones that clips are sampled for, NULL to sample every bone. Not owned by the instance.
+		/// </summary>
+		const std::vector<bool>* activeBones;
+	protected:
+		float GetWeight(int parameter);
+		void AdvanceClocks(float deltaTime);
+		void Execute();
+	public:
+		IAnimGraphInstance();
+		IAnimGraphInstance(IAnimGraph<CLIPTYPE>* graph);
+		IAnimGraphInstance(const IAnimGraphInstance& other);
+		IAnimGraphInstance& operator=(const IAnimGraphInstance& other);
+		/// <summary>
+		/// Bind the instance to a compiled graph definition, resetting parameters, clocks, and states.
+		/// </summary>
+		/// <param name="graph">The graph is not owned by the instance, it must outlive it</param>
+		void SetGraph(IAnimGraph<CLIPTYPE>* graph);
+		IAnimGraph<CLIPTYPE>* GetGraph();
+		void SetParameter(unsigned int parameter, float value);
+		float GetParameter(unsigned int parameter);
+		/// <summary>
+		/// Set the model space target of an IK node.
+		/// </summary>
+		void SetIKTarget(unsigned int node, const transforms::srt& target);
+		/// <summary>
+		/// Share an iteration budget between the instance's FABRIK solves and other solvers, e.g. every character in a world.
+		/// Each solve already starts from the last frame's answer (see ik::WarmStart), so it usually needs one or two iterations.
+		/// Three bone chains are solved exactly by a TwoBoneSolver in one step, they don't spend the budget or warm start.
+		/// </summary>
+		/// <param name="budget">Not owned by the instance, NULL to only limit each solve by its own iteration count</param>
+		void SetIKIterationBudget(ik::IterationBudget* budget);
+		/// <summary>
+		/// Forget the IK solutions carried over from the last update, e.g. after a teleport, so the next solves start from the animated pose.
+		/// </summary>
+		void ResetIKWarmStart();
+		/// <summary>
+		/// Record every FABRIK solve of the instance's IK nodes, see ik::SolverStats. Three bone chains aren't FABRIK solves and aren't recorded.
+		/// Instances updated on different threads, like an AnimationWorld's characters, need their own stats.
+		/// </summary>
+		/// <param name="stats">Not owned by the instance, NULL to stop recording</param>
+		void SetIKStats(ik::SolverStats* stats);
+		/// <summary>
+		/// The number of iterations an IK node's solver ran in the last update, always 0 for three bone chains which are solved exactly.
+		/// </summary>
+		unsigned int GetIKIterations(unsigned int node);
+		/// <summary>
+		/// The distance between an IK node's end effector and its target after the last update's solve.
+		/// </summary>
+		float GetIKError(unsigned int node);
+		/// <summary>
+		/// Immediately switch a state machine node to a state.
+		/// </summary>
+		void SetState(unsigned int node, unsigned int state);
+		/// <summary>
+		/// Cross fade a state machine node from its current state to a new state.
+		/// </summary>
+		/// <param name="fadeDuration">How long the cross fade should take, in seconds</param>
+		void TransitionTo(unsigned int node, unsigned int state, float fadeDuration);
+		unsigned int GetCurrentState(unsigned int node);
+		/// <summary>
+		/// Restrict clip sampling to a reduced bone set, for level of detail. Unsampled bones keep the rest pose.
+		/// </summary>
+		/// <param name="activeBones">activeBones[bone] is true if the bone should be sampled, NULL samples every bone. Must outlive its use by the instance.</param>
+		void SetActiveBones(const std::vector<bool>* activeBones);
+		/// <summary>
+		/// Advance the clocks and state machines of the instance and evaluate the graph.
+		/// </summary>
+		/// <param name="deltaTime">Time since the last update</param>
+		void Update(float deltaTime);
+		/// <summary>
+		/// Get the pose produced by the last update.
+		/// </summary>
+		Pose& GetPose();
+	};
+
+	typedef IAnimGraph<Clip> AnimGraph;
+	typedef IAnimGraph<QuickClip> QuickAnimGraph;
+	typedef IAnimGraphInstance<Clip> AnimGraphInstance;
+	typedef IAnimGraphInstance<QuickClip> QuickAnimGraphInstance;
+}
@@ -0,0 +1,167 @@
+#include "AnimationLOD.h"
+#include <algorithm>
+
+namespace anim {
+
+	LODTier::LODTier() {
+		this->minScreenSize = 0.0f;
+		this->updateInterval = 1;
+		this->numbCollapsedLayers = 0;
+		this->skinMesh = true;
+	}
+
+	LODTier::LODTier(float minScreenSize, unsigned int updateInterval, unsigned int numbCollapsedLayers, bool skinMesh) {
+		this->minScreenSize = minScreenSize;
+		this->updateInterval = updateInterval > 0 ? updateInterval : 1;
+		this->numbCollapsedLayers = numbCollapsedLayers;
+		this->skinMesh = skinMesh;
+	}
+
+	// === bone sets ===
+
+	LODBoneSet::LODBoneSet() {
+		this->numbActiveBones = 0;
+	}
+
+	void LODBoneSet::Build(const Pose& pose, unsigned int numbCollapsedLayers) {
+		unsigned int numbBones = pose.Size();
+		this->activeBones.assign(numbBones, true);
+		this->boneRemap.resize(numbBones);
+		std::vector<unsigned int> numbActiveChildren(numbBones);
+		for (unsigned int layer = 0; layer < numbCollapsedLayers; layer++) {
+			std::fill(numbActiveChildren.begin(), numbActiveChildren.end(), 0);
+			for (unsigned int bone = 0; bone < numbBones; bone++) {
+				int parent = pose.ParentIndexOf(bone);
+				if (this->activeBones[bone] && parent >= 0) {
+					numbActiveChildren[parent]++;
+				}
+			}
+			// collapse the whole layer at once, otherwise a chain would be stripped in a single pass
+			bool collapsedAny = false;
+			for (unsigned int bone = 0; bone < numbBones; bone++) {
+				if (this->activeBones[bone] && numbActiveChildren[bone] == 0 && pose.ParentIndexOf(bone) >= 0) {
+					this->activeBones[bone] = false;
+					collapsedAny = true;
+				}
+			}
+			if (!collapsedAny) { break; }
+		}
+		this->numbActiveBones = 0;
+		for (unsigned int bone = 0; bone < numbBones; bone++) {
+			int target = (int) bone;
+			while (!this->activeBones[target]) {
+				target = pose.ParentIndexOf(target);
+			}
+			this->boneRemap[bone] = (unsigned int) target;
+			if (this->activeBones[bone]) { this->numbActiveBones++; }
+		}
+	}
+
+	const std::vector<bool>& LODBoneSet::GetActiveBones() const {
+		return this->activeBones;
+	}
+
+	const std::vector<unsigned int>& LODBoneSet::GetBoneRemap() const {
+		return this->boneRemap;
+	}
+
+	unsigned int LODBoneSet::NumbActiveBones() const {
+		return this->numbActiveBones;
+	}
+
+	unsigned int LODBoneSet::Size() const {
+		return this->activeBones.size();
+	}
+
+	// === governor ===
+
+	LODGovernor::LODGovernor() {
+		this->budget = 0.0f;
+		this->vertexCost = 0.25f;
+		this->hysteresis = 0.1f;
+		this->lastCost = 0.0f;
+	}
+
+	void LODGovernor::SetTiers(const std::vector<LODTier>& tiers) {
+		this->tiers = tiers;
+	}
+
+	std::vector<LODTier>& LODGovernor::GetTiers() {
+		return this->tiers;
+	}
+
+	unsigned int LODGovernor::NumbTiers() {
+		return this->tiers.size();
+	}
+
+	void LODGovernor::SetBudget(float workPerFrame) {
+		this->budget = workPerFrame;
+	}
+
+	float LODGovernor::GetBudget() {
+		return this->budget;
+	}
+
+	void LODGovernor::SetVertexCost(float vertexCost) {
+		this->vertexCost = vertexCost;
+	}
+
+	float LODGovernor::GetVertexCost() {
+		return this->vertexCost;
+	}
+
+	void LODGovernor::SetHysteresis(float fraction) {
+		this->hysteresis = fraction > 0.0f ? fraction : 0.0f;
+	}
+
+	float LODGovernor::Cost(unsigned int tier, unsigned int numbActiveBones, unsigned int numbVertices) {
+		const LODTier& lod = this->tiers[tier];
+		float work = (float) numbActiveBones;
+		if (lod.skinMesh) {
+			work += this->vertexCost * numbVertices;
+		}
+		// the work is spread over the frames in the update interval
+		return work / lod.updateInterval;
+	}
+
+	void LODGovernor::Assign(const std::vector<float>& screenSizes, const std::vector<float>& costs, std::vector<unsigned int>& tiersInOut) {
+		unsigned int numbInstances = screenSizes.size();
+		unsigned int numbTiers = this->tiers.size();
+		if (tiersInOut.size() != numbInstances) {
+			tiersInOut.resize(numbInstances, 0);
+		}
+		this->lastCost = 0.0f;
+		if (numbTiers == 0) { return; }
+		unsigned int lastTier = numbTiers - 1;
+		// best tier the screen size allows
+		for (unsigned int i = 0; i < numbInstances; i++) {
+			unsigned int previous = tiersInOut[i] < numbTiers ? tiersInOut[i] : lastTier;
+			unsigned int tier = 0;
+			for (; tier < lastTier; tier++) {
+				float minSize = this->tiers[tier].minScreenSize;
+				if (tier < previous) { minSize *= 1.0f + this->hysteresis; }
+				if (screenSizes[i] >= minSize) { break; }
+			}
+			tiersInOut[i] = tier;
+			this->lastCost += costs[i * numbTiers + tier];
+		}
+		if (this->budget <= 0.0f || this->lastCost <= this->budget) { return; }
+		// over budget, take detail away from the smallest instances first
+		this->order.resize(numbInstances);
+		for (unsigned int i = 0; i < numbInstances; i++) { this->order[i] = i; }
+		std::sort(this->order.begin(), this->order.end(), [&screenSizes](unsigned int a, unsigned int b) { return screenSizes[a] < screenSizes[b]; });
+		for (unsigned int i = 0; i < numbInstances && this->lastCost > this->budget; i++) {
+			unsigned int instance = this->order[i];
+			const float* instanceCosts = &costs[instance * numbTiers];
+			while (tiersInOut[instance] < lastTier && this->lastCost > this->budget) {
+				unsigned int tier = tiersInOut[instance];
+				this->lastCost += instanceCosts[tier + 1] - instanceCosts[tier];
+				tiersInOut[instance] = tier + 1;
+			}
+		}
+	}
+
+	float LODGovernor::GetLastCost() {
+		return this->lastCost;
+	}
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <vector>
+#include "Pose.h"
+
+namespace anim {
+
+	/// <summary>
+	/// Describes how much work a character in a level of detail tier gets.
+	/// </summary>
+	struct LODTier {
+		/// <summary>
+		/// Characters at least this big on screen may use the tier, e.g. fraction of the screen's height
+		/// </summary>
+		float minScreenSize;
+		/// <summary>
+		/// The character is animated once every 'updateInterval' frames, 1 animates every frame
+		/// </summary>
+		unsigned int updateInterval;
+		/// <summary>
+		/// How many layers of leaf bones (fingers, then hands, ...) are collapsed onto their parents
+		/// </summary>
+		unsigned int numbCollapsedLayers;
+		/// <summary>
+		/// False to skip CPU skinning, the last skinned vertices are kept
+		/// </summary>
+		bool skinMesh;
+		LODTier();
+		LODTier(float minScreenSize, unsigned int updateInterval, unsigned int numbCollapsedLayers, bool skinMesh);
+	};
+
+	/// <summary>
+	/// A reduced skeleton, made by repeatedly collapsing leaf bones onto their parents.
+	/// Collapsed bones aren't sampled and follow the bone they were collapsed onto rigidly.
+	/// </summary>
+	class LODBoneSet {
+	protected:
+		std::vector<bool> activeBones;
+		std::vector<unsigned int> boneRemap;
+		unsigned int numbActiveBones;
+	public:
+		LODBoneSet();
+		/// <summary>
+		/// Build the reduced bone set from a skeleton's hierarchy.
+		/// </summary>
+		/// <param name="pose">Any pose of the skeleton, only the parent indices are used</param>
+		/// <param name="numbCollapsedLayers">The number of times every current leaf bone gets collapsed. Root bones are never collapsed.</param>
+		void Build(const Pose& pose, unsigned int numbCollapsedLayers);
+		/// <summary>
+		/// activeBones[bone] is true if the bone is still animated
+		/// </summary>
+		const std::vector<bool>& GetActiveBones() const;
+		/// <summary>
+		/// boneRemap[bone] is the nearest active bone at or above 'bone'
+		/// </summary>
+		const std::vector<unsigned int>& GetBoneRemap() const;
+		unsigned int NumbActiveBones() const;
+		unsigned int Size() const;
+	};
+
+	/// <summary>
+	/// Moves instances between level of detail tiers to keep the animation work under a per frame budget.
+	/// Instances first get the best tier their screen size allows, then while the frame is over budget the smallest
+	/// instances are pushed down a tier at a time, the smallest on screen lose detail first.
+	/// Work is measured in abstract units, one unit per bone evaluated plus a configurable cost per skinned vertex.
+	/// </summary>
+	class LODGovernor {
+	protected:
+		std::vector<LODTier> tiers;
+		float budget;
+		float vertexCost;
+		float hysteresis;
+		float lastCost;
+		std::vector<unsigned int> order;
+	public:
+		LODGovernor();
+		/// <summary>
+		/// Set the tiers, ordered from most detailed to least detailed.
+		/// </summary>
+		void SetTiers(const std::vector<LODTier>& tiers);
+		std::vector<LODTier>& GetTiers();
+		unsigned int NumbTiers();
+		/// <summary>
+		/// The work units that may be spent per frame, 0 or less means no budget
+		/// </summary>
+		void SetBudget(float workPerFrame);
+		float GetBudget();
+		/// <summary>
+		/// How many work units skinning one vertex costs, relative to evaluating a bone
+		/// </summary>
+		void SetVertexCost(float vertexCost);
+		float GetVertexCost();
+		/// <summary>
+		/// An instance only moves to a more detailed tier once it is this much bigger than the tier's minimum size, stops instances flickering between tiers.
+		/// </summary>
+		/// <param name="fraction">e.g. 0.1 for 10% bigger</param>
+		void SetHysteresis(float fraction);
+		/// <summary>
+		/// Estimated work per frame for an instance in a tier.
+		/// </summary>
+		/// <param name="tier"></param>
+		/// <param name="numbActiveBones">Bones evaluated in that tier</param>
+		/// <param name="numbVertices">Vertices skinned if the tier skins</param>
+		float Cost(unsigned int tier, unsigned int numbActiveBones, unsigned int numbVertices);
+		/// <summary>
+		/// Choose every instance's tier for this frame.
+		/// </summary>
+		/// <param name="screenSizes">Each instance's size on screen</param>
+		/// <param name="costs">costs[instance * NumbTiers() + tier] is the instance's work in that tier</param>
+		/// <param name="tiersInOut">Last frame's tiers in, this frame's tiers out. Resized if it doesn't match the number of instances.</param>
+		void Assign(const std::vector<float>& screenSizes, const std::vector<float>& costs, std::vector<unsigned int>& tiersInOut);
+		/// <summary>
+		/// The estimated work of the last assignment
+		/// </summary>
+		float GetLastCost();
+	};
+}
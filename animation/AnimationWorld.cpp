@@ -0,0 +1,434 @@
+#include "AnimationWorld.h"
+#include <cstring>
+#include <iostream>
+#include "Blending.h"
+
+namespace anim {
+
+	// culled characters update their box once every this many frames when the world has no level of detail tiers
+	static const unsigned int culledBoundsInterval = 4;
+
+	template IAnimationWorld<Clip>;
+	template IAnimationWorld<QuickClip>;
+
+	template<typename CLIPTYPE>
+	IAnimationWorld<CLIPTYPE>::IAnimationWorld() {
+		this->jobSystem = NULL;
+		this->useFixedTimestep = false;
+		this->frameDeltaTime = 0.0f;
+		this->frameSteps = 0;
+		this->frameAlpha = 1.0f;
+		this->useLOD = false;
+		this->frameIndex = 0;
+		this->ikIterationsPerUpdate = 0;
+	}
+
+	template<typename CLIPTYPE>
+	IAnimationWorld<CLIPTYPE>::IAnimationWorld(jobs::JobSystem* jobSystem) {
+		this->jobSystem = jobSystem;
+		this->useFixedTimestep = false;
+		this->frameDeltaTime = 0.0f;
+		this->frameSteps = 0;
+		this->frameAlpha = 1.0f;
+		this->useLOD = false;
+		this->frameIndex = 0;
+		this->ikIterationsPerUpdate = 0;
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimationWorld<CLIPTYPE>::SetJobSystem(jobs::JobSystem* jobSystem) {
+		this->jobSystem = jobSystem;
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimationWorld<CLIPTYPE>::SetFixedTimestep(float stepsPerSecond) {
+		this->useFixedTimestep = stepsPerSecond > 0.0f;
+		if (this->useFixedTimestep) {
+			this->timestep.SetRate(stepsPerSecond);
+		}
+		this->timestep.Reset();
+	}
+
+	template<typename CLIPTYPE>
+	bool IAnimationWorld<CLIPTYPE>::IsUsingFixedTimestep() {
+		return this->useFixedTimestep;
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimationWorld<CLIPTYPE>::SetLODTiers(const std::vector<LODTier>& tiers) {
+		this->lod.SetTiers(tiers);
+		this->useLOD = !tiers.empty();
+		this->lodTiers.assign(this->characters.size(), 0);
+		this->lodCosts.resize(this->characters.size() * tiers.size());
+		unsigned int numbCharacters = this->characters.size();
+		for (unsigned int i = 0; i < numbCharacters; i++) {
+			this->BuildLOD(i);
+		}
+	}
+
+	template<typename CLIPTYPE>
+	LODGovernor& IAnimationWorld<CLIPTYPE>::GetLODGovernor() {
+		return this->lod;
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimationWorld<CLIPTYPE>::SetIKIterationBudget(unsigned int iterationsPerUpdate) {
+		this->ikIterationsPerUpdate = iterationsPerUpdate;
+		this->ikBudget.Reset(iterationsPerUpdate);
+		ik::IterationBudget* budget = iterationsPerUpdate > 0 ? &this->ikBudget : NULL;
+		unsigned int numbCharacters = this->characters.size();
+		for (unsigned int i = 0; i < numbCharacters; i++) {
+			this->characters[i].graph.SetIKIterationBudget(budget);
+		}
+	}
+
+	template<typename CLIPTYPE>
+	const ik::IterationBudget& IAnimationWorld<CLIPTYPE>::GetIKIterationBudget() {
+		return this->ikBudget;
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimationWorld<CLIPTYPE>::SetScreenSize(unsigned int character, float screenSize) {
+		this->lodScreenSizes[character] = screenSize;
+	}
+
+	template<typename CLIPTYPE>
+	unsigned int IAnimationWorld<CLIPTYPE>::GetLODTier(unsigned int character) {
+		return this->useLOD ? this->lodTiers[character] : 0;
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimationWorld<CLIPTYPE>::SetVisible(unsigned int character, bool isVisible) {
+		this->characters[character].isVisible = isVisible;
+	}
+
+	template<typename CLIPTYPE>
+	const render::Bounds& IAnimationWorld<CLIPTYPE>::GetBounds(unsigned int character) {
+		return this->characters[character].bounds;
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimationWorld<CLIPTYPE>::SetBoneBounds(unsigned int character, const std::vector<render::Bounds>& boneBounds) {
+		this->characters[character].boneBounds = boneBounds;
+		// rebuilds the level of detail tiers' boxes, and the palette and its box on the next update
+		this->BuildLOD(character);
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimationWorld<CLIPTYPE>::BuildLOD(unsigned int index) {
+		Character& character = this->characters[index];
+		unsigned int numbTiers = this->lod.NumbTiers();
+		character.lodBoneSets.resize(numbTiers);
+		// the bone sets are rebuilt in place, a palette made with the old ones can't be reused
+		character.isPaletteCurrent = false;
+		character.lodBoneBounds.resize(numbTiers);
+		const std::vector<mat4f>& inverseBindPose = character.armature->GetInverseBindPose();
+		for (unsigned int tier = 0; tier < numbTiers; tier++) {
+			LODBoneSet& boneSet = character.lodBoneSets[tier];
+			boneSet.Build(character.armature->GetRestPose(), this->lod.GetTiers()[tier].numbCollapsedLayers);
+			this->lodCosts[index * numbTiers + tier] = this->lod.Cost(tier, boneSet.NumbActiveBones(), character.numbVertices);
+			// a collapsed bone's vertices are skinned by the bone it collapsed onto, move its box into that bone's space
+			std::vector<render::Bounds>& tierBounds = character.lodBoneBounds[tier];
+			const std::vector<unsigned int>& boneRemap = boneSet.GetBoneRemap();
+			unsigned int numbBones = character.boneBounds.size() < boneRemap.size() ? character.boneBounds.size() : boneRemap.size();
+			tierBounds.assign(numbBones, render::Bounds());
+			for (unsigned int bone = 0; bone < numbBones; bone++) {
+				unsigned int target = boneRemap[bone];
+				if (target == bone) {
+					tierBounds[bone].Grow(character.boneBounds[bone]);
+				} else {
+					mat4f boneToTarget = inverseBindPose[target] * inverse(inverseBindPose[bone]);
+					tierBounds[target].Grow(render::TransformBounds(boneToTarget, character.boneBounds[bone]));
+				}
+			}
+		}
+	}
+
+	template<typename CLIPTYPE>
+	int IAnimationWorld<CLIPTYPE>::AddCharacter(IAnimGraph<CLIPTYPE>* graph, const Armature* armature, const std::vector<render::Mesh>* meshes) {
+		// the warm up evaluation below runs the graph, it has to exist and be compiled
+		if (graph == NULL || !graph->IsCompiled()) {
+			std::cout << "animation world: a character was added without a compiled animation graph\n";
+			return -1;
+		}
+		if (armature == NULL) {
+			std::cout << "animation world: a character was added without an armature\n";
+			return -1;
+		}
+		this->characters.push_back(Character());
+		Character& character = this->characters.back();
+		character.graph.SetGraph(graph);
+		// evaluate once so there is a valid pose to interpolate from before the first fixed step
+		character.graph.Update(0.0f);
+		character.previousPose = character.graph.GetPose();
+		character.renderPose = character.previousPose;
+		character.graph.SetIKIterationBudget(this->ikIterationsPerUpdate > 0 ? &this->ikBudget : NULL);
+		character.armature = armature;
+		character.meshes = meshes;
+		character.numbVertices = 0;
+		character.pendingDeltaTime = 0.0f;
+		character.pendingSteps = 0;
+		character.paletteFingerprint = 0;
+		character.paletteBoneSet = NULL;
+		character.paletteVersion = 0;
+		character.skinVersion = 0;
+		character.isPaletteCurrent = false;
+		character.isSkinCurrent = false;
+		character.isVisible = true;
+		character.wasCulled = false;
+		// allocate everything the character's job writes to now, so updates don't allocate
+		unsigned int numbBones = armature->GetRestPose().Size();
+		character.posedBones.resize(numbBones);
+		character.skinningPalette.resize(numbBones);
+		if (meshes != NULL) {
+			unsigned int numbMeshes = meshes->size();
+			character.skinnedPositions.resize(numbMeshes);
+			character.skinnedNormals.resize(numbMeshes);
+			for (unsigned int i = 0; i < numbMeshes; i++) {
+				unsigned int numbVerts = (*meshes)[i].GetPositions().size();
+				character.skinnedPositions[i].resize(numbVerts);
+				character.skinnedNormals[i].resize(numbVerts);
+				character.numbVertices += numbVerts;
+			}
+		}
+		unsigned int index = (unsigned int) this->characters.size() - 1;
+		// load time, characters that share an armature and meshes share their bone boxes
+		if (meshes != NULL) {
+			bool isShared = false;
+			for (unsigned int i = 0; i < index && !isShared; i++) {
+				if (this->characters[i].armature == armature && this->characters[i].meshes == meshes) {
+					character.boneBounds = this->characters[i].boneBounds;
+					isShared = true;
+				}
+			}
+			for (unsigned int i = 0; i < meshes->size() && !isShared; i++) {
+				(*meshes)[i].BuildBoneBounds(armature->GetInverseBindPose(), character.boneBounds);
+			}
+		}
+		// big until told otherwise
+		this->lodScreenSizes.push_back(1.0f);
+		this->lodTiers.push_back(0);
+		this->lodCosts.resize(this->characters.size() * this->lod.NumbTiers());
+		this->BuildLOD(index);
+		return (int) index;
+	}
+
+	template<typename CLIPTYPE>
+	unsigned int IAnimationWorld<CLIPTYPE>::Size() {
+		return (unsigned int) this->characters.size();
+	}
+
+	template<typename CLIPTYPE>
+	IAnimGraphInstance<CLIPTYPE>& IAnimationWorld<CLIPTYPE>::GetGraphInstance(unsigned int character) {
+		return this->characters[character].graph;
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimationWorld<CLIPTYPE>::UpdateCharacter(unsigned int index) {
+		Character& character = this->characters[index];
+		float deltaTime = this->frameDeltaTime;
+		unsigned int numbSteps = this->frameSteps;
+		const LODBoneSet* boneSet = NULL;
+		const std::vector<render::Bounds>* boneBounds = &character.boneBounds;
+		bool skinMesh = true;
+		// culled characters, and characters their level of detail skips this frame, save up their time for their next update
+		character.pendingDeltaTime += deltaTime;
+		character.pendingSteps += numbSteps;
+		if (!character.isVisible) {
+			// the box keeps following the animation at the lowest level of detail, so a character culled with GetBounds can come back into view
+			character.wasCulled = true;
+			unsigned int interval = culledBoundsInterval;
+			if (this->useLOD && this->lod.GetTiers().size() > 0) {
+				unsigned int tier = this->lod.GetTiers().size() - 1;
+				interval = this->lod.GetTiers()[tier].updateInterval;
+				boneSet = &character.lodBoneSets[tier];
+				boneBounds = &character.lodBoneBounds[tier];
+				if (boneSet->NumbActiveBones() == boneSet->Size()) { boneSet = NULL; }
+			}
+			if (interval > 1 && (this->frameIndex + index) % interval != 0) { return; }
+			this->UpdateCulledBounds(character, boneSet, *boneBounds);
+			return;
+		}
+		if (this->useLOD) {
+			unsigned int tier = this->lodTiers[index];
+			const LODTier& lodTier = this->lod.GetTiers()[tier];
+			// stagger characters in the same tier, so they don't all update on the same frame
+			if ((this->frameIndex + index) % lodTier.updateInterval != 0) { return; }
+			boneSet = &character.lodBoneSets[tier];
+			boneBounds = &character.lodBoneBounds[tier];
+			if (boneSet->NumbActiveBones() == boneSet->Size()) { boneSet = NULL; }
+			skinMesh = lodTier.skinMesh;
+		}
+		if (!this->useFixedTimestep) {
+			deltaTime = character.pendingDeltaTime;
+		}
+		numbSteps = character.pendingSteps;
+		character.pendingDeltaTime = 0.0f;
+		character.pendingSteps = 0;
+		// sample, blend and IK
+		character.graph.SetActiveBones(boneSet == NULL ? NULL : &boneSet->GetActiveBones());
+		Pose* pose = NULL;
+		if (this->useFixedTimestep) {
+			if (character.wasCulled && numbSteps > 1) {
+				// everything but the last step the character missed while it was culled, only the last two steps are ever seen
+				character.graph.Update(deltaTime * (numbSteps - 1));
+				numbSteps = 1;
+			}
+			for (unsigned int step = 0; step < numbSteps; step++) {
+				character.previousPose = character.graph.GetPose();
+				character.graph.Update(deltaTime);
+			}
+			InterpolatePose(character.renderPose, character.previousPose, character.graph.GetPose(), this->frameAlpha);
+			pose = &character.renderPose;
+		} else {
+			character.graph.Update(deltaTime);
+			pose = &character.graph.GetPose();
+		}
+		character.wasCulled = false;
+		// palette, an unchanged pose makes the same palette as last time
+		unsigned long long fingerprint = pose->Fingerprint();
+		if (!character.isPaletteCurrent || fingerprint != character.paletteFingerprint || boneSet != character.paletteBoneSet) {
+			const std::vector<mat4f>& inverseBindPose = character.armature->GetInverseBindPose();
+			bool isPalette = false;
+			if (boneSet == NULL) {
+				isPalette = pose->ToSkinningPalette(character.posedBones, character.skinningPalette, inverseBindPose);
+			} else {
+				// collapsed bones reuse the skinning matrix of the bone they collapsed onto, so their vertices follow it rigidly
+				isPalette = pose->ToSkinningPalette(character.posedBones, character.skinningPalette, inverseBindPose, boneSet->GetBoneRemap());
+			}
+			// the armature doesn't match the graph's pose, there is nothing valid to bound or skin with
+			if (!isPalette) {
+				character.isPaletteCurrent = false;
+				return;
+			}
+			character.bounds = render::SkinnedBounds(*boneBounds, character.posedBones);
+			character.paletteFingerprint = fingerprint;
+			character.paletteBoneSet = boneSet;
+			character.paletteVersion++;
+			character.isPaletteCurrent = true;
+			character.isSkinCurrent = false;
+		}
+		// skin
+		if (character.meshes == NULL || !skinMesh || character.isSkinCurrent) { return; }
+		unsigned int numbMeshes = character.meshes->size();
+		for (unsigned int i = 0; i < numbMeshes; i++) {
+			// big meshes are split into chunks that idle threads can steal
+			(*character.meshes)[i].Skin(character.skinningPalette, character.skinnedPositions[i], character.skinnedNormals[i], this->jobSystem);
+		}
+		character.skinVersion++;
+		character.isSkinCurrent = true;
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimationWorld<CLIPTYPE>::UpdateCulledBounds(Character& character, const LODBoneSet* boneSet, const std::vector<render::Bounds>& boneBounds) {
+		if (boneBounds.size() == 0) { return; }
+		float deltaTime = this->useFixedTimestep ? this->frameDeltaTime * character.pendingSteps : character.pendingDeltaTime;
+		character.pendingDeltaTime = 0.0f;
+		character.pendingSteps = 0;
+		character.graph.SetActiveBones(boneSet == NULL ? NULL : &boneSet->GetActiveBones());
+		// one big step, nothing sees the poses in between
+		character.graph.Update(deltaTime);
+		const Pose& pose = character.graph.GetPose();
+		if (boneSet == NULL) {
+			pose.ToMatrixPalette(character.posedBones);
+		} else {
+			pose.ToMatrixPalette(character.posedBones, boneSet->GetBoneRemap());
+		}
+		character.bounds = render::SkinnedBounds(boneBounds, character.posedBones);
+		// posedBones no longer match the palette, it is rebuilt when the character is visible again
+		character.isPaletteCurrent = false;
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimationWorld<CLIPTYPE>::UpdateCharacters(void* data, unsigned int begin, unsigned int end) {
+		IAnimationWorld<CLIPTYPE>* world = (IAnimationWorld<CLIPTYPE>*) data;
+		for (unsigned int i = begin; i < end; i++) {
+			world->UpdateCharacter(i);
+		}
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimationWorld<CLIPTYPE>::Update(float deltaTime) {
+		if (this->useFixedTimestep) {
+			this->frameSteps = this->timestep.Advance(deltaTime);
+			this->frameAlpha = this->timestep.GetAlpha();
+			this->frameDeltaTime = this->timestep.GetStepSize();
+		} else {
+			this->frameSteps = 1;
+			this->frameAlpha = 1.0f;
+			this->frameDeltaTime = deltaTime;
+		}
+		if (this->ikIterationsPerUpdate > 0) {
+			this->ikBudget.Reset(this->ikIterationsPerUpdate);
+		}
+		if (this->useLOD) {
+			this->lod.Assign(this->lodScreenSizes, this->lodCosts, this->lodTiers);
+		}
+		unsigned int numbCharacters = this->characters.size();
+		if (this->jobSystem == NULL) {
+			UpdateCharacters(this, 0, numbCharacters);
+		} else {
+			// characters are small units of work, let the job system pick how many go in each job
+			this->jobSystem->ParallelFor(numbCharacters, 0, &IAnimationWorld<CLIPTYPE>::UpdateCharacters, this);
+		}
+		this->frameIndex++;
+	}
+
+	template<typename CLIPTYPE>
+	Pose& IAnimationWorld<CLIPTYPE>::GetPose(unsigned int character) {
+		if (this->useFixedTimestep) {
+			return this->characters[character].renderPose;
+		}
+		return this->characters[character].graph.GetPose();
+	}
+
+	template<typename CLIPTYPE>
+	std::vector<mat4f>& IAnimationWorld<CLIPTYPE>::GetPosedBones(unsigned int character) {
+		return this->characters[character].posedBones;
+	}
+
+	template<typename CLIPTYPE>
+	std::vector<mat4f>& IAnimationWorld<CLIPTYPE>::GetSkinningPalette(unsigned int character) {
+		return this->characters[character].skinningPalette;
+	}
+
+	template<typename CLIPTYPE>
+	void IAnimationWorld<CLIPTYPE>::GatherSkinningPalettes(std::vector<mat4f>& outputArray) {
+		unsigned int numbCharacters = this->characters.size();
+		unsigned int numbMatrices = 0;
+		for (unsigned int i = 0; i < numbCharacters; i++) {
+			numbMatrices += this->characters[i].skinningPalette.size();
+		}
+		if (outputArray.size() != numbMatrices) {
+			outputArray.resize(numbMatrices);
+		}
+		unsigned int offset = 0;
+		for (unsigned int i = 0; i < numbCharacters; i++) {
+			std::vector<mat4f>& palette = this->characters[i].skinningPalette;
+			if (palette.size() != 0) {
+				memcpy(&outputArray[offset], &palette[0], sizeof(mat4f) * palette.size());
+			}
+			offset += palette.size();
+		}
+	}
+
+	template<typename CLIPTYPE>
+	unsigned int IAnimationWorld<CLIPTYPE>::GetPaletteVersion(unsigned int character) {
+		return this->characters[character].paletteVersion;
+	}
+
+	template<typename CLIPTYPE>
+	unsigned int IAnimationWorld<CLIPTYPE>::GetSkinVersion(unsigned int character) {
+		return this->characters[character].skinVersion;
+	}
+
+	template<typename CLIPTYPE>
+	std::vector<f3>& IAnimationWorld<CLIPTYPE>::GetSkinnedPositions(unsigned int character, unsigned int mesh) {
+		return this->characters[character].skinnedPositions[mesh];
+	}
+
+	template<typename CLIPTYPE>
+	std::vector<f3>& IAnimationWorld<CLIPTYPE>::GetSkinnedNormals(unsigned int character, unsigned int mesh) {
+		return this->characters[character].skinnedNormals[mesh];
+	}
+}
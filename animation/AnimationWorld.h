@@ -0,0 +1,254 @@
+#pragma once
+#include <vector>
+#include "AnimGraph.h"
+#include "FixedTimestep.h"
+#include "AnimationLOD.h"
+#include "Armature.h"
+#include "Pose.h"
+#include "../Mat4f.h"
+#include "../Vector3.h"
+#include "../render/Mesh.h"
+#include "../render/Bounds.h"
+#include "../jobs/JobSystem.h"
+#include "../ik/IterationBudget.h"
+
+namespace anim {
+
+	/// <summary>
+	/// A collection of animated characters that are updated in parallel.
+	/// Every character runs its whole frame (graph sample, blend and IK -> matrix palette -> CPU skinning) as one job,
+	/// the jobs are spread over the job system's threads. Each character writes its results into its own slot,
+	/// so results are always read back in character order no matter which thread finished first.
+	/// A character whose pose didn't change since its last update (idle, paused, holding a pose) skips its palette and skinning.
+	/// </summary>
+	/// <typeparam name="CLIPTYPE">The clip type used by the characters' animation graphs</typeparam>
+	template<typename CLIPTYPE>
+	class IAnimationWorld {
+	protected:
+		struct Character {
+			IAnimGraphInstance<CLIPTYPE> graph;
+			/// <summary>
+			/// The graph's pose from the step before its latest step, fixed timestep only
+			/// </summary>
+			Pose previousPose;
+			/// <summary>
+			/// previousPose interpolated towards the graph's pose, the palette is built from this pose when using a fixed timestep
+			/// </summary>
+			Pose renderPose;
+			/// <summary>
+			/// Shared between characters, read only while the world updates
+			/// </summary>
+			const Armature* armature;
+			/// <summary>
+			/// Meshes to CPU skin, shared between characters, read only while the world updates. NULL to skip CPU skinning.
+			/// </summary>
+			const std::vector<render::Mesh>* meshes;
+			/// <summary>
+			/// Each bone in model space
+			/// </summary>
+			std::vector<mat4f> posedBones;
+			/// <summary>
+			/// posedBones[bone] * inverseBindPose[bone]
+			/// </summary>
+			std::vector<mat4f> skinningPalette;
+			/// <summary>
+			/// One array per mesh
+			/// </summary>
+			std::vector<std::vector<f3>> skinnedPositions;
+			std::vector<std::vector<f3>> skinnedNormals;
+			/// <summary>
+			/// One reduced skeleton per level of detail tier
+			/// </summary>
+			std::vector<LODBoneSet> lodBoneSets;
+			unsigned int numbVertices;
+			/// <summary>
+			/// Time and fixed steps that built up while the character's level of detail skipped updates
+			/// </summary>
+			float pendingDeltaTime;
+			unsigned int pendingSteps;
+			/// <summary>
+			/// Fingerprint of the pose the palette was built from, see Pose::Fingerprint
+			/// </summary>
+			unsigned long long paletteFingerprint;
+			/// <summary>
+			/// The reduced skeleton the palette was built with, NULL for the full skeleton
+			/// </summary>
+			const LODBoneSet* paletteBoneSet;
+			/// <summary>
+			/// Counts palette rebuilds and CPU skins, so callers can skip uploads that wouldn't change anything
+			/// </summary>
+			unsigned int paletteVersion;
+			unsigned int skinVersion;
+			bool isPaletteCurrent;
+			/// <summary>
+			/// False if the palette changed since the character was last skinned
+			/// </summary>
+			bool isSkinCurrent;
+			/// <summary>
+			/// Each bone's vertices in the bone's space, covering all of the character's meshes
+			/// </summary>
+			std::vector<render::Bounds> boneBounds;
+			/// <summary>
+			/// boneBounds per level of detail tier, a collapsed bone's box is moved onto the bone it collapsed onto
+			/// </summary>
+			std::vector<std::vector<render::Bounds>> lodBoneBounds;
+			/// <summary>
+			/// Model space box around the skinned meshes, from the pose the palette was built from
+			/// </summary>
+			render::Bounds bounds;
+			bool isVisible;
+			/// <summary>
+			/// True while the character is culled, the steps it saved up are caught up in one go when it is visible again
+			/// </summary>
+			bool wasCulled;
+		};
+		std::vector<Character> characters;
+		/// <summary>
+		/// Not owned by the world
+		/// </summary>
+		jobs::JobSystem* jobSystem;
+		FixedTimestep timestep;
+		bool useFixedTimestep;
+		// what the characters need to do this frame
+		float frameDeltaTime;
+		unsigned int frameSteps;
+		float frameAlpha;
+		LODGovernor lod;
+		bool useLOD;
+		unsigned int frameIndex;
+		// per character, in character order
+		std::vector<float> lodScreenSizes;
+		std::vector<unsigned int> lodTiers;
+		/// <summary>
+		/// lodCosts[character * numbTiers + tier]
+		/// </summary>
+		std::vector<float> lodCosts;
+		/// <summary>
+		/// FABRIK iterations every character's IK shares each update, refilled by Update
+		/// </summary>
+		ik::IterationBudget ikBudget;
+		/// <summary>
+		/// 0 if IK solves are only limited by their own iteration counts
+		/// </summary>
+		unsigned int ikIterationsPerUpdate;
+	protected:
+		/// <summary>
+		/// Runs a single character's animation frame
+		/// </summary>
+		void UpdateCharacter(unsigned int index);
+		/// <summary>
+		/// Catch a culled character's animation up in one step and rebuild its box, without building its palette or skinning it
+		/// </summary>
+		/// <param name="boneSet">NULL to evaluate every bone</param>
+		void UpdateCulledBounds(Character& character, const LODBoneSet* boneSet, const std::vector<render::Bounds>& boneBounds);
+		void BuildLOD(unsigned int index);
+		static void UpdateCharacters(void* world, unsigned int begin, unsigned int end);
+	public:
+		IAnimationWorld();
+		IAnimationWorld(jobs::JobSystem* jobSystem);
+		void SetJobSystem(jobs::JobSystem* jobSystem);
+		/// <summary>
+		/// Evaluate the characters' animation graphs at a fixed rate instead of every update.
+		/// Updates in between steps only interpolate each bone between the last two steps' poses and rebuild the palette.
+		/// </summary>
+		/// <param name="stepsPerSecond">The animation evaluation rate, e.g. 30. 0 or less evaluates animation every update.</param>
+		void SetFixedTimestep(float stepsPerSecond);
+		bool IsUsingFixedTimestep();
+		/// <summary>
+		/// Turn on level of detail. Every update the governor picks each character's tier from its screen size and the work budget,
+		/// a tier can animate the character less often, collapse its leaf bones onto their parents, and skip CPU skinning.
+		/// </summary>
+		/// <param name="tiers">Ordered from most detailed to least detailed, empty turns level of detail off</param>
+		void SetLODTiers(const std::vector<LODTier>& tiers);
+		/// <summary>
+		/// Get the governor, to set the per frame work budget.
+		/// </summary>
+		LODGovernor& GetLODGovernor();
+		/// <summary>
+		/// Limit the FABRIK iterations all characters' IK nodes can run in one update together. Characters are solved in parallel,
+		/// so which solves are cut short when the budget runs out changes from frame to frame. Solves that get no iterations keep
+		/// their warm started pose, which is last frame's answer applied to this frame's animation.
+		/// </summary>
+		/// <param name="iterationsPerUpdate">0 to only limit each solve by its own iteration count</param>
+		void SetIKIterationBudget(unsigned int iterationsPerUpdate);
+		/// <summary>
+		/// The shared IK budget, to see how much of it the last update used and how many iterations were refused.
+		/// </summary>
+		const ik::IterationBudget& GetIKIterationBudget();
+		/// <summary>
+		/// Tell the world how big a character is on screen, used to pick its level of detail tier.
+		/// </summary>
+		void SetScreenSize(unsigned int character, float screenSize);
+		unsigned int GetLODTier(unsigned int character);
+		/// <summary>
+		/// Tell the world if a character can be seen, e.g. render::Intersects(frustum, render::TransformBounds(model, GetBounds(character))).
+		/// Culled characters aren't skinned and their palettes aren't built. They are only animated to keep their box up to date, at the
+		/// lowest level of detail tier's bones and update interval (every 4 frames without tiers), so they catch up when they are visible again.
+		/// </summary>
+		void SetVisible(unsigned int character, bool isVisible);
+		/// <summary>
+		/// Model space box around the character's skinned meshes, in the pose its palette was last built from. Costs O(bones) per palette rebuild.
+		/// A culled character's box is rebuilt from its lowest level of detail pose, so it may lag its animation by the tier's update interval.
+		/// </summary>
+		/// <returns>Empty if the world has no bone bounds for the character</returns>
+		const render::Bounds& GetBounds(unsigned int character);
+		/// <summary>
+		/// Set the per bone boxes of a character that the world doesn't skin, e.g. a GPU skinned character, see MeshData::BuildBoneBounds.
+		/// Characters added with meshes get their boxes built from the meshes.
+		/// </summary>
+		void SetBoneBounds(unsigned int character, const std::vector<render::Bounds>& boneBounds);
+		/// <summary>
+		/// Add a character to the world.
+		/// </summary>
+		/// <param name="graph">Compiled animation graph definition, can be shared with other characters</param>
+		/// <param name="armature">The character's armature, can be shared with other characters</param>
+		/// <param name="meshes">Meshes to CPU skin every update, NULL when the character is skinned on the GPU.
+		/// Call render::Mesh::UpdateSkinningStreams on them first, the world's threads skin them read only.</param>
+		/// <returns>The index of the character, indices are stable for the lifetime of the world. -1 if the graph is NULL or not compiled, or the armature is NULL.</returns>
+		int AddCharacter(IAnimGraph<CLIPTYPE>* graph, const Armature* armature, const std::vector<render::Mesh>* meshes);
+		unsigned int Size();
+		/// <summary>
+		/// Get a character's graph instance, to set its parameters, IK targets and states before the next update.
+		/// </summary>
+		IAnimGraphInstance<CLIPTYPE>& GetGraphInstance(unsigned int character);
+		/// <summary>
+		/// Advance every character by deltaTime, using every thread in the job system.
+		/// Blocks until all characters are updated.
+		/// </summary>
+		void Update(float deltaTime);
+		/// <summary>
+		/// Get the pose that the character's palette was built from in the last update.
+		/// </summary>
+		Pose& GetPose(unsigned int character);
+		/// <summary>
+		/// Get a character's model space bones, for GPU skinning with a separate inverse bind pose.
+		/// While a level of detail tier collapses bones, a collapsed bone holds the model space matrix of the bone it collapsed onto.
+		/// That is right for bounds and attachments, but not for skinning with the bone's own inverse bind pose: use GetSkinningPalette
+		/// to skin characters with level of detail.
+		/// </summary>
+		std::vector<mat4f>& GetPosedBones(unsigned int character);
+		/// <summary>
+		/// Get a character's skinning matrices (model space bone * inverse bind pose).
+		/// </summary>
+		std::vector<mat4f>& GetSkinningPalette(unsigned int character);
+		/// <summary>
+		/// Copy every character's skinning matrices into one array, in character order.
+		/// </summary>
+		/// <param name="outputArray">Character 'n' starts after the bones of characters 0 to n-1</param>
+		void GatherSkinningPalettes(std::vector<mat4f>& outputArray);
+		/// <summary>
+		/// Goes up by one every update that rebuilds the character's palette. Idle characters keep their pose, palette and skinned
+		/// vertices, if the version is the same as when the palette was last uploaded there is nothing new to upload.
+		/// </summary>
+		unsigned int GetPaletteVersion(unsigned int character);
+		/// <summary>
+		/// Goes up by one every update that CPU skins the character, see GetPaletteVersion.
+		/// </summary>
+		unsigned int GetSkinVersion(unsigned int character);
+		std::vector<f3>& GetSkinnedPositions(unsigned int character, unsigned int mesh);
+		std::vector<f3>& GetSkinnedNormals(unsigned int character, unsigned int mesh);
+	};
+
+	typedef IAnimationWorld<Clip> AnimationWorld;
+	typedef IAnimationWorld<QuickClip> QuickAnimationWorld;
+}
@@ -10,6 +10,10 @@ namespace anim {
 			transforms::srt worldBone = this->bindPose.GetWorldTransform(bone);
 			this->inverseBindPose[bone] = inverse(transforms::toMatrix(worldBone));
 		}
+		this->inverseBindPoseDualQuat.resize(numbBones);
+		for (unsigned int bone = 0; bone < numbBones; bone++) {
+			this->inverseBindPoseDualQuat[bone] = transforms::conjugate(this->bindPose.GetWorldDualQuaternion(bone));
+		}
 	}
 
 	Armature::Armature() {
@@ -38,13 +42,8 @@ namespace anim {
 		return this->inverseBindPose;
 	}
 
-	void Armature::GetInverseBindPose(std::vector<transforms::DualQuaternion>& outputArray) {
-		unsigned int numbBones = this->bindPose.Size();
-		outputArray.resize(numbBones);
-		for (unsigned int boneIndex = 0; boneIndex < numbBones; boneIndex++) {
-			transforms::DualQuaternion worldBone = this->bindPose.GetWorldDualQuaternion(boneIndex);
-			outputArray[boneIndex] = transforms::conjugate(worldBone);
-		}
+	void Armature::GetInverseBindPose(std::vector<transforms::DualQuaternion>& outputArray) const {
+		outputArray = this->inverseBindPoseDualQuat;
 	}
 
 	std::vector<std::string>& Armature::GetBoneNames() {
@@ -54,4 +53,28 @@ namespace anim {
 	std::string& Armature::GetBoneName(unsigned int index) {
 		return this->boneNames[index];
 	}
+
+	const Pose& Armature::GetBindPose() const {
+		return this->bindPose;
+	}
+
+	const Pose& Armature::GetRestPose() const {
+		return this->restPose;
+	}
+
+	const std::vector<mat4f>& Armature::GetInverseBindPose() const {
+		return this->inverseBindPose;
+	}
+
+	const std::vector<transforms::DualQuaternion>& Armature::GetInverseBindPoseDualQuaternion() const {
+		return this->inverseBindPoseDualQuat;
+	}
+
+	const std::vector<std::string>& Armature::GetBoneNames() const {
+		return this->boneNames;
+	}
+
+	const std::string& Armature::GetBoneName(unsigned int index) const {
+		return this->boneNames[index];
+	}
 }
@@ -22,6 +22,10 @@ namespace anim {
 		/// Converts model space vertices to be in a space relative to a bone.
 		/// </summary>
 		std::vector<mat4f> inverseBindPose;
+		/// <summary>
+		/// The inverse bind pose as dual quaternions, for dual quaternion skinning.
+		/// </summary>
+		std::vector<transforms::DualQuaternion> inverseBindPoseDualQuat;
 		std::vector<std::string> boneNames;
 	protected:
 		/// <summary>
@@ -36,8 +40,15 @@ namespace anim {
 		Pose& GetBindPose();
 		Pose& GetRestPose();
 		std::vector<mat4f>& GetInverseBindPose();
-		void GetInverseBindPose(std::vector<transforms::DualQuaternion>& outputArray);
+		void GetInverseBindPose(std::vector<transforms::DualQuaternion>& outputArray) const;
 		std::vector<std::string>& GetBoneNames();
 		std::string& GetBoneName(unsigned int index);
+		// read only access, so one armature can be shared by many threads
+		const Pose& GetBindPose() const;
+		const Pose& GetRestPose() const;
+		const std::vector<mat4f>& GetInverseBindPose() const;
+		const std::vector<transforms::DualQuaternion>& GetInverseBindPoseDualQuaternion() const;
+		const std::vector<std::string>& GetBoneNames() const;
+		const std::string& GetBoneName(unsigned int index) const;
 	};
 }
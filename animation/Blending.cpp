@@ -2,7 +2,7 @@
 
 namespace anim {
 
-	bool IsBoneChildOf(Pose& pose, unsigned int parentBone, unsigned int boneToCheck) {
+	bool IsBoneChildOf(const Pose& pose, unsigned int parentBone, unsigned int boneToCheck) {
 		if (parentBone == boneToCheck) { return true; }
 		int parent = pose.ParentIndexOf(boneToCheck);
 		while (parent >= 0) {
@@ -12,7 +12,7 @@ namespace anim {
 		return false;
 	}
 
-	void Blend(Pose& poseOut, Pose& a, Pose& b, float t, int rootBone) {
+	void Blend(Pose& poseOut, const Pose& a, const Pose& b, float t, int rootBone) {
 		unsigned int numbBones = poseOut.Size();
 		for (unsigned int bone = 0; bone < numbBones; bone++) {
 			// negative root bone is assume to mean the caller wants blending applied to every bone
@@ -24,13 +24,32 @@ namespace anim {
 		}
 	}
 
-	Pose MakePoseForAdding(Armature& armature, Clip& clip) {
+	void InterpolatePose(Pose& poseOut, const Pose& previous, const Pose& current, float t) {
+		if (poseOut.Size() != current.Size()) {
+			// also copies the bone hierarchy into the output pose
+			poseOut = current;
+		}
+		unsigned int numbBones = poseOut.Size();
+		if (t <= 0.0f) {
+			if (&poseOut != &previous) { poseOut = previous; }
+			return;
+		}
+		if (t >= 1.0f) {
+			if (&poseOut != &current) { poseOut = current; }
+			return;
+		}
+		for (unsigned int bone = 0; bone < numbBones; bone++) {
+			poseOut.SetLocalTransform(bone, transforms::mix(previous.GetLocalTransform(bone), current.GetLocalTransform(bone), t));
+		}
+	}
+
+	Pose MakePoseForAdding(const Armature& armature, const Clip& clip) {
 		Pose copy = armature.GetRestPose();
 		clip.Sample(copy, clip.GetStartTime());
 		return copy;
 	}
 
-	void AddToPose(Pose& out, Pose& in, Pose& poseToAdd, Pose& baseAddPose, int rootBone) {
+	void AddToPose(Pose& out, const Pose& in, const Pose& poseToAdd, const Pose& baseAddPose, int rootBone) {
 		// how to add pose:
 		// (add pose delta) = add pose - add pose base
 		// resulting pose = input pose + (add pose delta)
@@ -16,7 +16,7 @@ namespace anim {
 	/// <param name="parentBone"></param>
 	/// <param name="boneToCheck"></param>
 	/// <returns>true if boneToCheck is a child of parentBone in the pose bone hierarchy</returns>
-	bool IsBoneChildOf(Pose& pose, unsigned int parentBone, unsigned int boneToCheck);
+	bool IsBoneChildOf(const Pose& pose, unsigned int parentBone, unsigned int boneToCheck);
 
 	/// <summary>
 	/// Combine two poses together. Assumes the bone hierarchy in each pose is the same.
@@ -26,7 +26,17 @@ namespace anim {
 	/// <param name="b">the pose that is blended onto the base pose</param>
 	/// <param name="t">percentage amount of pose 'b' to include. i.e. 0 implies all pose 'a', no pose 'b'</param>
 	/// <param name="rootBone">-ve to blend entire pose. The starting bone of pose B which is blended into pose 'a'. i.e. left arm to only apply blend to an arm</param>
-	void Blend(Pose& poseOut, Pose& a, Pose& b, float t, int rootBone);
+	void Blend(Pose& poseOut, const Pose& a, const Pose& b, float t, int rootBone);
+
+	/// <summary>
+	/// Interpolates every bone from one pose to another. Cheaper than Blend because there is no bone hierarchy check.
+	/// Used at render time to smooth between the two most recent fixed timestep poses.
+	/// </summary>
+	/// <param name="poseOut">Where the interpolated pose is written, may be either input pose</param>
+	/// <param name="previous">The pose from the previous animation step</param>
+	/// <param name="current">The pose from the most recent animation step</param>
+	/// <param name="t">0 is all previous pose, 1 is all current pose</param>
+	void InterpolatePose(Pose& poseOut, const Pose& previous, const Pose& current, float t);
 
 	/// <summary>
 	/// Samples the clip at time zero into a new pose.
@@ -34,7 +44,7 @@ namespace anim {
 	/// <param name="armature"></param>
 	/// <param name="clip"></param>
 	/// <returns>A pose used as a reference when adding two poses together in the AddToPose function.</returns>
-	Pose MakePoseForAdding(Armature& armature, Clip& clip);
+	Pose MakePoseForAdding(const Armature& armature, const Clip& clip);
 
 	/// <summary>
 	/// Add's one pose to another. i.e. adding a lean left animation onto a walk animation. 
@@ -44,5 +54,5 @@ namespace anim {
 	/// <param name="poseToAdd">The pose to add onto the 'in' pose</param>
 	/// <param name="baseAddPose">TODO</param>
 	/// <param name="rootBone">The starting bone of poseToAdd which is added onto the 'in' Pose. i.e. left arm to only add from the left arm downwards. -ve to add entire pose.</param>
-	void AddToPose(Pose& out, Pose& in, Pose& poseToAdd, Pose& baseAddPose, int rootBone);
+	void AddToPose(Pose& out, const Pose& in, const Pose& poseToAdd, const Pose& baseAddPose, int rootBone);
 }
@@ -6,7 +6,7 @@ namespace anim {
 	template IClip<QuickSRTtrack>;
 
 	template<typename TRACKIMPLTYPE>
-	float IClip<TRACKIMPLTYPE>::ClipTime(float time) {
+	float IClip<TRACKIMPLTYPE>::ClipTime(float time) const {
 		if (this->doesClipLoop) {
 			float clipDuration = endTime - startTime;
 			if (clipDuration <= 0.0f) { return 0.0f; } // invalid clip data
@@ -29,12 +29,12 @@ namespace anim {
 	}
 
 	template<typename TRACKIMPLTYPE>
-	unsigned int IClip<TRACKIMPLTYPE>::Size() {
+	unsigned int IClip<TRACKIMPLTYPE>::Size() const {
 		return (unsigned int) this->tracks.size();
 	}
 
 	template<typename TRACKIMPLTYPE>
-	unsigned int IClip<TRACKIMPLTYPE>::GetTrackBoneIDAtIndex(unsigned int index) {
+	unsigned int IClip<TRACKIMPLTYPE>::GetTrackBoneIDAtIndex(unsigned int index) const {
 		return this->tracks[index].GetID();
 	}
 
@@ -56,14 +56,47 @@ namespace anim {
 		return tracks.back();
 	}
 
+	template<typename TRACKIMPLTYPE>
+	const TRACKIMPLTYPE* IClip<TRACKIMPLTYPE>::GetTrack(unsigned int boneID) const {
+		unsigned int numbTracks = this->tracks.size();
+		for (unsigned int track = 0; track < numbTracks; track++) {
+			if (this->tracks[track].GetID() == boneID) {
+				return &this->tracks[track];
+			}
+		}
+		return NULL;
+	}
+
+	template<typename TRACKIMPLTYPE>
+	const TRACKIMPLTYPE& IClip<TRACKIMPLTYPE>::GetTrackAtIndex(unsigned int index) const {
+		return this->tracks[index];
+	}
+
 	template<typename TRACKTYPEIMPL>
-	float IClip<TRACKTYPEIMPL>::Sample(Pose& pose, float time)
+	float IClip<TRACKTYPEIMPL>::Sample(Pose& pose, float time) const
+	{
+		if (this->GetDuration() == 0.0f) { return 0.0f; }
+		time = this->ClipTime(time);
+		unsigned int numbTracks = this->tracks.size();
+		for (unsigned int track = 0; track < numbTracks; track++) {
+			unsigned int boneIndex = tracks[track].GetID();
+			transforms::srt localTransform = pose.GetLocalTransform(boneIndex);
+			transforms::srt animatedTransform = tracks[track].Sample(localTransform, time, this->doesClipLoop);
+			pose.SetLocalTransform(boneIndex, animatedTransform);
+		}
+		return time;
+	}
+
+	template<typename TRACKIMPLTYPE>
+	float IClip<TRACKIMPLTYPE>::Sample(Pose& pose, float time, const std::vector<bool>& activeBones) const
 	{
 		if (this->GetDuration() == 0.0f) { return 0.0f; }
 		time = this->ClipTime(time);
 		unsigned int numbTracks = this->tracks.size();
+		unsigned int numbActive = activeBones.size();
 		for (unsigned int track = 0; track < numbTracks; track++) {
 			unsigned int boneIndex = tracks[track].GetID();
+			if (boneIndex < numbActive && !activeBones[boneIndex]) { continue; }
 			transforms::srt localTransform = pose.GetLocalTransform(boneIndex);
 			transforms::srt animatedTransform = tracks[track].Sample(localTransform, time, this->doesClipLoop);
 			pose.SetLocalTransform(boneIndex, animatedTransform);
@@ -99,28 +132,33 @@ namespace anim {
 		return this->clipName;
 	}
 
+	template<typename TRACKTYPEIMPL>
+	const std::string& IClip<TRACKTYPEIMPL>::GetClipName() const {
+		return this->clipName;
+	}
+
 	template<typename TRACKTYPEIMPL>
 	void IClip<TRACKTYPEIMPL>::SetClipName(std::string& name) {
 		this->clipName = name;
 	}
 
 	template<typename TRACKTYPEIMPL>
-	float IClip<TRACKTYPEIMPL>::GetDuration() {
+	float IClip<TRACKTYPEIMPL>::GetDuration() const {
 		return this->endTime - this->startTime;
 	}
 
 	template<typename TRACKTYPEIMPL>
-	float IClip<TRACKTYPEIMPL>::GetStartTime() {
+	float IClip<TRACKTYPEIMPL>::GetStartTime() const {
 		return this->startTime;
 	}
 
 	template<typename TRACKTYPEIMPL>
-	float IClip<TRACKTYPEIMPL>::GetEndTime() {
+	float IClip<TRACKTYPEIMPL>::GetEndTime() const {
 		return this->endTime;
 	}
 
 	template<typename TRACKTYPEIMPL>
-	bool IClip<TRACKTYPEIMPL>::DoesClipLoop() {
+	bool IClip<TRACKTYPEIMPL>::DoesClipLoop() const {
 		return this->doesClipLoop;
 	}
 
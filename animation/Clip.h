@@ -27,20 +27,20 @@ namespace anim{
 		/// </summary>
 		/// <param name="time"></param>
 		/// <returns></returns>
-		float ClipTime(float time);
+		float ClipTime(float time) const;
 	public:
 		IClip();
 		/// <summary>
 		/// Get the number of bones this animation clip is supposed to work with
 		/// </summary>
 		/// <returns>The number of bones this track is using</returns>
-		unsigned int Size();
+		unsigned int Size() const;
 		/// <summary>
 		/// Get the Bone ID that is influenced by the animation track stored at a specific index.
 		/// </summary>
 		/// <param name="index">The index of the animation track in the clip's track vector</param>
 		/// <returns></returns>
-		unsigned int GetTrackBoneIDAtIndex(unsigned int index);
+		unsigned int GetTrackBoneIDAtIndex(unsigned int index) const;
 		/// <summary>
 		/// Change the bone that is influenced by an animation track stored in this clip's track vector.
 		/// </summary>
@@ -50,26 +50,50 @@ namespace anim{
 		/// <summary>
 		/// Returns the animation track for a given bone ID.
 		/// If no track exists for the bone ID, one is created and returned.
+		/// This modifies the clip, use GetTrack when the clip is shared between threads.
 		/// </summary>
 		/// <param name="boneID"></param>
 		/// <returns></returns>
 		TRACKIMPLTYPE& operator[](unsigned int boneID);
 		/// <summary>
+		/// Read only look up of the animation track for a given bone ID.
+		/// </summary>
+		/// <param name="boneID"></param>
+		/// <returns>The track that animates the bone, NULL if the clip doesn't animate the bone</returns>
+		const TRACKIMPLTYPE* GetTrack(unsigned int boneID) const;
+		/// <summary>
+		/// Read only access to the animation track stored at an index in the clip's track vector.
+		/// </summary>
+		/// <param name="index"></param>
+		/// <returns></returns>
+		const TRACKIMPLTYPE& GetTrackAtIndex(unsigned int index) const;
+		/// <summary>
 		/// Samples the animation clip and writes the resulting pose into pose.
 		/// Does nothing if the clip contains no valid animation data.
 		/// The provided sample time will be remapped to be in the clip's valid time range.
+		/// Sampling doesn't modify the clip, so one clip can be sampled by many threads at once, each into its own pose.
+		/// </summary>
+		/// <param name="pose">The pose that the sample is written to</param>
+		/// <param name="time">The time at which the clip should be sampled</param>
+		/// <returns>The time that was actually used to sample the clip.</returns>
+		float Sample(Pose& pose, float time) const;
+		/// <summary>
+		/// Samples only the tracks of the active bones, used by reduced level of detail skeletons.
+		/// Tracks of inactive bones are skipped and leave the pose's bone untouched.
 		/// </summary>
 		/// <param name="pose">The pose that the sample is written to</param>
 		/// <param name="time">The time at which the clip should be sampled</param>
+		/// <param name="activeBones">activeBones[bone] is true if the bone should be sampled</param>
 		/// <returns>The time that was actually used to sample the clip.</returns>
-		float Sample(Pose& pose, float time);
+		float Sample(Pose& pose, float time, const std::vector<bool>& activeBones) const;
 		void CalculateClipDuration();
 		std::string& GetClipName();
+		const std::string& GetClipName() const;
 		void SetClipName(std::string& name);
-		float GetDuration();
-		float GetStartTime();
-		float GetEndTime();
-		bool DoesClipLoop();
+		float GetDuration() const;
+		float GetStartTime() const;
+		float GetEndTime() const;
+		bool DoesClipLoop() const;
 		void SetClipLooping(bool doesClipLoop);
 	};
 
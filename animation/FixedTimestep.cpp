@@ -0,0 +1,58 @@
+#include "FixedTimestep.h"
+
+namespace anim {
+
+	FixedTimestep::FixedTimestep() {
+		this->accumulator = 0.0f;
+		this->maxStepsPerUpdate = 4;
+		this->SetRate(30.0f);
+	}
+
+	FixedTimestep::FixedTimestep(float stepsPerSecond) {
+		this->accumulator = 0.0f;
+		this->maxStepsPerUpdate = 4;
+		this->SetRate(stepsPerSecond);
+	}
+
+	void FixedTimestep::SetRate(float stepsPerSecond) {
+		if (stepsPerSecond <= 0.0f) { stepsPerSecond = 30.0f; }
+		this->stepSize = 1.0f / stepsPerSecond;
+	}
+
+	float FixedTimestep::GetRate() {
+		return 1.0f / this->stepSize;
+	}
+
+	float FixedTimestep::GetStepSize() {
+		return this->stepSize;
+	}
+
+	void FixedTimestep::SetMaxStepsPerUpdate(unsigned int maxSteps) {
+		this->maxStepsPerUpdate = maxSteps > 0 ? maxSteps : 1;
+	}
+
+	unsigned int FixedTimestep::Advance(float deltaTime) {
+		if (deltaTime > 0.0f) {
+			this->accumulator += deltaTime;
+		}
+		unsigned int numbSteps = 0;
+		while (this->accumulator >= this->stepSize && numbSteps < this->maxStepsPerUpdate) {
+			this->accumulator -= this->stepSize;
+			numbSteps++;
+		}
+		if (this->accumulator >= this->stepSize) {
+			// we fell behind, drop the time we can't catch up on
+			this->accumulator = 0.0f;
+		}
+		return numbSteps;
+	}
+
+	float FixedTimestep::GetAlpha() {
+		float alpha = this->accumulator / this->stepSize;
+		return alpha > 1.0f ? 1.0f : alpha;
+	}
+
+	void FixedTimestep::Reset() {
+		this->accumulator = 0.0f;
+	}
+}
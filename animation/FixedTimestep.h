@@ -0,0 +1,49 @@
+#pragma once
+
+namespace anim {
+
+	/// <summary>
+	/// Decouples the animation update rate from the render frame rate.
+	/// Frame time is accumulated and spent in fixed sized steps, e.g. 30 steps per second. The caller keeps the poses
+	/// produced by the last two steps and, when rendering, interpolates between them using GetAlpha (see InterpolatePose).
+	/// At 144 frames per second with a 30Hz step, animation is only evaluated on roughly one frame in five.
+	/// </summary>
+	class FixedTimestep {
+	protected:
+		float stepSize;
+		float accumulator;
+		/// <summary>
+		/// Caps the number of steps taken in one update, so a long frame doesn't snowball into even longer frames.
+		/// Time that doesn't fit into the cap is dropped.
+		/// </summary>
+		unsigned int maxStepsPerUpdate;
+	public:
+		/// <summary>
+		/// Create a fixed timestep that runs at 30 steps per second
+		/// </summary>
+		FixedTimestep();
+		FixedTimestep(float stepsPerSecond);
+		void SetRate(float stepsPerSecond);
+		float GetRate();
+		/// <summary>
+		/// The amount of time that passes in one step, in seconds.
+		/// </summary>
+		float GetStepSize();
+		void SetMaxStepsPerUpdate(unsigned int maxSteps);
+		/// <summary>
+		/// Add frame time to the accumulator.
+		/// </summary>
+		/// <param name="deltaTime">Time since the last call, in seconds</param>
+		/// <returns>The number of fixed steps that should be run this frame, can be zero</returns>
+		unsigned int Advance(float deltaTime);
+		/// <summary>
+		/// How far the current time is between the last step and the next step.
+		/// </summary>
+		/// <returns>Interpolation amount from the previous step's pose to the current step's pose, range [0,1]</returns>
+		float GetAlpha();
+		/// <summary>
+		/// Throw away any accumulated time.
+		/// </summary>
+		void Reset();
+	};
+}
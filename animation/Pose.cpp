@@ -1,5 +1,7 @@
 #include "Pose.h"
+#include "../Fingerprint.h"
 #include <cassert>
+#include <iostream>
 
 namespace anim {
 
@@ -43,11 +45,11 @@ namespace anim {
 		this->bones.resize(numbBones);
 	}
 
-	unsigned int Pose::Size() {
+	unsigned int Pose::Size() const {
 		return this->bones.size();
 	}
 
-	int Pose::ParentIndexOf(unsigned int boneIndex)	{
+	int Pose::ParentIndexOf(unsigned int boneIndex) const {
 		return this->boneParents[boneIndex];
 	}
 
@@ -55,7 +57,7 @@ namespace anim {
 		this->boneParents[boneIndex] = parentIndex;
 	}
 
-	transforms::srt Pose::GetLocalTransform(unsigned int boneIndex) {
+	transforms::srt Pose::GetLocalTransform(unsigned int boneIndex) const {
 		assert(boneIndex < this->bones.size());
 		return this->bones[boneIndex];
 	}
@@ -64,7 +66,7 @@ namespace anim {
 		this->bones[boneIndex] = localTransform;
 	}
 
-	transforms::srt Pose::GetWorldTransform(unsigned int boneIndex)	{
+	transforms::srt Pose::GetWorldTransform(unsigned int boneIndex) const {
 		// make a copy of the local transform
 		transforms::srt result = this->bones[boneIndex];
 		// follow the bone hierarchy
@@ -76,7 +78,7 @@ namespace anim {
 		return result;
 	}
 
-	transforms::DualQuaternion Pose::GetWorldDualQuaternion(unsigned int boneIndex) {
+	transforms::DualQuaternion Pose::GetWorldDualQuaternion(unsigned int boneIndex) const {
 		// start at local joint, and accumulate parent transforms until root is reached
 		transforms::DualQuaternion result = transforms::toDualQuaternion(this->GetLocalTransform(boneIndex));
 		int parentIndex = this->ParentIndexOf(boneIndex);
@@ -89,11 +91,11 @@ namespace anim {
 		return result;
 	}
 
-	transforms::srt Pose::operator[](unsigned int boneIndex) {
+	transforms::srt Pose::operator[](unsigned int boneIndex) const {
 		return GetWorldTransform(boneIndex);
 	}
 
-	void Pose::ToMatrixPalette(std::vector<mat4f>& outputArray)	{
+	void Pose::ToMatrixPalette(std::vector<mat4f>& outputArray) const {
 		unsigned int numbBones = this->Size();
 		if (outputArray.size() != numbBones) {
 			outputArray.resize(numbBones);
@@ -116,7 +118,111 @@ namespace anim {
 		}
 	}
 
-	void Pose::ToDualQuaternionPalette(std::vector < transforms::DualQuaternion>& outputArray) {
+	void Pose::ToMatrixPalette(std::vector<mat4f>& outputArray, const std::vector<unsigned int>& boneRemap) const {
+		unsigned int numbBones = this->Size();
+		if (boneRemap.size() != numbBones) {
+			this->ToMatrixPalette(outputArray);
+			return;
+		}
+		if (outputArray.size() != numbBones) {
+			outputArray.resize(numbBones);
+		}
+		unsigned int bone = 0;
+		for (; bone < numbBones; bone++) {
+			int parentOfBone = this->boneParents[bone];
+			if (parentOfBone > (int) bone) { break; }
+			unsigned int target = boneRemap[bone];
+			if (target != bone) {
+				// ancestors come first, so the bone we collapsed onto is already done
+				outputArray[bone] = outputArray[target];
+				continue;
+			}
+			mat4f boneAsMatrix = transforms::toMatrix(this->bones[bone]);
+			if (parentOfBone >= 0) {
+				boneAsMatrix = outputArray[parentOfBone] * boneAsMatrix;
+			}
+			outputArray[bone] = boneAsMatrix;
+		}
+		for (; bone < numbBones; bone++) {
+			transforms::srt transform = this->GetWorldTransform(boneRemap[bone]);
+			outputArray[bone] = transforms::toMatrix(transform);
+		}
+	}
+
+	bool Pose::ToSkinningPalette(std::vector<mat4f>& paletteOut, const std::vector<mat4f>& inverseBindPose) const {
+		unsigned int numbBones = this->Size();
+		if (inverseBindPose.size() < numbBones) {
+			std::cout << "skinning palette: the inverse bind pose has fewer bones than the pose\n";
+			paletteOut.clear();
+			return false;
+		}
+		// children still need their parent's model space matrix, so the inverse bind pose can only be applied once every bone is posed
+		this->ToMatrixPalette(paletteOut);
+		for (unsigned int bone = 0; bone < numbBones; bone++) {
+			paletteOut[bone] = paletteOut[bone] * inverseBindPose[bone];
+		}
+		return true;
+	}
+
+	bool Pose::ToSkinningPalette(std::vector<mat4f>& posedBonesOut, std::vector<mat4f>& paletteOut, const std::vector<mat4f>& inverseBindPose) const {
+		unsigned int numbBones = this->Size();
+		if (inverseBindPose.size() < numbBones) {
+			std::cout << "skinning palette: the inverse bind pose has fewer bones than the pose\n";
+			posedBonesOut.clear();
+			paletteOut.clear();
+			return false;
+		}
+		if (posedBonesOut.size() != numbBones) {
+			posedBonesOut.resize(numbBones);
+		}
+		if (paletteOut.size() != numbBones) {
+			paletteOut.resize(numbBones);
+		}
+		unsigned int bone = 0;
+		for (; bone < numbBones; bone++) {
+			int parentOfBone = this->boneParents[bone];
+			if (parentOfBone > (int) bone) { break; }
+			mat4f boneAsMatrix = transforms::toMatrix(this->bones[bone]);
+			if (parentOfBone >= 0) {
+				boneAsMatrix = posedBonesOut[parentOfBone] * boneAsMatrix;
+			}
+			posedBonesOut[bone] = boneAsMatrix;
+			paletteOut[bone] = boneAsMatrix * inverseBindPose[bone];
+		}
+		for (; bone < numbBones; bone++) {
+			posedBonesOut[bone] = transforms::toMatrix(this->GetWorldTransform(bone));
+			paletteOut[bone] = posedBonesOut[bone] * inverseBindPose[bone];
+		}
+		return true;
+	}
+
+	bool Pose::ToSkinningPalette(std::vector<mat4f>& posedBonesOut, std::vector<mat4f>& paletteOut, const std::vector<mat4f>& inverseBindPose, const std::vector<unsigned int>& boneRemap) const {
+		unsigned int numbBones = this->Size();
+		if (boneRemap.size() != numbBones) {
+			return this->ToSkinningPalette(posedBonesOut, paletteOut, inverseBindPose);
+		}
+		if (inverseBindPose.size() < numbBones) {
+			std::cout << "skinning palette: the inverse bind pose has fewer bones than the pose\n";
+			posedBonesOut.clear();
+			paletteOut.clear();
+			return false;
+		}
+		this->ToMatrixPalette(posedBonesOut, boneRemap);
+		if (paletteOut.size() != numbBones) {
+			paletteOut.resize(numbBones);
+		}
+		for (unsigned int bone = 0; bone < numbBones; bone++) {
+			if (boneRemap[bone] != bone) { continue; }
+			paletteOut[bone] = posedBonesOut[bone] * inverseBindPose[bone];
+		}
+		for (unsigned int bone = 0; bone < numbBones; bone++) {
+			if (boneRemap[bone] == bone) { continue; }
+			paletteOut[bone] = paletteOut[boneRemap[bone]];
+		}
+		return true;
+	}
+
+	void Pose::ToDualQuaternionPalette(std::vector < transforms::DualQuaternion>& outputArray) const {
 		unsigned int numbBones = this->Size();
 		if (outputArray.size() != numbBones) {
 			outputArray.resize(numbBones);
@@ -127,7 +233,45 @@ namespace anim {
 		}
 	}
 
-	bool Pose::operator==(const Pose& other) {
+	void Pose::ToDualQuaternionSkinningPalette(std::vector<transforms::DualQuaternion>& posedBonesOut, std::vector<transforms::DualQuaternion>& paletteOut, const std::vector<transforms::DualQuaternion>& inverseBindPose) const {
+		unsigned int numbBones = this->Size();
+		if (inverseBindPose.size() < numbBones) {
+			std::cout << "dual quaternion skinning palette: the inverse bind pose has fewer bones than the pose\n";
+			return;
+		}
+		if (posedBonesOut.size() != numbBones) {
+			posedBonesOut.resize(numbBones);
+		}
+		if (paletteOut.size() != numbBones) {
+			paletteOut.resize(numbBones);
+		}
+		unsigned int bone = 0;
+		for (; bone < numbBones; bone++) {
+			int parentOfBone = this->boneParents[bone];
+			if (parentOfBone > (int) bone) { break; }
+			transforms::DualQuaternion boneAsDualQuat = transforms::toDualQuaternion(this->bones[bone]);
+			if (parentOfBone >= 0) {
+				boneAsDualQuat = boneAsDualQuat * posedBonesOut[parentOfBone];
+			}
+			posedBonesOut[bone] = boneAsDualQuat;
+			paletteOut[bone] = inverseBindPose[bone] * boneAsDualQuat;
+		}
+		for (; bone < numbBones; bone++) {
+			posedBonesOut[bone] = this->GetWorldDualQuaternion(bone);
+			paletteOut[bone] = inverseBindPose[bone] * posedBonesOut[bone];
+		}
+	}
+
+	unsigned long long Pose::Fingerprint() const {
+		static_assert(sizeof(transforms::srt) == 10 * sizeof(float), "srt is hashed as ten floats");
+		unsigned int numbBones = this->Size();
+		unsigned long long fingerprint = ::Fingerprint(&numbBones, 1, FingerprintSeed);
+		if (numbBones == 0) { return fingerprint; }
+		fingerprint = ::Fingerprint(&this->bones[0], numbBones * 10, fingerprint);
+		return ::Fingerprint(&this->boneParents[0], numbBones, fingerprint);
+	}
+
+	bool Pose::operator==(const Pose& other) const {
 		if (this->bones.size() != other.bones.size()) { return false; }
 		if (this->boneParents.size() != other.boneParents.size()) { return false; }
 		unsigned int numbBones = this->Size();
@@ -144,7 +288,7 @@ namespace anim {
 		return true;
 	}
 
-	bool Pose::operator!=(const Pose& other) {
+	bool Pose::operator!=(const Pose& other) const {
 		return !(*this == other);
 	}
 }
@@ -31,32 +31,80 @@ namespace anim {
 		/// <returns></returns>
 		Pose& operator=(const Pose& pose);
 		void Resize(unsigned int numbBones);
-		unsigned int Size();
+		unsigned int Size() const;
 		/// <summary>
 		/// Find the index of a bone's parent
 		/// </summary>
 		/// <param name="boneIndex">The index of the bone whose parent we are trying to find</param>
 		/// <returns>The index of the bone's parent. Result is negative if bone has no parent.</returns>
-		int ParentIndexOf(unsigned int boneIndex);
+		int ParentIndexOf(unsigned int boneIndex) const;
 		void SetParentIndex(unsigned int boneIndex, unsigned int parentIndex);
-		transforms::srt GetLocalTransform(unsigned int boneIndex);
+		transforms::srt GetLocalTransform(unsigned int boneIndex) const;
 		void SetLocalTransform(unsigned int boneIndex, const transforms::srt& localTransform);
-		transforms::srt GetWorldTransform(unsigned int boneIndex);
-		transforms::DualQuaternion GetWorldDualQuaternion(unsigned int boneIndex);
-		transforms::srt operator[](unsigned int boneIndex);
+		transforms::srt GetWorldTransform(unsigned int boneIndex) const;
+		transforms::DualQuaternion GetWorldDualQuaternion(unsigned int boneIndex) const;
+		transforms::srt operator[](unsigned int boneIndex) const;
 		/// <summary>
 		/// Converts each bone's world space SRT into a matrix 4 and writes matrix into the output array.
 		/// Used for transferring data to the GPU.
 		/// </summary>
 		/// <param name="outputArray"></param>
-		void ToMatrixPalette(std::vector<mat4f>& outputArray);
+		void ToMatrixPalette(std::vector<mat4f>& outputArray) const;
+		/// <summary>
+		/// Converts the pose into a matrix palette for a reduced level of detail skeleton.
+		/// Only bones that map onto themselves are evaluated, every other bone copies the matrix of the bone it was collapsed onto.
+		/// The result is for bounds and other model space uses, multiplying a collapsed bone's copy by that bone's own inverse bind pose
+		/// doesn't give the skinning matrix, see ToSkinningPalette with a bone remap.
+		/// </summary>
+		/// <param name="outputArray"></param>
+		/// <param name="boneRemap">boneRemap[bone] is the bone whose matrix 'bone' uses, a collapsed bone must map onto one of its ancestors</param>
+		void ToMatrixPalette(std::vector<mat4f>& outputArray, const std::vector<unsigned int>& boneRemap) const;
+		/// <summary>
+		/// Builds the skinning matrices of the pose, [model space bone * inverse bind pose] for every bone.
+		/// Skinning with the result doesn't need the inverse bind pose, each bone's product is worked out once here instead of once per vertex.
+		/// </summary>
+		/// <param name="paletteOut">The skinning matrices, resized to the number of bones</param>
+		/// <param name="inverseBindPose">The armature's inverse bind pose, one matrix per bone</param>
+		/// <returns>False if the inverse bind pose has fewer bones than the pose, the outputs are left empty</returns>
+		bool ToSkinningPalette(std::vector<mat4f>& paletteOut, const std::vector<mat4f>& inverseBindPose) const;
+		/// <summary>
+		/// Builds the skinning matrices of the pose, and keeps the model space bones that were used to make them.
+		/// </summary>
+		/// <param name="posedBonesOut">Each bone in model space, resized to the number of bones</param>
+		/// <param name="paletteOut">The skinning matrices, resized to the number of bones</param>
+		/// <param name="inverseBindPose">The armature's inverse bind pose, one matrix per bone</param>
+		/// <returns>False if the inverse bind pose has fewer bones than the pose, the outputs are left empty</returns>
+		bool ToSkinningPalette(std::vector<mat4f>& posedBonesOut, std::vector<mat4f>& paletteOut, const std::vector<mat4f>& inverseBindPose) const;
+		/// <summary>
+		/// Builds the skinning matrices of a reduced level of detail skeleton, collapsed bones reuse the skinning matrix of the bone they collapsed onto.
+		/// </summary>
+		/// <param name="posedBonesOut">Each bone in model space, collapsed bones copy the bone they collapsed onto. Skin with paletteOut, not with these and the inverse bind pose.</param>
+		/// <param name="paletteOut">The skinning matrices</param>
+		/// <param name="inverseBindPose">The armature's inverse bind pose, one matrix per bone</param>
+		/// <param name="boneRemap">boneRemap[bone] is the bone whose matrix 'bone' uses, see ToMatrixPalette</param>
+		/// <returns>False if the inverse bind pose has fewer bones than the pose, the outputs are left empty</returns>
+		bool ToSkinningPalette(std::vector<mat4f>& posedBonesOut, std::vector<mat4f>& paletteOut, const std::vector<mat4f>& inverseBindPose, const std::vector<unsigned int>& boneRemap) const;
 		/// <summary>
 		/// Converts each bone into a world space dual quaternion and writes the result into the output array.
 		/// Used for transferring data to the GPU.
 		/// </summary>
 		/// <param name="outputArray"></param>
-		void ToDualQuaternionPalette(std::vector<transforms::DualQuaternion>& outputArray);
-		bool operator==(const Pose& other);
-		bool operator!=(const Pose& other);
+		void ToDualQuaternionPalette(std::vector<transforms::DualQuaternion>& outputArray) const;
+		/// <summary>
+		/// Builds the dual quaternion skinning palette of the pose, [inverse bind pose * model space bone] for every bone (dual quaternions multiply left to right).
+		/// Each bone's model space dual quaternion is built from its parent's, instead of walking up to the root once per bone.
+		/// </summary>
+		/// <param name="posedBonesOut">Each bone in model space, resized to the number of bones</param>
+		/// <param name="paletteOut">The skinning dual quaternions, resized to the number of bones</param>
+		/// <param name="inverseBindPose">The armature's inverse bind pose, see Armature::GetInverseBindPose</param>
+		void ToDualQuaternionSkinningPalette(std::vector<transforms::DualQuaternion>& posedBonesOut, std::vector<transforms::DualQuaternion>& paletteOut, const std::vector<transforms::DualQuaternion>& inverseBindPose) const;
+		/// <summary>
+		/// A 64 bit hash of the exact bits of every bone and parent index. Much cheaper than operator== as there's no second pose to keep,
+		/// compare it with last frame's fingerprint to skip rebuilding the palette and skinning when a character didn't move.
+		/// Equal poses always have equal fingerprints, different poses collide with a chance of about 1 in 2^64.
+		/// </summary>
+		unsigned long long Fingerprint() const;
+		bool operator==(const Pose& other) const;
+		bool operator!=(const Pose& other) const;
 	};
 }
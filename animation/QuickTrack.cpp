@@ -8,8 +8,8 @@ namespace anim {
 	template QuickTrack<rotation::quaternion, 4>;
 
 	template<typename T, int FrameDimension>
-	int QuickTrack<T, FrameDimension>::FrameIndexAt(float time, bool isTrackLooping) {
-		std::vector<Frame<FrameDimension>>& frames = this->frames;
+	int QuickTrack<T, FrameDimension>::FrameIndexAt(float time, bool isTrackLooping) const {
+		const std::vector<Frame<FrameDimension>>& frames = this->frames;
 		// code lifted from original track implementation of nearestFrameAt
 		unsigned int trackSize = (unsigned int) frames.size();
 		if (trackSize <= 1) { return -1; }
@@ -12,7 +12,7 @@ namespace anim {
 	class QuickTrack : public Track<T, FrameDimension> {
 	protected:
 		std::vector<unsigned int> nearestFrameIndices;
-		virtual int FrameIndexAt(float time, bool isTrackLooping);
+		virtual int FrameIndexAt(float time, bool isTrackLooping) const;
 		float expectedFramesPerSecond;
 	public:
 		void RecalculateFrameIndexCache();
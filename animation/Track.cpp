@@ -44,16 +44,19 @@ namespace anim {
 	}
 
 	template<typename T, int FrameDimension>
-	float Track<T, FrameDimension>::GetStartTime() { return this->frames[0].timestamp; }
+	float Track<T, FrameDimension>::GetStartTime() const { return this->frames[0].timestamp; }
 
 	template<typename T, int FrameDimension>
-	float Track<T, FrameDimension>::GetEndTime() { return this->frames[frames.size() - 1].timestamp; }
+	float Track<T, FrameDimension>::GetEndTime() const { return this->frames[frames.size() - 1].timestamp; }
 
 	template<typename T, int FrameDimension>
 	Frame<FrameDimension>& Track<T, FrameDimension>::operator[](unsigned int frameIndex) { return this->frames[frameIndex]; }
 
 	template<typename T, int FrameDimension>
-	int Track<T, FrameDimension>::FrameIndexAt(float time, bool isTrackLooping) {
+	const Frame<FrameDimension>& Track<T, FrameDimension>::operator[](unsigned int frameIndex) const { return this->frames[frameIndex]; }
+
+	template<typename T, int FrameDimension>
+	int Track<T, FrameDimension>::FrameIndexAt(float time, bool isTrackLooping) const {
 		unsigned int trackSize = (unsigned int)this->frames.size();
 		if (trackSize <= 1) { return -1; }
 		if (isTrackLooping) {
@@ -89,7 +92,7 @@ namespace anim {
 	}
 
 	template<typename T, int FrameSize>
-	float Track<T, FrameSize>::ClipTime(float time, bool isTrackLooping) {
+	float Track<T, FrameSize>::ClipTime(float time, bool isTrackLooping) const {
 		unsigned int trackSize = (unsigned int)frames.size();
 		if (trackSize <= 1) {
 			// if we have less than two frames, we can't do interpolation
@@ -112,19 +115,19 @@ namespace anim {
 	}
 
 	template<typename T, int FrameDimension>
-	unsigned int Track<T, FrameDimension>::Size() { return this->frames.size(); }
+	unsigned int Track<T, FrameDimension>::Size() const { return this->frames.size(); }
 
 	template<typename T, int FrameDimension>
 	void Track<T, FrameDimension>::Resize(unsigned int numbFrames) { this->frames.resize(numbFrames); }
 
 	template<typename T, int FrameDimension>
-	Interpolate Track<T, FrameDimension>::GetInterpolationMethod() { return this->interpolation; }
+	Interpolate Track<T, FrameDimension>::GetInterpolationMethod() const { return this->interpolation; }
 
 	template<typename T, int FrameDimension>
 	void Track<T, FrameDimension>::SetInterpolationMethod(Interpolate method) { this->interpolation = method; }
 
 	template<typename T, int FrameDimension>
-	T Track<T, FrameDimension>::Sample(float time, bool isTrackLooping) {
+	T Track<T, FrameDimension>::Sample(float time, bool isTrackLooping) const {
 		switch (this->interpolation) {
 		case Interpolate::Constant: return this->SampleConstant(time, isTrackLooping);
 		case Interpolate::Linear: return this->SampleLinear(time, isTrackLooping);
@@ -135,7 +138,7 @@ namespace anim {
 	}
 
 	template<typename T, int FrameDimension>
-	T Track<T, FrameDimension>::SampleHermite(float time, const T& point1, const T& slope1, const T& point2, const T& slope2) {
+	T Track<T, FrameDimension>::SampleHermite(float time, const T& point1, const T& slope1, const T& point2, const T& slope2) const {
 		// I verified that 'a' here is the same as 'a' in hermite in curve.h by working on pen and paper.
 		// It has simply been re-arranged. The same is also true for 'b', 'c', 'd'
 		float tt = time * time, ttt = tt*time;
@@ -150,18 +153,18 @@ namespace anim {
 	}
 
 	template<typename T, int FrameSize>
-	T Track<T, FrameSize>::SampleConstant(float time, bool isTrackLooping) {
+	T Track<T, FrameSize>::SampleConstant(float time, bool isTrackLooping) const {
 		int index = this->FrameIndexAt(time, isTrackLooping);
 		if (index < 0 || index >= (int)frames.size()) {
 			// something weird happened
 			return T();
 		}
-		float* data = &frames[index].value[0];
+		const float* data = &frames[index].value[0];
 		return ToType(data);
 	}
 
 	template<typename T, int FrameSize>
-	T Track<T, FrameSize>::SampleLinear(float time, bool isTrackLooping) {
+	T Track<T, FrameSize>::SampleLinear(float time, bool isTrackLooping) const {
 		int index = this->FrameIndexAt(time, isTrackLooping);
 		if (index < 0 || index >= (int)frames.size()-1) { return T(); }
 		float frameTime = frames[index].timestamp;
@@ -179,7 +182,7 @@ namespace anim {
 	}
 
 	template<typename T, int FrameSize>
-	T Track<T, FrameSize>::SampleCubic(float time, bool isTrackLooping) {
+	T Track<T, FrameSize>::SampleCubic(float time, bool isTrackLooping) const {
 		// not sure why the book author didn't pull this logic up into another function instead of ctrl c, ctrl v
 		// get the indices of the frames we'll be interpolating between
 		int index = this->FrameIndexAt(time, isTrackLooping);
@@ -215,15 +218,15 @@ namespace anim {
 		return SampleHermite(t, point1, slope1, point2, slope2);
 	}
 
-	template<> float Track<float, 1>::ToType(float* frameDataArray) {
+	template<> float Track<float, 1>::ToType(const float* frameDataArray) const {
 		return frameDataArray[0];
 	}
 
-	template<> f3 Track<f3, 3>::ToType(float* frameDataArray) {
+	template<> f3 Track<f3, 3>::ToType(const float* frameDataArray) const {
 		return f3(frameDataArray[0], frameDataArray[1], frameDataArray[2]);
 	}
 
-	template<> rotation::quaternion Track<rotation::quaternion, 4>::ToType(float* frameDataArray) {
+	template<> rotation::quaternion Track<rotation::quaternion, 4>::ToType(const float* frameDataArray) const {
 		return rotation::normalized(rotation::quaternion(
 			frameDataArray[0], frameDataArray[1], frameDataArray[2], frameDataArray[3]
 		));
@@ -28,28 +28,30 @@ namespace anim {
 		/// Get the number of animation frames in this animation track
 		/// </summary>
 		/// <returns>The number of animation frames stored in the animation track</returns>
-		unsigned int Size();
+		unsigned int Size() const;
 		/// <summary>
 		/// Gets the interpolation method being used to interpolate between frames in this animation track.
 		/// </summary>
 		/// <returns></returns>
-		Interpolate GetInterpolationMethod();
+		Interpolate GetInterpolationMethod() const;
 		void SetInterpolationMethod(Interpolate method);
-		float GetStartTime();
-		float GetEndTime();
+		float GetStartTime() const;
+		float GetEndTime() const;
 		/// <summary>
-		/// Sample the animation track
+		/// Sample the animation track.
+		/// Sampling doesn't modify the track, so one track can be sampled by many threads at once.
 		/// </summary>
 		/// <param name="time"></param>
 		/// <param name="isTrackLooping"></param>
 		/// <returns></returns>
-		T Sample(float time, bool isTrackLooping);
+		T Sample(float time, bool isTrackLooping) const;
 		/// <summary>
 		/// Overload [] operator to allow indexing into the keyframe list.
 		/// </summary>
 		/// <param name="frameIndex"></param>
 		/// <returns></returns>
 		Frame<FrameDimension>& operator[](unsigned int frameIndex);
+		const Frame<FrameDimension>& operator[](unsigned int frameIndex) const;
 	protected:
 		/* Not sure why the book author wants to do it this way, when we could use dynamic dispatch. At least its easy to understand*/
 		/// <summary>
@@ -58,30 +60,30 @@ namespace anim {
 		/// <param name="time"></param>
 		/// <param name="isTrackLooping"></param>
 		/// <returns></returns>
-		T SampleConstant(float time, bool isTrackLooping);
-		T SampleLinear(float time, bool isTrackLooping);
-		T SampleCubic(float time, bool isTrackLooping);
-		T SampleHermite(float time, const T& point1, const T& slope1, const T& point2, const T& slope2);
+		T SampleConstant(float time, bool isTrackLooping) const;
+		T SampleLinear(float time, bool isTrackLooping) const;
+		T SampleCubic(float time, bool isTrackLooping) const;
+		T SampleHermite(float time, const T& point1, const T& slope1, const T& point2, const T& slope2) const;
 		/// <summary>
 		/// Returns the frame index of the closest frame that comes before the timestamp.
 		/// </summary>
 		/// <param name="time"></param>
 		/// <param name="isTrackLooping"></param>
 		/// <returns></returns>
-		virtual int FrameIndexAt(float time, bool isTrackLooping);
+		virtual int FrameIndexAt(float time, bool isTrackLooping) const;
 		/// <summary>
 		/// Converts timestamps outside the track's valid range into valid time stamps.
 		/// </summary>
 		/// <param name="time"></param>
 		/// <param name="isTrackLooping"></param>
 		/// <returns></returns>
-		float ClipTime(float time, bool isTrackLooping);
+		float ClipTime(float time, bool isTrackLooping) const;
 		/// <summary>
 		/// Converts a frame's data array into the concrete data type the frame represents.
 		/// </summary>
 		/// <param name="frameDataArray"></param>
 		/// <returns></returns>
-		T ToType(float* frameDataArray);
+		T ToType(const float* frameDataArray) const;
 	};
 
 	typedef Track<float, 1> TrackScalar;
@@ -16,7 +16,7 @@ ISRTtrack<QuickTrackVector, QuickTrackQuaternion>::ISRTtrack() : scale(dev_machi
 }
 
 template<typename VECTORTRACKTYPE, typename QUATERNIONTRACKTYPE>
-unsigned int ISRTtrack<VECTORTRACKTYPE, QUATERNIONTRACKTYPE>::GetID() { return this->id; }
+unsigned int ISRTtrack<VECTORTRACKTYPE, QUATERNIONTRACKTYPE>::GetID() const { return this->id; }
 
 template<typename VECTORTRACKTYPE, typename QUATERNIONTRACKTYPE>
 void ISRTtrack<VECTORTRACKTYPE, QUATERNIONTRACKTYPE>::SetID(unsigned int id) { this->id = id; }
@@ -31,7 +31,16 @@ template<typename VECTORTRACKTYPE, typename QUATERNIONTRACKTYPE>
 VECTORTRACKTYPE& ISRTtrack<VECTORTRACKTYPE, QUATERNIONTRACKTYPE>::GetTranslationTrack() { return this->translation; }
 
 template<typename VECTORTRACKTYPE, typename QUATERNIONTRACKTYPE>
-float ISRTtrack<VECTORTRACKTYPE, QUATERNIONTRACKTYPE>::GetStartTime() {
+const VECTORTRACKTYPE& ISRTtrack<VECTORTRACKTYPE, QUATERNIONTRACKTYPE>::GetScaleTrack() const { return this->scale; }
+
+template<typename VECTORTRACKTYPE, typename QUATERNIONTRACKTYPE>
+const QUATERNIONTRACKTYPE& ISRTtrack<VECTORTRACKTYPE, QUATERNIONTRACKTYPE>::GetQuaternionTrack() const { return this->rotation; }
+
+template<typename VECTORTRACKTYPE, typename QUATERNIONTRACKTYPE>
+const VECTORTRACKTYPE& ISRTtrack<VECTORTRACKTYPE, QUATERNIONTRACKTYPE>::GetTranslationTrack() const { return this->translation; }
+
+template<typename VECTORTRACKTYPE, typename QUATERNIONTRACKTYPE>
+float ISRTtrack<VECTORTRACKTYPE, QUATERNIONTRACKTYPE>::GetStartTime() const {
 	static_assert(std::numeric_limits<float>::is_iec559, "No IEEE 754 :(");
 	float scaleStart = std::numeric_limits<float>::infinity();
 	float rotationStart = scaleStart;
@@ -50,7 +59,7 @@ float ISRTtrack<VECTORTRACKTYPE, QUATERNIONTRACKTYPE>::GetStartTime() {
 }
 
 template<typename VECTORTRACKTYPE, typename QUATERNIONTRACKTYPE>
-float ISRTtrack<VECTORTRACKTYPE, QUATERNIONTRACKTYPE>::GetEndTime() {
+float ISRTtrack<VECTORTRACKTYPE, QUATERNIONTRACKTYPE>::GetEndTime() const {
 	static_assert(std::numeric_limits<float>::is_iec559, "No IEEE 754 :(");
 	float scaleEnd = -1.0f * std::numeric_limits<float>::infinity();
 	float rotationEnd = scaleEnd;
@@ -69,7 +78,7 @@ float ISRTtrack<VECTORTRACKTYPE, QUATERNIONTRACKTYPE>::GetEndTime() {
 }
 
 template<typename VECTORTRACKTYPE, typename QUATERNIONTRACKTYPE>
-bool ISRTtrack<VECTORTRACKTYPE, QUATERNIONTRACKTYPE>::hasValidTrack() {
+bool ISRTtrack<VECTORTRACKTYPE, QUATERNIONTRACKTYPE>::hasValidTrack() const {
 	bool result = false; 
 	result |= this->rotation.Size() > 1;
 	result |= this->scale.Size() > 1;
@@ -78,7 +87,7 @@ bool ISRTtrack<VECTORTRACKTYPE, QUATERNIONTRACKTYPE>::hasValidTrack() {
 }
 
 template<typename VECTORTRACKTYPE, typename QUATERNIONTRACKTYPE>
-transforms::srt ISRTtrack<VECTORTRACKTYPE, QUATERNIONTRACKTYPE>::Sample(const transforms::srt& referencePose, float time, bool isTrackLooping)
+transforms::srt ISRTtrack<VECTORTRACKTYPE, QUATERNIONTRACKTYPE>::Sample(const transforms::srt& referencePose, float time, bool isTrackLooping) const
 {
 	transforms::srt result = referencePose; // make a copy of the reference pose
 	if (this->translation.Size() > 1) {
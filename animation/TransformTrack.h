@@ -23,26 +23,29 @@ namespace anim {
 		VECTORTRACKTYPE translation;
 	public:
 		ISRTtrack();
-		unsigned int GetID();
+		unsigned int GetID() const;
 		void SetID(unsigned int id);
 		VECTORTRACKTYPE& GetScaleTrack();
 		QUATERNIONTRACKTYPE& GetQuaternionTrack();
 		VECTORTRACKTYPE& GetTranslationTrack();
+		const VECTORTRACKTYPE& GetScaleTrack() const;
+		const QUATERNIONTRACKTYPE& GetQuaternionTrack() const;
+		const VECTORTRACKTYPE& GetTranslationTrack() const;
 		/// <summary>
 		/// Result is only valid if hasValidTrack returns true
 		/// </summary>
 		/// <returns></returns>
-		float GetStartTime();
+		float GetStartTime() const;
 		/// <summary>
 		/// Result is only valid if hasValidTrack returns true
 		/// </summary>
 		/// <returns></returns>
-		float GetEndTime();
+		float GetEndTime() const;
 		/// <summary>
 		/// Checks if at least track stored within the SRTtrack has more than 1 keyframe
 		/// </summary>
 		/// <returns></returns>
-		bool hasValidTrack();
+		bool hasValidTrack() const;
 		/// <summary>
 		/// Samples the scale, rotation, and translation tracks that are nested within this SRT track.
 		/// </summary>
@@ -50,7 +53,7 @@ namespace anim {
 		/// <param name="time">The time the track is sampled</param>
 		/// <param name="isTrackLooping"></param>
 		/// <returns></returns>
-		transforms::srt Sample(const transforms::srt& referencePose, float time, bool isTrackLooping);
+		transforms::srt Sample(const transforms::srt& referencePose, float time, bool isTrackLooping) const;
 	};
 
 	/// <summary>
@@ -0,0 +1,305 @@
+#include "BVH.h"
+#include <cfloat>
+#include <cmath>
+
+namespace collision {
+
+	namespace {
+		/// <summary>
+		/// Half the surface area of a box, proportional to the chance a random ray passes through it
+		/// </summary>
+		float HalfArea(const render::Bounds& bounds) {
+			f3 size = bounds.max - bounds.min;
+			return size.x * size.y + size.y * size.z + size.z * size.x;
+		}
+
+		/// <summary>
+		/// Distance along the ray to where it enters the box, FLT_MAX if it misses or enters after maxDistance.
+		/// </summary>
+		/// <param name="inverseDirection">1 / the ray's direction, per axis</param>
+		float EnterDistance(const BVHNode& node, const f3& origin, const f3& inverseDirection, float maxDistance) {
+			float enterDistance = 0.0f;
+			float exitDistance = maxDistance;
+			for (unsigned int axis = 0; axis < 3; axis++) {
+				float t0 = (node.min.v[axis] - origin.v[axis]) * inverseDirection.v[axis];
+				float t1 = (node.max.v[axis] - origin.v[axis]) * inverseDirection.v[axis];
+				enterDistance = fmaxf(enterDistance, fminf(t0, t1));
+				exitDistance = fminf(exitDistance, fmaxf(t0, t1));
+			}
+			return enterDistance <= exitDistance ? enterDistance : FLT_MAX;
+		}
+
+		struct Bin {
+			render::Bounds bounds;
+			unsigned int count;
+			Bin() : count(0) {}
+		};
+	}
+
+	BVH::BVH() { }
+
+	void BVH::Build(const std::vector<Triangle>& triangles) {
+		this->nodes.clear();
+		this->triangleIndices.clear();
+		this->v0X.clear();
+		this->v0Y.clear();
+		this->v0Z.clear();
+		this->edge1X.clear();
+		this->edge1Y.clear();
+		this->edge1Z.clear();
+		this->edge2X.clear();
+		this->edge2Y.clear();
+		this->edge2Z.clear();
+		unsigned int numbTriangles = triangles.size();
+		if (numbTriangles == 0) { return; }
+
+		std::vector<render::Bounds> triangleBounds(numbTriangles);
+		std::vector<f3> centroids(numbTriangles);
+		render::Bounds rootBounds;
+		for (unsigned int i = 0; i < numbTriangles; i++) {
+			const Triangle& triangle = triangles[i];
+			triangleBounds[i].Grow(triangle.v0);
+			triangleBounds[i].Grow(triangle.v1);
+			triangleBounds[i].Grow(triangle.v2);
+			centroids[i] = (triangle.v0 + triangle.v1 + triangle.v2) * (1.0f / 3.0f);
+			rootBounds.Grow(triangleBounds[i]);
+		}
+		this->triangleIndices.resize(numbTriangles);
+		for (unsigned int i = 0; i < numbTriangles; i++) { this->triangleIndices[i] = i; }
+
+		// a binary tree with a leaf per triangle has 2n - 1 nodes, the vector never grows during the build
+		this->nodes.reserve(2 * numbTriangles - 1);
+		BVHNode root;
+		root.min = rootBounds.min;
+		root.max = rootBounds.max;
+		root.first = 0;
+		root.count = numbTriangles;
+		this->nodes.push_back(root);
+
+		// nodes that might need splitting, and their depth
+		std::vector<unsigned int> toSplit;
+		std::vector<unsigned int> depths;
+		toSplit.push_back(0);
+		depths.push_back(0);
+		while (!toSplit.empty()) {
+			unsigned int nodeIndex = toSplit.back();
+			unsigned int depth = depths.back();
+			toSplit.pop_back();
+			depths.pop_back();
+			BVHNode& node = this->nodes[nodeIndex];
+			unsigned int first = node.first;
+			unsigned int count = node.count;
+			if (count <= 1 || depth >= MaxDepth) { continue; }
+
+			render::Bounds centroidBounds;
+			for (unsigned int i = first; i < first + count; i++) {
+				centroidBounds.Grow(centroids[this->triangleIndices[i]]);
+			}
+
+			// find the cheapest split between two bins along any axis
+			float bestCost = FLT_MAX;
+			unsigned int bestAxis = 0;
+			unsigned int bestSplit = 0;
+			render::Bounds bestLeftBounds, bestRightBounds;
+			for (unsigned int axis = 0; axis < 3; axis++) {
+				float extent = centroidBounds.max.v[axis] - centroidBounds.min.v[axis];
+				if (extent <= 0.0f) { continue; }
+				float scale = (float) NumbBins / extent;
+				Bin bins[NumbBins];
+				for (unsigned int i = first; i < first + count; i++) {
+					unsigned int triangle = this->triangleIndices[i];
+					unsigned int bin = (unsigned int)((centroids[triangle].v[axis] - centroidBounds.min.v[axis]) * scale);
+					if (bin >= NumbBins) { bin = NumbBins - 1; }
+					bins[bin].bounds.Grow(triangleBounds[triangle]);
+					bins[bin].count++;
+				}
+				// sweep from both ends, leftCosts[s] is the cost of bins 0..s on the left of split s
+				float leftCosts[NumbBins - 1];
+				render::Bounds leftBounds[NumbBins - 1];
+				render::Bounds sweep;
+				unsigned int sweepCount = 0;
+				for (unsigned int split = 0; split < NumbBins - 1; split++) {
+					sweep.Grow(bins[split].bounds);
+					sweepCount += bins[split].count;
+					leftBounds[split] = sweep;
+					leftCosts[split] = sweepCount > 0 ? HalfArea(sweep) * (float) sweepCount : 0.0f;
+				}
+				sweep = render::Bounds();
+				sweepCount = 0;
+				for (unsigned int split = NumbBins - 1; split > 0; split--) {
+					sweep.Grow(bins[split].bounds);
+					sweepCount += bins[split].count;
+					unsigned int leftCount = count - sweepCount;
+					if (sweepCount == 0 || leftCount == 0) { continue; }
+					float cost = leftCosts[split - 1] + HalfArea(sweep) * (float) sweepCount;
+					if (cost < bestCost) {
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = split;
+						bestLeftBounds = leftBounds[split - 1];
+						bestRightBounds = sweep;
+					}
+				}
+			}
+			// every centroid is in the same place, nothing to split on
+			if (bestCost == FLT_MAX) { continue; }
+			// visiting both children and testing their triangles is about as costly as testing the leaf's triangles
+			float leafCost = HalfArea(render::Bounds(node.min, node.max)) * (float) count;
+			if (count <= MaxLeafSize && bestCost >= leafCost) { continue; }
+
+			// partition the node's triangles around the split
+			float scale = (float) NumbBins / (centroidBounds.max.v[bestAxis] - centroidBounds.min.v[bestAxis]);
+			unsigned int left = first;
+			unsigned int right = first + count;
+			while (left < right) {
+				unsigned int triangle = this->triangleIndices[left];
+				unsigned int bin = (unsigned int)((centroids[triangle].v[bestAxis] - centroidBounds.min.v[bestAxis]) * scale);
+				if (bin >= NumbBins) { bin = NumbBins - 1; }
+				if (bin < bestSplit) {
+					left++;
+				} else {
+					right--;
+					this->triangleIndices[left] = this->triangleIndices[right];
+					this->triangleIndices[right] = triangle;
+				}
+			}
+			unsigned int leftCount = left - first;
+
+			BVHNode leftChild;
+			leftChild.min = bestLeftBounds.min;
+			leftChild.max = bestLeftBounds.max;
+			leftChild.first = first;
+			leftChild.count = leftCount;
+			BVHNode rightChild;
+			rightChild.min = bestRightBounds.min;
+			rightChild.max = bestRightBounds.max;
+			rightChild.first = left;
+			rightChild.count = count - leftCount;
+			unsigned int leftIndex = this->nodes.size();
+			// node is a reference into nodes, but the reserve above means pushing doesn't move it
+			node.first = leftIndex;
+			node.count = 0;
+			this->nodes.push_back(leftChild);
+			this->nodes.push_back(rightChild);
+			toSplit.push_back(leftIndex);
+			depths.push_back(depth + 1);
+			toSplit.push_back(leftIndex + 1);
+			depths.push_back(depth + 1);
+		}
+
+		// store the triangles in leaf order, so each leaf reads one run of memory
+		this->v0X.resize(numbTriangles);
+		this->v0Y.resize(numbTriangles);
+		this->v0Z.resize(numbTriangles);
+		this->edge1X.resize(numbTriangles);
+		this->edge1Y.resize(numbTriangles);
+		this->edge1Z.resize(numbTriangles);
+		this->edge2X.resize(numbTriangles);
+		this->edge2Y.resize(numbTriangles);
+		this->edge2Z.resize(numbTriangles);
+		for (unsigned int i = 0; i < numbTriangles; i++) {
+			const Triangle& triangle = triangles[this->triangleIndices[i]];
+			// the same edges Intersect works out from a Triangle, so hits are the same as testing the triangles one by one
+			f3 edge1 = triangle.v1 - triangle.v0;
+			f3 edge2 = triangle.v2 - triangle.v0;
+			this->v0X[i] = triangle.v0.x;
+			this->v0Y[i] = triangle.v0.y;
+			this->v0Z[i] = triangle.v0.z;
+			this->edge1X[i] = edge1.x;
+			this->edge1Y[i] = edge1.y;
+			this->edge1Z[i] = edge1.z;
+			this->edge2X[i] = edge2.x;
+			this->edge2Y[i] = edge2.y;
+			this->edge2Z[i] = edge2.z;
+		}
+	}
+
+	unsigned int BVH::NumbNodes() const { return this->nodes.size(); }
+
+	unsigned int BVH::NumbTriangles() const { return this->triangleIndices.size(); }
+
+	render::Bounds BVH::GetBounds() const {
+		if (this->nodes.empty()) { return render::Bounds(); }
+		return render::Bounds(this->nodes[0].min, this->nodes[0].max);
+	}
+
+	bool BVH::Trace(const Ray& ray, float maxDistance, bool anyHit, RayHit& hitOut) const {
+		if (this->nodes.empty()) { return false; }
+		// axis aligned rays, like the straight down foot rays, divide by zero. A huge inverse gives the same slab distances without NaNs.
+		f3 inverseDirection;
+		for (unsigned int axis = 0; axis < 3; axis++) {
+			float direction = ray.direction.v[axis];
+			inverseDirection.v[axis] = direction != 0.0f ? 1.0f / direction : 1e30f;
+		}
+
+		bool isHit = false;
+		float closest = maxDistance;
+		// every interior node pushes at most one child, so the stack is never deeper than the tree
+		unsigned int stack[MaxDepth + 2];
+		float stackDistances[MaxDepth + 2];
+		unsigned int stackSize = 0;
+		if (EnterDistance(this->nodes[0], ray.origin, inverseDirection, closest) == FLT_MAX) { return false; }
+		stack[stackSize] = 0;
+		stackDistances[stackSize] = 0.0f;
+		stackSize++;
+		while (stackSize > 0) {
+			stackSize--;
+			// a closer hit was found after the node was pushed
+			if (stackDistances[stackSize] > closest) { continue; }
+			const BVHNode* node = &this->nodes[stack[stackSize]];
+			while (node->count == 0) {
+				const BVHNode& leftChild = this->nodes[node->first];
+				const BVHNode& rightChild = this->nodes[node->first + 1];
+				float leftDistance = EnterDistance(leftChild, ray.origin, inverseDirection, closest);
+				float rightDistance = EnterDistance(rightChild, ray.origin, inverseDirection, closest);
+				const BVHNode* nearChild = &leftChild;
+				const BVHNode* farChild = &rightChild;
+				float nearDistance = leftDistance;
+				float farDistance = rightDistance;
+				if (rightDistance < leftDistance) {
+					nearChild = &rightChild;
+					farChild = &leftChild;
+					nearDistance = rightDistance;
+					farDistance = leftDistance;
+				}
+				if (nearDistance == FLT_MAX) { break; }
+				if (farDistance != FLT_MAX) {
+					stack[stackSize] = (unsigned int)(farChild - &this->nodes[0]);
+					stackDistances[stackSize] = farDistance;
+					stackSize++;
+				}
+				node = nearChild;
+			}
+			if (node->count == 0) { continue; }
+			for (unsigned int i = node->first; i < node->first + node->count; i++) {
+				float distance;
+				f3 v0(this->v0X[i], this->v0Y[i], this->v0Z[i]);
+				f3 edge1(this->edge1X[i], this->edge1Y[i], this->edge1Z[i]);
+				f3 edge2(this->edge2X[i], this->edge2Y[i], this->edge2Z[i]);
+				if (!Intersect(ray, v0, edge1, edge2, distance)) { continue; }
+				// triangles at the same distance, e.g. a shared edge, go to the lower index whatever order the nodes were visited in
+				if (distance < closest || (isHit && distance == closest && this->triangleIndices[i] < hitOut.triangle)) {
+					closest = distance;
+					hitOut.triangle = this->triangleIndices[i];
+					isHit = true;
+					if (anyHit) { break; }
+				}
+			}
+			if (isHit && anyHit) { break; }
+		}
+		if (isHit) {
+			hitOut.distance = closest;
+			hitOut.point = ray.origin + ray.direction * closest;
+		}
+		return isHit;
+	}
+
+	bool BVH::Raycast(const Ray& ray, float maxDistance, RayHit& hitOut) const {
+		return this->Trace(ray, maxDistance, false, hitOut);
+	}
+
+	bool BVH::AnyHit(const Ray& ray, float maxDistance) const {
+		RayHit hit;
+		return this->Trace(ray, maxDistance, true, hit);
+	}
+}
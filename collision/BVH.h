@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+#include "Triangle.h"
+#include "../render/Bounds.h"
+
+namespace collision {
+
+	/// <summary>
+	/// A node of a BVH, 32 bytes so two fit in a cache line.
+	/// </summary>
+	struct BVHNode {
+		f3 min;
+		/// <summary>
+		/// Leaf: the first of its triangles in the BVH's triangle order. Interior: the left child, the right child is next to it.
+		/// </summary>
+		unsigned int first;
+		f3 max;
+		/// <summary>
+		/// The leaf's number of triangles, 0 for interior nodes
+		/// </summary>
+		unsigned int count;
+	};
+
+	/// <summary>
+	/// Bounding volume hierarchy over a triangle soup, e.g. the floor of a level, for ray casts that visit O(log n) triangles instead of all of them.
+	/// Built top down, each node is split where the surface area heuristic says rays are least likely to visit both halves,
+	/// estimated from the triangles' centroids sorted into bins along each axis.
+	/// The triangles are copied into the hierarchy, hits report the triangle's index in the list it was built from.
+	/// </summary>
+	class BVH {
+		friend class RayBatch;
+	public:
+		/// <summary>
+		/// The centroid bins tried along each axis per split
+		/// </summary>
+		static constexpr unsigned int NumbBins = 16;
+		/// <summary>
+		/// Nodes with more triangles than this are always split, smaller ones are only split when the heuristic says it's worth it
+		/// </summary>
+		static constexpr unsigned int MaxLeafSize = 4;
+		/// <summary>
+		/// Nodes this deep become leaves whatever their size, bounds the traversal stack
+		/// </summary>
+		static constexpr unsigned int MaxDepth = 60;
+	protected:
+		/// <summary>
+		/// nodes[0] is the root
+		/// </summary>
+		std::vector<BVHNode> nodes;
+		/// <summary>
+		/// The index each triangle had in the list the BVH was built from, in leaf order
+		/// </summary>
+		std::vector<unsigned int> triangleIndices;
+		/// <summary>
+		/// The triangles in leaf order, each leaf's triangles are next to each other. Stored as the first vertex and the edges from it
+		/// to the other two, one array per component, so single rays and RayBatch's packets read the same copy.
+		/// </summary>
+		std::vector<float> v0X, v0Y, v0Z;
+		std::vector<float> edge1X, edge1Y, edge1Z;
+		std::vector<float> edge2X, edge2Y, edge2Z;
+	protected:
+		/// <summary>
+		/// Walk the nodes the ray passes through, nearest child first, skipping nodes further away than the closest hit so far.
+		/// </summary>
+		/// <param name="anyHit">Stop at the first hit instead of the closest</param>
+		bool Trace(const Ray& ray, float maxDistance, bool anyHit, RayHit& hitOut) const;
+	public:
+		/// <summary>
+		/// Create an empty BVH, every ray misses it
+		/// </summary>
+		BVH();
+		/// <summary>
+		/// Replace the hierarchy with one over these triangles
+		/// </summary>
+		void Build(const std::vector<Triangle>& triangles);
+		unsigned int NumbNodes() const;
+		unsigned int NumbTriangles() const;
+		render::Bounds GetBounds() const;
+		/// <summary>
+		/// Find the closest triangle the ray hits.
+		/// </summary>
+		/// <param name="maxDistance">Hits further along the ray than this are ignored</param>
+		/// <param name="hitOut">The closest hit, only valid if the function returns true. When several triangles are hit at the same distance, the one with the lowest index wins, so RayBatch reports the same triangle.</param>
+		/// <returns>True if the ray hit a triangle closer than maxDistance</returns>
+		bool Raycast(const Ray& ray, float maxDistance, RayHit& hitOut) const;
+		/// <summary>
+		/// Check if the ray hits any triangle, stops at the first one found. Cheaper than Raycast for line of sight checks.
+		/// </summary>
+		/// <param name="maxDistance">Hits further along the ray than this are ignored</param>
+		/// <returns>True if the ray hit a triangle closer than maxDistance</returns>
+		bool AnyHit(const Ray& ray, float maxDistance) const;
+	};
+}
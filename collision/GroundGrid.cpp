@@ -0,0 +1,265 @@
+#include "GroundGrid.h"
+#include <cmath>
+
+namespace collision {
+
+	// the same epsilon as Intersect, for the barycentric coordinates (points on an edge are on both triangles), the triangle's
+	// projected area (Intersect's determinant for a ray straight down) and how far below the ray's start a hit has to be
+	constexpr float intersectEpsilon = 0.000001f;
+
+	// cells with more triangles than this aren't checked for overlaps, they are assumed to have several layers
+	constexpr unsigned int maxLayerCheck = 32;
+
+	namespace {
+		/// <summary>
+		/// Project a triangle seen from above onto an axis in the xz plane
+		/// </summary>
+		void Project(const Triangle& triangle, float axisX, float axisZ, float& minOut, float& maxOut) {
+			float a = triangle.v0.x * axisX + triangle.v0.z * axisZ;
+			float b = triangle.v1.x * axisX + triangle.v1.z * axisZ;
+			float c = triangle.v2.x * axisX + triangle.v2.z * axisZ;
+			minOut = fminf(a, fminf(b, c));
+			maxOut = fmaxf(a, fmaxf(b, c));
+		}
+
+		/// <summary>
+		/// True if a's edges separate a and b seen from above. Triangles that only share an edge or a corner are separate.
+		/// </summary>
+		bool IsSeparatedByEdges(const Triangle& a, const Triangle& b) {
+			const f3* vertices[3] = { &a.v0, &a.v1, &a.v2 };
+			for (unsigned int edge = 0; edge < 3; edge++) {
+				const f3& from = *vertices[edge];
+				const f3& to = *vertices[(edge + 1) % 3];
+				// perpendicular to the edge in the xz plane
+				float axisX = to.z - from.z;
+				float axisZ = from.x - to.x;
+				float minA, maxA, minB, maxB;
+				Project(a, axisX, axisZ, minA, maxA);
+				Project(b, axisX, axisZ, minB, maxB);
+				if (maxA <= minB || maxB <= minA) { return true; }
+			}
+			return false;
+		}
+
+		/// <summary>
+		/// True if a ray straight down from maxHeight hits ground at this height, Intersect rejects hits closer than its epsilon
+		/// </summary>
+		bool IsBelow(float height, float maxHeight) {
+			return maxHeight - height >= intersectEpsilon;
+		}
+
+		/// <summary>
+		/// True if the triangles cover some of the same area seen from above
+		/// </summary>
+		bool Overlaps(const Triangle& a, const Triangle& b) {
+			return !IsSeparatedByEdges(a, b) && !IsSeparatedByEdges(b, a);
+		}
+	}
+
+	GroundGrid::GroundGrid() {
+		this->minX = 0.0f;
+		this->minZ = 0.0f;
+		this->cellSize = 1.0f;
+		this->inverseCellSize = 1.0f;
+		this->numbCellsX = 0;
+		this->numbCellsZ = 0;
+	}
+
+	void GroundGrid::Build(const std::vector<Triangle>& triangles, float cellSize, float minNormalY) {
+		this->triangles.clear();
+		this->cellStarts.clear();
+		this->cellTriangles.clear();
+		this->singleLayer.clear();
+		this->numbCellsX = 0;
+		this->numbCellsZ = 0;
+
+		// keep the triangles a vertical ray can land on
+		std::vector<unsigned int> walkable;
+		float maxX = 0.0f, maxZ = 0.0f;
+		float totalSize = 0.0f;
+		unsigned int numbTriangles = triangles.size();
+		for (unsigned int i = 0; i < numbTriangles; i++) {
+			const Triangle& triangle = triangles[i];
+			if (fabsf(triangle.normal.y) < minNormalY) { continue; }
+			GroundTriangle ground;
+			ground.v0 = triangle.v0;
+			ground.edge1 = triangle.v1 - triangle.v0;
+			ground.edge2 = triangle.v2 - triangle.v0;
+			float area = ground.edge1.x * ground.edge2.z - ground.edge1.z * ground.edge2.x;
+			// vertical or nearly, seen from above it's a line. Intersect rejects the same triangles as parallel to the ray.
+			if (fabsf(area) < intersectEpsilon) { continue; }
+			ground.inverseArea = 1.0f / area;
+			ground.normal = triangle.normal.y < 0.0f ? triangle.normal * -1.0f : triangle.normal;
+			ground.source = i;
+			this->triangles.push_back(ground);
+			walkable.push_back(i);
+
+			float triangleMinX = fminf(triangle.v0.x, fminf(triangle.v1.x, triangle.v2.x));
+			float triangleMaxX = fmaxf(triangle.v0.x, fmaxf(triangle.v1.x, triangle.v2.x));
+			float triangleMinZ = fminf(triangle.v0.z, fminf(triangle.v1.z, triangle.v2.z));
+			float triangleMaxZ = fmaxf(triangle.v0.z, fmaxf(triangle.v1.z, triangle.v2.z));
+			totalSize += fmaxf(triangleMaxX - triangleMinX, triangleMaxZ - triangleMinZ);
+			if (walkable.size() == 1) {
+				this->minX = triangleMinX;
+				this->minZ = triangleMinZ;
+				maxX = triangleMaxX;
+				maxZ = triangleMaxZ;
+			} else {
+				this->minX = fminf(this->minX, triangleMinX);
+				this->minZ = fminf(this->minZ, triangleMinZ);
+				maxX = fmaxf(maxX, triangleMaxX);
+				maxZ = fmaxf(maxZ, triangleMaxZ);
+			}
+		}
+		unsigned int numbWalkable = walkable.size();
+		if (numbWalkable == 0) { return; }
+
+		if (cellSize <= 0.0f) { cellSize = totalSize / (float) numbWalkable; }
+		if (cellSize <= 0.0f) { cellSize = 1.0f; }
+		// keep the grid's memory in proportion to the floor
+		double maxCells = 4.0 * (double) numbWalkable + 16.0;
+		for (;;) {
+			double cellsX = floor((maxX - this->minX) / cellSize) + 1.0;
+			double cellsZ = floor((maxZ - this->minZ) / cellSize) + 1.0;
+			if (cellsX * cellsZ <= maxCells) {
+				this->numbCellsX = (unsigned int) cellsX;
+				this->numbCellsZ = (unsigned int) cellsZ;
+				break;
+			}
+			cellSize *= (float) sqrt(cellsX * cellsZ / maxCells) * 1.01f;
+		}
+		this->cellSize = cellSize;
+		this->inverseCellSize = 1.0f / cellSize;
+
+		// count each cell's triangles, then fill the lists. A triangle goes in every cell its box overlaps.
+		unsigned int numbCells = this->numbCellsX * this->numbCellsZ;
+		std::vector<unsigned int> cellRanges(numbWalkable * 4);
+		this->cellStarts.assign(numbCells + 1, 0);
+		for (unsigned int t = 0; t < numbWalkable; t++) {
+			const Triangle& triangle = triangles[walkable[t]];
+			float triangleMinX = fminf(triangle.v0.x, fminf(triangle.v1.x, triangle.v2.x));
+			float triangleMaxX = fmaxf(triangle.v0.x, fmaxf(triangle.v1.x, triangle.v2.x));
+			float triangleMinZ = fminf(triangle.v0.z, fminf(triangle.v1.z, triangle.v2.z));
+			float triangleMaxZ = fmaxf(triangle.v0.z, fmaxf(triangle.v1.z, triangle.v2.z));
+			unsigned int* range = &cellRanges[t * 4];
+			range[0] = (unsigned int)((triangleMinX - this->minX) * this->inverseCellSize);
+			range[1] = (unsigned int)((triangleMaxX - this->minX) * this->inverseCellSize);
+			range[2] = (unsigned int)((triangleMinZ - this->minZ) * this->inverseCellSize);
+			range[3] = (unsigned int)((triangleMaxZ - this->minZ) * this->inverseCellSize);
+			if (range[1] >= this->numbCellsX) { range[1] = this->numbCellsX - 1; }
+			if (range[3] >= this->numbCellsZ) { range[3] = this->numbCellsZ - 1; }
+			for (unsigned int z = range[2]; z <= range[3]; z++) {
+				for (unsigned int x = range[0]; x <= range[1]; x++) {
+					this->cellStarts[z * this->numbCellsX + x + 1]++;
+				}
+			}
+		}
+		for (unsigned int cell = 0; cell < numbCells; cell++) {
+			this->cellStarts[cell + 1] += this->cellStarts[cell];
+		}
+		this->cellTriangles.resize(this->cellStarts[numbCells]);
+		std::vector<unsigned int> cellFill(this->cellStarts.begin(), this->cellStarts.end() - 1);
+		for (unsigned int t = 0; t < numbWalkable; t++) {
+			const unsigned int* range = &cellRanges[t * 4];
+			for (unsigned int z = range[2]; z <= range[3]; z++) {
+				for (unsigned int x = range[0]; x <= range[1]; x++) {
+					this->cellTriangles[cellFill[z * this->numbCellsX + x]++] = t;
+				}
+			}
+		}
+
+		// find the cells where the cache can be trusted
+		this->singleLayer.assign(numbCells, 1);
+		for (unsigned int cell = 0; cell < numbCells; cell++) {
+			unsigned int begin = this->cellStarts[cell];
+			unsigned int end = this->cellStarts[cell + 1];
+			if (end - begin > maxLayerCheck) {
+				this->singleLayer[cell] = 0;
+				continue;
+			}
+			for (unsigned int a = begin; a < end && this->singleLayer[cell]; a++) {
+				for (unsigned int b = a + 1; b < end; b++) {
+					if (Overlaps(triangles[walkable[this->cellTriangles[a]]], triangles[walkable[this->cellTriangles[b]]])) {
+						this->singleLayer[cell] = 0;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	unsigned int GroundGrid::NumbTriangles() const { return this->triangles.size(); }
+
+	unsigned int GroundGrid::NumbCellsX() const { return this->numbCellsX; }
+
+	unsigned int GroundGrid::NumbCellsZ() const { return this->numbCellsZ; }
+
+	float GroundGrid::GetCellSize() const { return this->cellSize; }
+
+	bool GroundGrid::HeightAt(const GroundTriangle& triangle, float x, float z, float& heightOut) const {
+		float px = x - triangle.v0.x;
+		float pz = z - triangle.v0.z;
+		// barycentric coordinates of the point in the triangle seen from above
+		float u = (px * triangle.edge2.z - pz * triangle.edge2.x) * triangle.inverseArea;
+		if (u < -intersectEpsilon || u - 1.0f > intersectEpsilon) { return false; }
+		float v = (triangle.edge1.x * pz - triangle.edge1.z * px) * triangle.inverseArea;
+		if (v < -intersectEpsilon || u + v - 1.0f > intersectEpsilon) { return false; }
+		heightOut = triangle.v0.y + u * triangle.edge1.y + v * triangle.edge2.y;
+		return true;
+	}
+
+	bool GroundGrid::CellAt(float x, float z, unsigned int& cellOut) const {
+		float cellX = (x - this->minX) * this->inverseCellSize;
+		float cellZ = (z - this->minZ) * this->inverseCellSize;
+		if (cellX < 0.0f || cellZ < 0.0f || cellX >= (float) this->numbCellsX || cellZ >= (float) this->numbCellsZ) { return false; }
+		cellOut = (unsigned int) cellZ * this->numbCellsX + (unsigned int) cellX;
+		return true;
+	}
+
+	bool GroundGrid::Find(float x, float z, float maxHeight, unsigned int& triangleOut, float& heightOut) const {
+		unsigned int cell;
+		if (!this->CellAt(x, z, cell)) { return false; }
+		bool isFound = false;
+		for (unsigned int i = this->cellStarts[cell]; i < this->cellStarts[cell + 1]; i++) {
+			unsigned int triangle = this->cellTriangles[i];
+			float height;
+			if (this->HeightAt(this->triangles[triangle], x, z, height) && IsBelow(height, maxHeight) && (!isFound || height > heightOut)) {
+				triangleOut = triangle;
+				heightOut = height;
+				isFound = true;
+			}
+		}
+		return isFound;
+	}
+
+	void GroundGrid::Fill(unsigned int triangle, float height, GroundSample& sampleOut) const {
+		sampleOut.height = height;
+		sampleOut.normal = this->triangles[triangle].normal;
+		sampleOut.triangle = this->triangles[triangle].source;
+	}
+
+	bool GroundGrid::Sample(float x, float z, float maxHeight, GroundSample& sampleOut) const {
+		unsigned int triangle;
+		float height;
+		if (!this->Find(x, z, maxHeight, triangle, height)) { return false; }
+		this->Fill(triangle, height, sampleOut);
+		return true;
+	}
+
+	bool GroundGrid::Sample(float x, float z, float maxHeight, GroundSample& sampleOut, GroundCache& cache) const {
+		float height;
+		unsigned int cell;
+		if (cache.triangle < this->triangles.size() &&
+			this->HeightAt(this->triangles[cache.triangle], x, z, height) && IsBelow(height, maxHeight) &&
+			this->CellAt(x, z, cell) && this->singleLayer[cell]) {
+			// the point is still on the cached triangle, and no other triangle in the cell is under it
+			this->Fill(cache.triangle, height, sampleOut);
+			return true;
+		}
+		unsigned int triangle;
+		if (!this->Find(x, z, maxHeight, triangle, height)) { return false; }
+		cache.triangle = triangle;
+		this->Fill(triangle, height, sampleOut);
+		return true;
+	}
+}
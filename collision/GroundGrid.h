@@ -0,0 +1,123 @@
+#pragma once
+
+#include <vector>
+#include "Triangle.h"
+
+namespace collision {
+
+	/// <summary>
+	/// The ground under a point
+	/// </summary>
+	struct GroundSample {
+		float height;
+		/// <summary>
+		/// The ground triangle's normal, facing up
+		/// </summary>
+		f3 normal;
+		/// <summary>
+		/// Index of the ground triangle, in the triangles the grid was built from
+		/// </summary>
+		unsigned int triangle;
+	};
+
+	/// <summary>
+	/// Remembers the ground triangle a foot was last on, so the next query can try it before the rest of the cell.
+	/// One per foot, or per anything else that moves across the ground.
+	/// </summary>
+	struct GroundCache {
+		/// <summary>
+		/// Index into the grid's triangles, NoTriangle before the first hit
+		/// </summary>
+		unsigned int triangle;
+		static constexpr unsigned int NoTriangle = 0xFFFFFFFF;
+		GroundCache() : triangle(NoTriangle) {}
+	};
+
+	/// <summary>
+	/// Answers "how high is the ground at (x, z)" for walkable floors that are mostly 2.5D, without casting rays.
+	/// The floor triangles are baked into a uniform grid over the xz plane, each cell lists the triangles that overlap it, so a query
+	/// reads one cell's short list instead of walking a hierarchy.
+	/// Floors with several layers (bridges, overhangs) work too: the query returns the highest ground below a height,
+	/// which is where a ray cast straight down from that height would land.
+	/// </summary>
+	class GroundGrid {
+	protected:
+		/// <summary>
+		/// A walkable triangle as the query reads it: its first vertex, the two edges from it, and the inverse of the
+		/// xz cross product of the edges for barycentric coordinates.
+		/// </summary>
+		struct GroundTriangle {
+			f3 v0;
+			f3 edge1;
+			f3 edge2;
+			float inverseArea;
+			f3 normal;
+			/// <summary>
+			/// Index in the triangles the grid was built from
+			/// </summary>
+			unsigned int source;
+		};
+		std::vector<GroundTriangle> triangles;
+		/// <summary>
+		/// The triangles overlapping cell (x, z) are cellTriangles[cellStarts[c]] to cellTriangles[cellStarts[c + 1]], c = z * numbCellsX + x
+		/// </summary>
+		std::vector<unsigned int> cellStarts;
+		std::vector<unsigned int> cellTriangles;
+		/// <summary>
+		/// 1 if no two of the cell's triangles overlap when seen from above, so a triangle under a point is the only one there.
+		/// The cache is only trusted in these cells.
+		/// </summary>
+		std::vector<unsigned char> singleLayer;
+		float minX;
+		float minZ;
+		float cellSize;
+		float inverseCellSize;
+		unsigned int numbCellsX;
+		unsigned int numbCellsZ;
+	protected:
+		/// <summary>
+		/// The height of a triangle above a point, if the point is inside it seen from above
+		/// </summary>
+		bool HeightAt(const GroundTriangle& triangle, float x, float z, float& heightOut) const;
+		/// <summary>
+		/// The cell a point is in, false if the point is outside the grid
+		/// </summary>
+		bool CellAt(float x, float z, unsigned int& cellOut) const;
+		/// <summary>
+		/// Read the point's cell for the highest triangle below maxHeight
+		/// </summary>
+		/// <param name="triangleOut">Index into triangles</param>
+		bool Find(float x, float z, float maxHeight, unsigned int& triangleOut, float& heightOut) const;
+		void Fill(unsigned int triangle, float height, GroundSample& sampleOut) const;
+	public:
+		/// <summary>
+		/// Create an empty grid, every query misses it
+		/// </summary>
+		GroundGrid();
+		/// <summary>
+		/// Replace the grid with one over the walkable triangles of a floor, e.g. WalkingDemo::TrianglesFromMeshes.
+		/// </summary>
+		/// <param name="triangles"></param>
+		/// <param name="cellSize">The width of a cell in x and z. 0 or less picks the triangles' average size.
+		/// Made bigger if the grid would have more than four cells per triangle.</param>
+		/// <param name="minNormalY">Triangles steeper than this are not walkable and left out, e.g. cos(45 degrees). 0 keeps every triangle that isn't vertical.</param>
+		void Build(const std::vector<Triangle>& triangles, float cellSize, float minNormalY);
+		unsigned int NumbTriangles() const;
+		unsigned int NumbCellsX() const;
+		unsigned int NumbCellsZ() const;
+		float GetCellSize() const;
+		/// <summary>
+		/// Find the highest ground at (x, z) below maxHeight, with the same edge, parallel and minimum distance tolerances as Intersect
+		/// so the answer is the one a ray cast straight down gets.
+		/// </summary>
+		/// <param name="maxHeight">Where a ray straight down would start, ground above it or level with it is ignored</param>
+		/// <param name="sampleOut">Only valid if the function returns true</param>
+		/// <returns>True if there is ground under the point</returns>
+		bool Sample(float x, float z, float maxHeight, GroundSample& sampleOut) const;
+		/// <summary>
+		/// Sample, trying the cache's triangle first. If the point is still on it, and its cell has one layer of ground,
+		/// the rest of the cell isn't read. The cache is updated with the triangle found.
+		/// </summary>
+		bool Sample(float x, float z, float maxHeight, GroundSample& sampleOut, GroundCache& cache) const;
+	};
+}
@@ -0,0 +1,414 @@
+#include "RayBatch.h"
+#include <algorithm>
+#include "../SIMD.h"
+
+namespace collision {
+
+	// the same epsilon as Intersect
+	constexpr float intersectEpsilon = 0.000001f;
+
+	// BVH::Trace's inverse direction for axis aligned rays
+	constexpr float hugeInverse = 1e30f;
+
+	namespace {
+		/// <summary>
+		/// Put two zero bits between each of the low 10 bits, so three of them can be interleaved into a Morton code
+		/// </summary>
+		unsigned int SpreadBits(unsigned int x) {
+			x &= 0x3FF;
+			x = (x | (x << 16)) & 0x030000FF;
+			x = (x | (x << 8)) & 0x0300F00F;
+			x = (x | (x << 4)) & 0x030C30C3;
+			x = (x | (x << 2)) & 0x09249249;
+			return x;
+		}
+
+		/// <summary>
+		/// Where a coordinate is in a box's extent, 0 to 1023
+		/// </summary>
+		unsigned int Quantize(float value, float min, float max) {
+			if (max <= min) { return 0; }
+			float scaled = (value - min) / (max - min) * 1023.0f;
+			if (scaled <= 0.0f) { return 0; }
+			if (scaled >= 1023.0f) { return 1023; }
+			return (unsigned int) scaled;
+		}
+
+		/// <summary>
+		/// Which of an interior node's children to visit first. Decided by the packet's first ray, packets are sorted so its rays
+		/// mostly travel the same way.
+		/// </summary>
+		bool IsLeftNearer(const BVHNode& left, const BVHNode& right, const f3& origin, const f3& direction) {
+			f3 leftCenter = (left.min + left.max) * 0.5f;
+			f3 rightCenter = (right.min + right.max) * 0.5f;
+			return dot(leftCenter - origin, direction) <= dot(rightCenter - origin, direction);
+		}
+	}
+
+	RayBatch::RayBatch() {
+		this->numbRays = 0;
+		this->stride = 0;
+	}
+
+	void RayBatch::Resize(unsigned int numbRays) {
+		this->numbRays = numbRays;
+		this->stride = (numbRays + SIMDWidestLanes - 1) / SIMDWidestLanes * SIMDWidestLanes;
+		// padding rays have a negative max distance, they leave every box before they enter it
+		this->originX.assign(this->stride, 0.0f);
+		this->originY.assign(this->stride, 0.0f);
+		this->originZ.assign(this->stride, 0.0f);
+		this->directionX.assign(this->stride, 0.0f);
+		this->directionY.assign(this->stride, -1.0f);
+		this->directionZ.assign(this->stride, 0.0f);
+		this->maxDistances.assign(this->stride, -1.0f);
+		this->distances.assign(this->stride, 0.0f);
+		this->triangles.assign(this->stride, 0);
+		this->hits.assign(this->stride, 0);
+		this->order.resize(this->stride);
+		this->sortKeys.resize(numbRays);
+	}
+
+	unsigned int RayBatch::NumbRays() const { return this->numbRays; }
+
+	void RayBatch::SetRay(unsigned int index, const Ray& ray, float maxDistance) {
+		this->originX[index] = ray.origin.x;
+		this->originY[index] = ray.origin.y;
+		this->originZ[index] = ray.origin.z;
+		this->directionX[index] = ray.direction.x;
+		this->directionY[index] = ray.direction.y;
+		this->directionZ[index] = ray.direction.z;
+		this->maxDistances[index] = maxDistance;
+	}
+
+	Ray RayBatch::GetRay(unsigned int index) const {
+		return Ray(
+			f3(this->originX[index], this->originY[index], this->originZ[index]),
+			f3(this->directionX[index], this->directionY[index], this->directionZ[index])
+		);
+	}
+
+	bool RayBatch::IsHit(unsigned int index) const { return this->hits[index] != 0; }
+
+	RayHit RayBatch::GetHit(unsigned int index) const {
+		RayHit hit;
+		Ray ray = this->GetRay(index);
+		hit.distance = this->distances[index];
+		hit.point = ray.origin + ray.direction * hit.distance;
+		hit.triangle = this->triangles[index];
+		return hit;
+	}
+
+	void RayBatch::SortRays(const BVH& bvh) {
+		render::Bounds bounds = bvh.GetBounds();
+		for (unsigned int ray = 0; ray < this->numbRays; ray++) {
+			unsigned int x = Quantize(this->originX[ray], bounds.min.x, bounds.max.x);
+			unsigned int y = Quantize(this->originY[ray], bounds.min.y, bounds.max.y);
+			unsigned int z = Quantize(this->originZ[ray], bounds.min.z, bounds.max.z);
+			unsigned long long morton = (SpreadBits(x) << 2) | (SpreadBits(y) << 1) | SpreadBits(z);
+			this->sortKeys[ray] = (morton << 32) | ray;
+		}
+		std::sort(this->sortKeys.begin(), this->sortKeys.end());
+		for (unsigned int i = 0; i < this->numbRays; i++) {
+			this->order[i] = (unsigned int)(this->sortKeys[i] & 0xFFFFFFFF);
+		}
+		for (unsigned int i = this->numbRays; i < this->stride; i++) {
+			this->order[i] = i;
+		}
+	}
+
+	unsigned int RayBatch::Raycast(const BVH& bvh) {
+		if (bvh.nodes.empty()) {
+			for (unsigned int ray = 0; ray < this->numbRays; ray++) {
+				this->distances[ray] = this->maxDistances[ray];
+				this->hits[ray] = 0;
+			}
+			return 0;
+		}
+		this->SortRays(bvh);
+		SIMDLevel level = GetSIMDLevel();
+		if (level == SIMDLevel::AVX2) {
+			this->RaycastAVX2(bvh, 0, this->stride);
+		} else if (level == SIMDLevel::SSE) {
+			this->RaycastSSE(bvh, 0, this->stride);
+		} else {
+			this->RaycastScalar(bvh, 0, this->numbRays);
+		}
+		unsigned int numbHits = 0;
+		for (unsigned int ray = 0; ray < this->numbRays; ray++) {
+			numbHits += this->hits[ray];
+		}
+		return numbHits;
+	}
+
+	void RayBatch::RaycastScalar(const BVH& bvh, unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; i++) {
+			unsigned int ray = this->order[i];
+			if (ray >= this->numbRays) { continue; }
+			RayHit hit;
+			bool isHit = bvh.Raycast(this->GetRay(ray), this->maxDistances[ray], hit);
+			this->distances[ray] = isHit ? hit.distance : this->maxDistances[ray];
+			this->triangles[ray] = isHit ? hit.triangle : 0;
+			this->hits[ray] = isHit ? 1 : 0;
+		}
+	}
+
+	// Each kernel is BVH::Trace for a packet of rays: a node is visited while any ray of the packet enters its box before that ray's
+	// closest hit so far. The leaf test is Intersect with the math in the same order, so the packets find the same hits as single rays.
+	// Nodes are visited in a different order, so hits at the same distance are settled by triangle index like BVH::Trace does.
+
+	void RayBatch::RaycastSSE(const BVH& bvh, unsigned int begin, unsigned int end) {
+#if defined(SIMD_X86)
+		const BVHNode* nodes = bvh.nodes.data();
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 huge = _mm_set1_ps(hugeInverse);
+		const __m128 eps = _mm_set1_ps(intersectEpsilon);
+		const __m128 negEps = _mm_set1_ps(-intersectEpsilon);
+		const __m128 noTriangle = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (unsigned int packet = begin; packet < end; packet += 4) {
+			float lanes[7][4];
+			for (unsigned int lane = 0; lane < 4; lane++) {
+				unsigned int ray = this->order[packet + lane];
+				lanes[0][lane] = this->originX[ray];
+				lanes[1][lane] = this->originY[ray];
+				lanes[2][lane] = this->originZ[ray];
+				lanes[3][lane] = this->directionX[ray];
+				lanes[4][lane] = this->directionY[ray];
+				lanes[5][lane] = this->directionZ[ray];
+				lanes[6][lane] = this->maxDistances[ray];
+			}
+			const __m128 ox = _mm_loadu_ps(lanes[0]);
+			const __m128 oy = _mm_loadu_ps(lanes[1]);
+			const __m128 oz = _mm_loadu_ps(lanes[2]);
+			const __m128 dx = _mm_loadu_ps(lanes[3]);
+			const __m128 dy = _mm_loadu_ps(lanes[4]);
+			const __m128 dz = _mm_loadu_ps(lanes[5]);
+			__m128 isZero = _mm_cmpeq_ps(dx, zero);
+			const __m128 idx = _mm_or_ps(_mm_and_ps(isZero, huge), _mm_andnot_ps(isZero, _mm_div_ps(one, dx)));
+			isZero = _mm_cmpeq_ps(dy, zero);
+			const __m128 idy = _mm_or_ps(_mm_and_ps(isZero, huge), _mm_andnot_ps(isZero, _mm_div_ps(one, dy)));
+			isZero = _mm_cmpeq_ps(dz, zero);
+			const __m128 idz = _mm_or_ps(_mm_and_ps(isZero, huge), _mm_andnot_ps(isZero, _mm_div_ps(one, dz)));
+			__m128 closest = _mm_loadu_ps(lanes[6]);
+			__m128 closestTriangle = noTriangle;
+			const f3 firstOrigin(lanes[0][0], lanes[1][0], lanes[2][0]);
+			const f3 firstDirection(lanes[3][0], lanes[4][0], lanes[5][0]);
+
+			unsigned int stack[BVH::MaxDepth + 2];
+			unsigned int stackSize = 0;
+			stack[stackSize++] = 0;
+			while (stackSize > 0) {
+				const BVHNode& node = nodes[stack[--stackSize]];
+				// slab test
+				__m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.min.x), ox), idx);
+				__m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.max.x), ox), idx);
+				__m128 enterDistance = _mm_max_ps(zero, _mm_min_ps(t0, t1));
+				__m128 exitDistance = _mm_min_ps(closest, _mm_max_ps(t0, t1));
+				t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.min.y), oy), idy);
+				t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.max.y), oy), idy);
+				enterDistance = _mm_max_ps(enterDistance, _mm_min_ps(t0, t1));
+				exitDistance = _mm_min_ps(exitDistance, _mm_max_ps(t0, t1));
+				t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.min.z), oz), idz);
+				t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.max.z), oz), idz);
+				enterDistance = _mm_max_ps(enterDistance, _mm_min_ps(t0, t1));
+				exitDistance = _mm_min_ps(exitDistance, _mm_max_ps(t0, t1));
+				const __m128 inside = _mm_cmple_ps(enterDistance, exitDistance);
+				if (_mm_movemask_ps(inside) == 0) { continue; }
+
+				if (node.count == 0) {
+					// the nearer child goes on top of the stack
+					if (IsLeftNearer(nodes[node.first], nodes[node.first + 1], firstOrigin, firstDirection)) {
+						stack[stackSize++] = node.first + 1;
+						stack[stackSize++] = node.first;
+					} else {
+						stack[stackSize++] = node.first;
+						stack[stackSize++] = node.first + 1;
+					}
+					continue;
+				}
+
+				for (unsigned int i = node.first; i < node.first + node.count; i++) {
+					const __m128 e1x = _mm_set1_ps(bvh.edge1X[i]);
+					const __m128 e1y = _mm_set1_ps(bvh.edge1Y[i]);
+					const __m128 e1z = _mm_set1_ps(bvh.edge1Z[i]);
+					const __m128 e2x = _mm_set1_ps(bvh.edge2X[i]);
+					const __m128 e2y = _mm_set1_ps(bvh.edge2Y[i]);
+					const __m128 e2z = _mm_set1_ps(bvh.edge2Z[i]);
+					// p = cross(direction, edge2)
+					__m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+					__m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+					__m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+					__m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+					// parallel rays are rejected, the NaNs their lanes make below are masked off
+					__m128 accept = _mm_and_ps(inside, _mm_or_ps(_mm_cmpge_ps(determinant, eps), _mm_cmple_ps(determinant, negEps)));
+					if (_mm_movemask_ps(accept) == 0) { continue; }
+					__m128 f = _mm_div_ps(one, determinant);
+					__m128 sx = _mm_sub_ps(ox, _mm_set1_ps(bvh.v0X[i]));
+					__m128 sy = _mm_sub_ps(oy, _mm_set1_ps(bvh.v0Y[i]));
+					__m128 sz = _mm_sub_ps(oz, _mm_set1_ps(bvh.v0Z[i]));
+					__m128 u = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)));
+					accept = _mm_and_ps(accept, _mm_cmpnlt_ps(u, negEps));
+					accept = _mm_and_ps(accept, _mm_cmpngt_ps(_mm_sub_ps(u, one), eps));
+					// q = cross(s, edge1)
+					__m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+					__m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+					__m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+					__m128 v = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)));
+					accept = _mm_and_ps(accept, _mm_cmpnlt_ps(v, negEps));
+					accept = _mm_and_ps(accept, _mm_cmpngt_ps(_mm_sub_ps(_mm_add_ps(u, v), one), eps));
+					__m128 distance = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)));
+					accept = _mm_and_ps(accept, _mm_cmpnlt_ps(distance, eps));
+					// closer, or as close and a lower triangle index, the same tie break as BVH::Trace
+					const __m128i triangle = _mm_set1_epi32((int) bvh.triangleIndices[i]);
+					__m128 isTie = _mm_and_ps(_mm_cmpeq_ps(distance, closest), _mm_castsi128_ps(_mm_cmplt_epi32(triangle, _mm_castps_si128(closestTriangle))));
+					accept = _mm_and_ps(accept, _mm_or_ps(_mm_cmplt_ps(distance, closest), isTie));
+					closest = _mm_or_ps(_mm_and_ps(accept, distance), _mm_andnot_ps(accept, closest));
+					closestTriangle = _mm_or_ps(_mm_and_ps(accept, _mm_castsi128_ps(triangle)), _mm_andnot_ps(accept, closestTriangle));
+				}
+			}
+
+			float laneDistances[4];
+			int laneTriangles[4];
+			_mm_storeu_ps(laneDistances, closest);
+			_mm_storeu_si128((__m128i*) laneTriangles, _mm_castps_si128(closestTriangle));
+			for (unsigned int lane = 0; lane < 4; lane++) {
+				unsigned int ray = this->order[packet + lane];
+				if (ray >= this->numbRays) { continue; }
+				bool isHit = laneTriangles[lane] >= 0;
+				this->distances[ray] = laneDistances[lane];
+				this->triangles[ray] = isHit ? (unsigned int) laneTriangles[lane] : 0;
+				this->hits[ray] = isHit ? 1 : 0;
+			}
+		}
+#else
+		this->RaycastScalar(bvh, begin, end);
+#endif
+	}
+
+	SIMD_TARGET_AVX2
+	void RayBatch::RaycastAVX2(const BVH& bvh, unsigned int begin, unsigned int end) {
+#if defined(SIMD_X86)
+		const BVHNode* nodes = bvh.nodes.data();
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 huge = _mm256_set1_ps(hugeInverse);
+		const __m256 eps = _mm256_set1_ps(intersectEpsilon);
+		const __m256 negEps = _mm256_set1_ps(-intersectEpsilon);
+		const __m256 noTriangle = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (unsigned int packet = begin; packet < end; packet += 8) {
+			float lanes[7][8];
+			for (unsigned int lane = 0; lane < 8; lane++) {
+				unsigned int ray = this->order[packet + lane];
+				lanes[0][lane] = this->originX[ray];
+				lanes[1][lane] = this->originY[ray];
+				lanes[2][lane] = this->originZ[ray];
+				lanes[3][lane] = this->directionX[ray];
+				lanes[4][lane] = this->directionY[ray];
+				lanes[5][lane] = this->directionZ[ray];
+				lanes[6][lane] = this->maxDistances[ray];
+			}
+			const __m256 ox = _mm256_loadu_ps(lanes[0]);
+			const __m256 oy = _mm256_loadu_ps(lanes[1]);
+			const __m256 oz = _mm256_loadu_ps(lanes[2]);
+			const __m256 dx = _mm256_loadu_ps(lanes[3]);
+			const __m256 dy = _mm256_loadu_ps(lanes[4]);
+			const __m256 dz = _mm256_loadu_ps(lanes[5]);
+			const __m256 idx = _mm256_blendv_ps(_mm256_div_ps(one, dx), huge, _mm256_cmp_ps(dx, zero, _CMP_EQ_OQ));
+			const __m256 idy = _mm256_blendv_ps(_mm256_div_ps(one, dy), huge, _mm256_cmp_ps(dy, zero, _CMP_EQ_OQ));
+			const __m256 idz = _mm256_blendv_ps(_mm256_div_ps(one, dz), huge, _mm256_cmp_ps(dz, zero, _CMP_EQ_OQ));
+			__m256 closest = _mm256_loadu_ps(lanes[6]);
+			__m256 closestTriangle = noTriangle;
+			const f3 firstOrigin(lanes[0][0], lanes[1][0], lanes[2][0]);
+			const f3 firstDirection(lanes[3][0], lanes[4][0], lanes[5][0]);
+
+			unsigned int stack[BVH::MaxDepth + 2];
+			unsigned int stackSize = 0;
+			stack[stackSize++] = 0;
+			while (stackSize > 0) {
+				const BVHNode& node = nodes[stack[--stackSize]];
+				// slab test
+				__m256 t0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(node.min.x), ox), idx);
+				__m256 t1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(node.max.x), ox), idx);
+				__m256 enterDistance = _mm256_max_ps(zero, _mm256_min_ps(t0, t1));
+				__m256 exitDistance = _mm256_min_ps(closest, _mm256_max_ps(t0, t1));
+				t0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(node.min.y), oy), idy);
+				t1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(node.max.y), oy), idy);
+				enterDistance = _mm256_max_ps(enterDistance, _mm256_min_ps(t0, t1));
+				exitDistance = _mm256_min_ps(exitDistance, _mm256_max_ps(t0, t1));
+				t0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(node.min.z), oz), idz);
+				t1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(node.max.z), oz), idz);
+				enterDistance = _mm256_max_ps(enterDistance, _mm256_min_ps(t0, t1));
+				exitDistance = _mm256_min_ps(exitDistance, _mm256_max_ps(t0, t1));
+				const __m256 inside = _mm256_cmp_ps(enterDistance, exitDistance, _CMP_LE_OQ);
+				if (_mm256_movemask_ps(inside) == 0) { continue; }
+
+				if (node.count == 0) {
+					// the nearer child goes on top of the stack
+					if (IsLeftNearer(nodes[node.first], nodes[node.first + 1], firstOrigin, firstDirection)) {
+						stack[stackSize++] = node.first + 1;
+						stack[stackSize++] = node.first;
+					} else {
+						stack[stackSize++] = node.first;
+						stack[stackSize++] = node.first + 1;
+					}
+					continue;
+				}
+
+				for (unsigned int i = node.first; i < node.first + node.count; i++) {
+					const __m256 e1x = _mm256_set1_ps(bvh.edge1X[i]);
+					const __m256 e1y = _mm256_set1_ps(bvh.edge1Y[i]);
+					const __m256 e1z = _mm256_set1_ps(bvh.edge1Z[i]);
+					const __m256 e2x = _mm256_set1_ps(bvh.edge2X[i]);
+					const __m256 e2y = _mm256_set1_ps(bvh.edge2Y[i]);
+					const __m256 e2z = _mm256_set1_ps(bvh.edge2Z[i]);
+					// p = cross(direction, edge2)
+					__m256 px = _mm256_sub_ps(_mm256_mul_ps(dy, e2z), _mm256_mul_ps(dz, e2y));
+					__m256 py = _mm256_sub_ps(_mm256_mul_ps(dz, e2x), _mm256_mul_ps(dx, e2z));
+					__m256 pz = _mm256_sub_ps(_mm256_mul_ps(dx, e2y), _mm256_mul_ps(dy, e2x));
+					__m256 determinant = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e1x, px), _mm256_mul_ps(e1y, py)), _mm256_mul_ps(e1z, pz));
+					// parallel rays are rejected, the NaNs their lanes make below are masked off
+					__m256 accept = _mm256_and_ps(inside, _mm256_or_ps(_mm256_cmp_ps(determinant, eps, _CMP_GE_OQ), _mm256_cmp_ps(determinant, negEps, _CMP_LE_OQ)));
+					if (_mm256_movemask_ps(accept) == 0) { continue; }
+					__m256 f = _mm256_div_ps(one, determinant);
+					__m256 sx = _mm256_sub_ps(ox, _mm256_set1_ps(bvh.v0X[i]));
+					__m256 sy = _mm256_sub_ps(oy, _mm256_set1_ps(bvh.v0Y[i]));
+					__m256 sz = _mm256_sub_ps(oz, _mm256_set1_ps(bvh.v0Z[i]));
+					__m256 u = _mm256_mul_ps(f, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, px), _mm256_mul_ps(sy, py)), _mm256_mul_ps(sz, pz)));
+					accept = _mm256_and_ps(accept, _mm256_cmp_ps(u, negEps, _CMP_NLT_UQ));
+					accept = _mm256_and_ps(accept, _mm256_cmp_ps(_mm256_sub_ps(u, one), eps, _CMP_NGT_UQ));
+					// q = cross(s, edge1)
+					__m256 qx = _mm256_sub_ps(_mm256_mul_ps(sy, e1z), _mm256_mul_ps(sz, e1y));
+					__m256 qy = _mm256_sub_ps(_mm256_mul_ps(sz, e1x), _mm256_mul_ps(sx, e1z));
+					__m256 qz = _mm256_sub_ps(_mm256_mul_ps(sx, e1y), _mm256_mul_ps(sy, e1x));
+					__m256 v = _mm256_mul_ps(f, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, qx), _mm256_mul_ps(dy, qy)), _mm256_mul_ps(dz, qz)));
+					accept = _mm256_and_ps(accept, _mm256_cmp_ps(v, negEps, _CMP_NLT_UQ));
+					accept = _mm256_and_ps(accept, _mm256_cmp_ps(_mm256_sub_ps(_mm256_add_ps(u, v), one), eps, _CMP_NGT_UQ));
+					__m256 distance = _mm256_mul_ps(f, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx), _mm256_mul_ps(e2y, qy)), _mm256_mul_ps(e2z, qz)));
+					accept = _mm256_and_ps(accept, _mm256_cmp_ps(distance, eps, _CMP_NLT_UQ));
+					// closer, or as close and a lower triangle index, the same tie break as BVH::Trace
+					const __m256i triangle = _mm256_set1_epi32((int) bvh.triangleIndices[i]);
+					__m256 isTie = _mm256_and_ps(_mm256_cmp_ps(distance, closest, _CMP_EQ_OQ), _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_castps_si256(closestTriangle), triangle)));
+					accept = _mm256_and_ps(accept, _mm256_or_ps(_mm256_cmp_ps(distance, closest, _CMP_LT_OQ), isTie));
+					closest = _mm256_blendv_ps(closest, distance, accept);
+					closestTriangle = _mm256_blendv_ps(closestTriangle, _mm256_castsi256_ps(triangle), accept);
+				}
+			}
+
+			float laneDistances[8];
+			int laneTriangles[8];
+			_mm256_storeu_ps(laneDistances, closest);
+			_mm256_storeu_si256((__m256i*) laneTriangles, _mm256_castps_si256(closestTriangle));
+			for (unsigned int lane = 0; lane < 8; lane++) {
+				unsigned int ray = this->order[packet + lane];
+				if (ray >= this->numbRays) { continue; }
+				bool isHit = laneTriangles[lane] >= 0;
+				this->distances[ray] = laneDistances[lane];
+				this->triangles[ray] = isHit ? (unsigned int) laneTriangles[lane] : 0;
+				this->hits[ray] = isHit ? 1 : 0;
+			}
+		}
+#else
+		this->RaycastScalar(bvh, begin, end);
+#endif
+	}
+}
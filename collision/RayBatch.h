@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vector>
+#include "Triangle.h"
+#include "BVH.h"
+
+namespace collision {
+
+	/// <summary>
+	/// Casts many rays against a BVH at once, e.g. the foot placement rays of every character in a crowd.
+	/// The rays are stored structure of arrays, sorted so rays that start close together are in the same packet, and each packet of
+	/// 4 (SSE) or 8 (AVX2) rays walks the hierarchy together: a node is visited if any ray in the packet passes through it,
+	/// and each of its triangles is tested against every ray with one instruction per step of the test.
+	/// Finds the same closest hits as BVH::Raycast casting each ray on its own, both settle hits at the same distance by the lowest triangle index.
+	/// </summary>
+	class RayBatch {
+	protected:
+		/// <summary>
+		/// Rays are padded to a multiple of the widest SIMD packet, padding rays never hit anything.
+		/// </summary>
+		unsigned int numbRays;
+		unsigned int stride;
+		/// <summary>
+		/// [ray]
+		/// </summary>
+		std::vector<float> originX;
+		std::vector<float> originY;
+		std::vector<float> originZ;
+		std::vector<float> directionX;
+		std::vector<float> directionY;
+		std::vector<float> directionZ;
+		std::vector<float> maxDistances;
+		/// <summary>
+		/// The closest hit of each ray in the last Raycast, [ray]. distances is maxDistances for rays that missed.
+		/// </summary>
+		std::vector<float> distances;
+		std::vector<unsigned int> triangles;
+		std::vector<unsigned char> hits;
+		/// <summary>
+		/// The rays in packet order, padding rays last
+		/// </summary>
+		std::vector<unsigned int> order;
+		/// <summary>
+		/// Each ray's position along a Morton curve through the BVH's box in the high bits, its index in the low bits
+		/// </summary>
+		std::vector<unsigned long long> sortKeys;
+	protected:
+		/// <summary>
+		/// Group rays that start close together into the same packets, so packets visit fewer nodes.
+		/// </summary>
+		void SortRays(const BVH& bvh);
+		/// <summary>
+		/// Cast the rays in order[begin, end) one at a time with BVH::Raycast, the reference the SIMD kernels are checked against.
+		/// </summary>
+		void RaycastScalar(const BVH& bvh, unsigned int begin, unsigned int end);
+		/// <summary>
+		/// Cast the rays in order[begin, end) 4 at a time, begin and end are multiples of 4.
+		/// </summary>
+		void RaycastSSE(const BVH& bvh, unsigned int begin, unsigned int end);
+		/// <summary>
+		/// Cast the rays in order[begin, end) 8 at a time, begin and end are multiples of 8.
+		/// </summary>
+		void RaycastAVX2(const BVH& bvh, unsigned int begin, unsigned int end);
+	public:
+		/// <summary>
+		/// Create an empty batch
+		/// </summary>
+		RayBatch();
+		/// <summary>
+		/// Change how many rays the batch holds. Existing rays are not kept.
+		/// </summary>
+		void Resize(unsigned int numbRays);
+		unsigned int NumbRays() const;
+		/// <summary>
+		/// </summary>
+		/// <param name="index"></param>
+		/// <param name="ray"></param>
+		/// <param name="maxDistance">Hits further along the ray than this are ignored</param>
+		void SetRay(unsigned int index, const Ray& ray, float maxDistance);
+		Ray GetRay(unsigned int index) const;
+		/// <summary>
+		/// Find the closest triangle each ray hits, with the widest SIMD kernel the CPU supports.
+		/// </summary>
+		/// <returns>The number of rays that hit a triangle</returns>
+		unsigned int Raycast(const BVH& bvh);
+		/// <summary>
+		/// True if the ray hit a triangle in the last Raycast
+		/// </summary>
+		bool IsHit(unsigned int index) const;
+		/// <summary>
+		/// The ray's closest hit in the last Raycast, only valid if IsHit
+		/// </summary>
+		RayHit GetHit(unsigned int index) const;
+	};
+}
@@ -0,0 +1,42 @@
+#include "Triangle.h"
+#include <cmath>
+
+namespace collision {
+
+	bool Intersect(const Ray& ray, const Triangle& triangle, float& distanceOut) {
+		return Intersect(ray, triangle.v0, triangle.v1 - triangle.v0, triangle.v2 - triangle.v0, distanceOut);
+	}
+
+	bool Intersect(const Ray& ray, const f3& v0, const f3& edge1, const f3& edge2, float& distanceOut) {
+		constexpr float epsilon = 0.000001f; // = std::numeric_limits<float>::epsilon();
+		// Moller-Trumbore ray-triangle intersection algorithm
+
+		f3 dirCrossE2 = cross(ray.direction, edge2);
+		float determinant = dot(edge1, dirCrossE2);
+
+		// ray is parrallel to the triangle?
+		if (determinant < epsilon && determinant > -epsilon) { return false; }
+
+		float f = 1.0f / determinant;
+		f3 s = ray.origin - v0;
+
+		float u = f * dot(s, dirCrossE2);
+
+		// u is smaller than zero OR u is greater than 1
+		// also check for values that are within epsilon of 0 and 1
+		if ((u < 0 && std::abs(u) > epsilon) || (u > 1 && std::abs(u - 1.0f) > epsilon)) { return false; }
+
+		f3 sCrossEdge1 = cross(s, edge1);
+		float v = f * dot(ray.direction, sCrossEdge1);
+
+		if ((v < 0 && std::abs(v) > epsilon) || (u + v > 1 && std::abs(u + v - 1) > epsilon)) { return false; }
+
+		float distance = f * dot(edge2, sCrossEdge1);
+
+		// is the intersection behind the ray origin?
+		if (distance < epsilon) { return false; }
+
+		distanceOut = distance;
+		return true;
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "../Vector3.h"
+
+namespace collision {
+
+	// data structures and algorithms for ray casting intersections with triangles
+	struct Ray {
+		f3 origin;
+		f3 direction;
+
+		/// <summary>
+		/// Create a ray that points straight down, at the world origin
+		/// </summary>
+		Ray() : direction(f3(0,-1,0)), origin(f3(0,0,0)) {}
+
+		/// <summary>
+		/// Create a ray at a location that points straight down
+		/// </summary>
+		/// <param name="_origin"></param>
+		Ray(const f3& _origin) : direction(f3(0, -1, 0)), origin(_origin) {}
+
+		Ray(const f3& _origin, const f3& _direction) : direction(_direction), origin(_origin) {}
+	};
+
+	struct Triangle {
+		/// <summary>
+		/// The three vertices of the triangle
+		/// </summary>
+		f3 v0, v1, v2;
+		f3 normal;
+
+		Triangle() {}
+		Triangle(const f3& _v0, const f3& _v1, const f3& _v2) : v0(_v0), v1(_v1), v2(_v2) {
+			// same algorithm as used in PushingP
+			normal = normalized(cross(v0 - v1, v2 - v0));
+		}
+	};
+
+	/// <summary>
+	/// Where a ray hit a triangle
+	/// </summary>
+	struct RayHit {
+		f3 point;
+		/// <summary>
+		/// From the ray origin to the hit, in units of the ray's direction
+		/// </summary>
+		float distance;
+		/// <summary>
+		/// Index of the triangle that was hit, in the triangles the query was built from
+		/// </summary>
+		unsigned int triangle;
+	};
+
+	/// <summary>
+	/// Perform a ray cast intersection test against a triangle, Moller-Trumbore.
+	/// This function returns false if the intersection point is behind the ray origin
+	/// </summary>
+	/// <param name="ray"></param>
+	/// <param name="triangle"></param>
+	/// <param name="distanceOut">The distance along the ray to the intersection point. Only valid if function returns true</param>
+	/// <returns>True if the ray hit the triangle</returns>
+	bool Intersect(const Ray& ray, const Triangle& triangle, float& distanceOut);
+
+	/// <summary>
+	/// Intersect for a triangle stored as its first vertex and the edges from it to the other two, e.g. by a BVH
+	/// </summary>
+	/// <param name="ray"></param>
+	/// <param name="v0"></param>
+	/// <param name="edge1">v1 - v0</param>
+	/// <param name="edge2">v2 - v0</param>
+	/// <param name="distanceOut">The distance along the ray to the intersection point. Only valid if function returns true</param>
+	/// <returns>True if the ray hit the triangle</returns>
+	bool Intersect(const Ray& ray, const f3& v0, const f3& edge1, const f3& edge2, float& distanceOut);
+}
@@ -1,5 +1,6 @@
 #include "AnimatedModel.h"
 #include <iostream>
+#include <cassert>
 #include "../io/gltfLoader.h"
 #include "../render/Uniform.h"
 
@@ -16,11 +17,8 @@ namespace demos {
 		this->clips = io::LoadClips(data);
 		io::FreeGLTFData(data);
 
+		// copying a mesh uploads the copy's data, the skinning will be done on the GPU so it needs no other sync
 		this->gpuMeshes = this->cpuMeshes;
-		// upload gpu mesh data to the GPU because the skinning will be done on the GPU
-		for (unsigned int i = 0, numbMeshes = (unsigned int)this->gpuMeshes.size(); i < numbMeshes; i++) {
-			this->gpuMeshes[i].SyncOpenGL();
-		}
 		std::cout << "Looking for \'\\resource\\shaders\\frag_lit.glsl\' in working directory.\n";
 		std::cout << "Looking for \'\\resource\\shaders\\static_vert.glsl\' in working directory.\n";
 		this->cpuShader = new render::Shader(
@@ -54,6 +52,20 @@ namespace demos {
 		this->gpuAnimation.transform.position = f3(-2,0,0);
 		this->gpuAnimation.currentClip = clipToPlay;
 
+#ifdef _DEBUG
+		// check the SIMD skinning kernels against the reference skinning once, on this model half way through its clip
+		if (numbClips > 0) {
+			anim::Pose verifyPose = this->skeleton.GetRestPose();
+			const anim::Clip& clip = this->clips[clipToPlay];
+			clip.Sample(verifyPose, clip.GetStartTime() + clip.GetDuration() * 0.5f);
+			std::vector<mat4f> verifyPalette;
+			bool isPalette = verifyPose.ToSkinningPalette(verifyPalette, this->skeleton.GetInverseBindPose());
+			for (unsigned int i = 0, numbMeshes = isPalette ? (unsigned int)this->cpuMeshes.size() : 0; i < numbMeshes; i++) {
+				unsigned int numbFailedKernels = this->cpuMeshes[i].GetData().VerifySkinningKernels(verifyPalette);
+				assert(numbFailedKernels == 0);
+			}
+		}
+#endif
 	}
 
 	void AnimatedModel::ShutDown() {
@@ -80,21 +92,14 @@ namespace demos {
 		// =====================
 
 		// perform CPU skinning
-		for (unsigned int i = 0, numbMeshes = (unsigned int)this->cpuMeshes.size(); i < numbMeshes; i++) {
-			cpuSide.currentPose.ToMatrixPalette(cpuSide.bonesAsMatrices); // overwrite bonesAsMatrix vector with current animated pose
-			std::vector<mat4f>& inverseBindPose = this->skeleton.GetInverseBindPose();
-			for (int k = 0; k < cpuSide.bonesAsMatrices.size(); k++) {
-				cpuSide.bonesAsMatrices[k] = cpuSide.bonesAsMatrices[k] * inverseBindPose[k]; // write the skinning transform into the bone buffer instead
-			}
+		// the skinning transforms are shared by every mesh, an armature that doesn't match the pose leaves them empty and nothing is skinned
+		bool isPalette = cpuSide.currentPose.ToSkinningPalette(cpuSide.bonesAsMatrices, this->skeleton.GetInverseBindPose());
+		for (unsigned int i = 0, numbMeshes = isPalette ? (unsigned int)this->cpuMeshes.size() : 0; i < numbMeshes; i++) {
 			this->cpuMeshes[i].Skin(cpuSide.bonesAsMatrices);
 			/* this->cpuMeshes[i].Skin(this->skeleton, this->cpuAnimation.currentPose); // mutates the cpu meshes internal data structures | the old skinning method */
 		}
 		// prepare the skinning transforms for rendering/GPU skinning
-		this->gpuAnimation.currentPose.ToMatrixPalette(this->gpuAnimation.bonesAsMatrices);
-		std::vector<mat4f>& inverseBindPose = this->skeleton.GetInverseBindPose();
-		for (int k = 0; k < gpuSide.bonesAsMatrices.size(); k++) {
-			gpuSide.bonesAsMatrices[k] = gpuSide.bonesAsMatrices[k] * inverseBindPose[k];
-		}
+		gpuSide.currentPose.ToSkinningPalette(gpuSide.bonesAsMatrices, this->skeleton.GetInverseBindPose());
 		elapsedTime += deltaTime;
 		if (elapsedTime > 5.0f) {
 			elapsedTime = 0.0f;
@@ -140,9 +145,13 @@ namespace demos {
 		render::Uniform<mat4f>::Set(this->gpuShader->GetUniform("view_transform", wasUniformFound), view);
 		render::Uniform<mat4f>::Set(this->gpuShader->GetUniform("projection", wasUniformFound), projection);
 		render::Uniform<f3>::Set(this->gpuShader->GetUniform("sky_light_direction", wasUniformFound), f3(1, 1, 1));
-		render::Uniform<mat4f>::Set(this->gpuShader->GetUniform("animatedBones", wasUniformFound), this->gpuAnimation.bonesAsMatrices);
+		// empty if the armature doesn't match the pose, see ToSkinningPalette
+		bool isPalette = this->gpuAnimation.bonesAsMatrices.size() > 0;
+		if (isPalette) {
+			render::Uniform<mat4f>::Set(this->gpuShader->GetUniform("animatedBones", wasUniformFound), this->gpuAnimation.bonesAsMatrices);
+		}
 
-		for (unsigned int i = 0, numbMeshes = (unsigned int)this->gpuMeshes.size(); i < numbMeshes; i++) {
+		for (unsigned int i = 0, numbMeshes = isPalette ? (unsigned int)this->gpuMeshes.size() : 0; i < numbMeshes; i++) {
 			// upload per vertex data to GPU
 			int position = this->gpuShader->GetAttribute("position", wasUniformFound);
 			int normal = this->gpuShader->GetAttribute("normal", wasUniformFound);
@@ -29,25 +29,30 @@ namespace demos {
 		std::cout << "Looking for \'\\resource\\assets\\Woman.png\' in working directory.\n";
 		this->texture = new render::Texture("./resource/assets/Woman.png");
 
-		this->left.pose = this->pose;
-		this->right.pose = this->pose;
-
 		this->blendTime = 0.0f;
 		this->blendInvert = false;
 
+		unsigned int left = 0, right = 0;
 		for (unsigned int i = 0; i < (unsigned int)this->clips.size(); i++) {
 			if (this->clips[i].GetClipName() == "Walking") {
-				this->left.clip = i;
-				this->left.time = this->clips[i].GetStartTime();
+				left = i;
 			}
 			else if (this->clips[i].GetClipName() == "Running") {
-				this->right.clip = i;
-				this->right.time = this->clips[i].GetStartTime();
+				right = i;
 			}
 		}
+
+		this->graph.SetArmature(this->armature);
+		this->blendParameter = this->graph.AddParameter("blend", 0.0f);
+		unsigned int walk = this->graph.AddClip(&this->clips[left], -1);
+		unsigned int run = this->graph.AddClip(&this->clips[right], -1);
+		unsigned int blend = this->graph.AddBlend(walk, run, (int) this->blendParameter, -1);
+		this->graph.Compile(blend);
+		this->graphInstance.SetGraph(&this->graph);
 	}
 
 	void AnimationBlending::ShutDown() {
+		this->graphInstance.SetGraph(NULL);
 		this->clips.clear();
 		this->meshes.clear();
 		delete this->shader;
@@ -55,14 +60,13 @@ namespace demos {
 	}
 
 	void AnimationBlending::Update(float deltaTime) {
-		this->left.time = this->clips[this->left.clip].Sample(this->left.pose, this->left.time + deltaTime);
-		this->right.time = this->clips[this->right.clip].Sample(this->right.pose, this->right.time + deltaTime);
-
 		float time = this->blendTime;
 		time = time > 1.0f ? 1.0f : (time < 0.0f ? 0.0f : time);
 		time = blendInvert ? 1.0f - time : time;
 
-		anim::Blend(this->pose, this->left.pose, this->right.pose, time, -1);
+		this->graphInstance.SetParameter(this->blendParameter, time);
+		this->graphInstance.Update(deltaTime);
+		this->pose = this->graphInstance.GetPose();
 
 		this->pose.ToMatrixPalette(this->bonesAsMatrices);
 
@@ -71,7 +75,6 @@ namespace demos {
 		if (blendTime >= 5.0f) {
 			blendTime = 0.0f;
 			this->blendInvert = !this->blendInvert;
-			this->pose = this->armature.GetRestPose();
 		}
 	}
 
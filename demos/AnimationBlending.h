@@ -4,16 +4,12 @@
 #include "../animation/Armature.h"
 #include "../animation/Pose.h"
 #include "../animation/Clip.h"
+#include "../animation/AnimGraph.h"
 #include "../render/Mesh.h"
 #include "../render/Shader.h"
 #include "../render/Texture.h"
 
 namespace demos {
-	struct AnimInstance {
-		unsigned int clip;
-		float time;
-		anim::Pose pose;
-	};
 	/// <summary>
 	/// Demo that blends between walking and running animation 
 	/// </summary>
@@ -27,8 +23,12 @@ namespace demos {
 		anim::Pose pose;
 		std::vector<mat4f> bonesAsMatrices;
 		std::vector<mat4f> skinningMatrices;
-		AnimInstance left;
-		AnimInstance right;
+		/// <summary>
+		/// Walking and running clips blended by the 'blend' parameter
+		/// </summary>
+		anim::AnimGraph graph;
+		anim::AnimGraphInstance graphInstance;
+		unsigned int blendParameter;
 		float blendTime;
 		bool blendInvert;
 	public:
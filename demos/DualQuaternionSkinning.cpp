@@ -1,5 +1,6 @@
 #include "DualQuaternionSkinning.h"
 #include <iostream>
+#include <cassert>
 #include "../io/gltfLoader.h"
 #include "../render/Shader.h"
 #include "../render/Uniform.h"
@@ -45,6 +46,21 @@ namespace demos {
 
 		this->clipIndex = 0;
 		this->playbackTime = 0.0f;
+
+#ifdef _DEBUG
+		// check the dual quaternion skinning kernels against the reference skinning once, on this model half way through its first clip
+		if (this->clips.size() > 0) {
+			anim::Pose verifyPose = this->armature.GetRestPose();
+			const anim::Clip& clip = this->clips[0];
+			clip.Sample(verifyPose, clip.GetStartTime() + clip.GetDuration() * 0.5f);
+			std::vector<transforms::DualQuaternion> posedBones, verifyPalette;
+			verifyPose.ToDualQuaternionSkinningPalette(posedBones, verifyPalette, this->armature.GetInverseBindPoseDualQuaternion());
+			for (unsigned int i = 0, numbMeshes = (unsigned int)this->meshes.size(); i < numbMeshes; i++) {
+				unsigned int numbFailedKernels = this->meshes[i].GetData().VerifySkinningKernels(verifyPalette);
+				assert(numbFailedKernels == 0);
+			}
+		}
+#endif
 	}
 
 	void DualQuaternionSkinning::ShutDown() {
@@ -135,6 +135,20 @@ namespace demos {
 		}
 	}
 
+	void InverseKinematicsDemo::LineDrawer::FromIKSolver(ik::TwoBoneSolver& solver) {
+		unsigned int size = solver.ChainSize();
+		if (size < 2) { return; }
+		unsigned int numbVerts = 2 * (size - 1);
+		this->points.resize(numbVerts);
+		unsigned int idx = 0;
+		for (unsigned int i = 0; i < size - 1; i++) {
+			this->points[idx] = solver.GetBoneAt(i).position;
+			idx++;
+			this->points[idx] = solver.GetBoneAt(i + 1).position;
+			idx++;
+		}
+	}
+
 	InverseKinematicsDemo::LineDrawer::LineDrawer(unsigned int size) : SimpleAnimationPlayer::SkeletonDrawer(size) {}
 
 	InverseKinematicsDemo::LineDrawer::LineDrawer() : SimpleAnimationPlayer::SkeletonDrawer() {}
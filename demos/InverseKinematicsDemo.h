@@ -4,6 +4,7 @@
 #include "../transforms/srt.h"
 #include "../ik/CCDSolver.h"
 #include "../ik/FABRIKSolver.h"
+#include "../ik/TwoBoneSolver.h"
 #include "SimpleAnimationPlayer.h"
 #include "../animation/TransformTrack.h"
 
@@ -39,6 +40,7 @@ namespace demos {
 		public:
 			void FromIKSolver(ik::CCDSolver& solver);
 			void FromIKSolver(ik::FABRIKSolver& solver);
+			void FromIKSolver(ik::TwoBoneSolver& solver);
 			LineDrawer(unsigned int size);
 			LineDrawer();
 		};
@@ -3,6 +3,9 @@
 #include "../cgltf.h"
 #include "../io/gltfLoader.h"
 #include <iostream>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
 #include "../render/Uniform.h"
 #include "../animation/Blending.h"
 
@@ -51,42 +54,51 @@ namespace demos {
 		return answer;
 	}
 
-	bool WalkingDemo::Intersect(const Ray& ray, const Triangle& triangle, f3& intersectPointOut) {
-		constexpr float epsilon = 0.000001f; // = std::numeric_limits<float>::epsilon();
-		// Moller-Trumbore ray-triangle intersection algorithm
-		f3 edge1 = triangle.v1 - triangle.v0;
-		f3 edge2 = triangle.v2 - triangle.v0;
-
-		f3 dirCrossE2 = cross(ray.direction, edge2);
-		float determinant = dot(edge1, dirCrossE2);
-
-		// ray is parrallel to the triangle?
-		if (determinant < epsilon && determinant > -epsilon) { return false; }
-
-		float f = 1.0f / determinant;
-		f3 s = ray.origin - triangle.v0;
-
-		float u = f * dot(s, dirCrossE2);
-
-		// u is smaller than zero OR u is greater than 1
-		// also check for values that are within epsilon of 0 and 1 
-		if ((u < 0 && std::abs(u) > epsilon) || (u > 1 && std::abs(u - 1.0f) > epsilon)) { return false; }
-
-		f3 sCrossEdge1 = cross(s, edge1);
-		float v = f * dot(ray.direction, sCrossEdge1);
-
-		if ((v < 0 && std::abs(u) > epsilon) || (u + v > 1 && std::abs(u + v - 1) > epsilon)) { return false; }
-
-		float distance = f * dot(edge2, sCrossEdge1);
-
-		// is the intersection behind the ray origin?
-		if (distance < epsilon) { return false; }
-
-		intersectPointOut = ray.origin + ray.direction * distance;
-
+	bool WalkingDemo::CastDown(const Ray& ray, collision::GroundCache& cache, collision::RayHit& hitOut) {
+		// the grid answers straight down rays, for them the hit distance is the drop in height
+		assert(ray.direction == f3(0, -1, 0));
+		collision::GroundSample ground;
+		if (!this->floorGrid.Sample(ray.origin.x, ray.origin.z, ray.origin.y, ground, cache)) { return false; }
+		hitOut.point = f3(ray.origin.x, ground.height, ray.origin.z);
+		hitOut.distance = ray.origin.y - ground.height;
+		hitOut.triangle = ground.triangle;
 		return true;
 	}
 
+	unsigned int WalkingDemo::VerifyFloorGrid(const std::vector<Triangle>& triangles) const {
+		constexpr unsigned int raysPerSide = 64;
+		collision::BVH bvh;
+		bvh.Build(triangles);
+		render::Bounds bounds = bvh.GetBounds();
+		float top = bounds.max.y + 1.0f;
+		f3 step = (bounds.max - bounds.min) * (1.0f / (float) raysPerSide);
+		collision::RayBatch rays;
+		rays.Resize(raysPerSide * raysPerSide);
+		for (unsigned int i = 0; i < raysPerSide; i++) {
+			for (unsigned int j = 0; j < raysPerSide; j++) {
+				// the middle of each lattice cell, so rays don't start exactly on the edges of the floor
+				f3 origin(bounds.min.x + step.x * ((float) i + 0.5f), top, bounds.min.z + step.z * ((float) j + 0.5f));
+				rays.SetRay(i * raysPerSide + j, Ray(origin), FLT_MAX);
+			}
+		}
+		rays.Raycast(bvh);
+
+		unsigned int numbMismatches = 0;
+		for (unsigned int ray = 0; ray < rays.NumbRays(); ray++) {
+			f3 origin = rays.GetRay(ray).origin;
+			collision::GroundSample ground;
+			bool isGround = this->floorGrid.Sample(origin.x, origin.z, top, ground);
+			bool isHit = rays.IsHit(ray);
+			if (isGround == isHit && (!isHit || fabsf(ground.height - rays.GetHit(ray).point.y) <= 0.0001f)) { continue; }
+			if (numbMismatches == 0) {
+				std::cout << "floor grid doesn't match the BVH at (" << origin.x << ", " << origin.z << "), grid " <<
+					(isGround ? ground.height : 0.0f) << " BVH " << (isHit ? rays.GetHit(ray).point.y : 0.0f) << '\n';
+			}
+			numbMismatches++;
+		}
+		return numbMismatches;
+	}
+
 	namespace InitializationHelpers {
 	// not sure why the book author just copy pastes like 90% of the gltf loader code here, but oh well.
 	// there are minor changes, like not looking for skinning data 
@@ -217,7 +229,13 @@ namespace demos {
 		}
 		this->floorMeshes = InitializationHelpers::LoadMeshes(data);
 		io::FreeGLTFData(data);
-		this->floorTriangles = TrianglesFromMeshes(this->floorMeshes);
+		std::vector<Triangle> floorTriangles = TrianglesFromMeshes(this->floorMeshes);
+		this->floorGrid.Build(floorTriangles, 0.0f, 0.0f);
+#ifdef _DEBUG
+		// the BVH and RayBatch are the exact answer for any ray, check the grid against them once
+		unsigned int numbGridMismatches = this->VerifyFloorGrid(floorTriangles);
+		assert(numbGridMismatches == 0);
+#endif
 
 		// load textures
 		std::cout << "Looking for \'\\resource\\assets\\uv.png\' in working directory.\n";
@@ -306,12 +324,9 @@ namespace demos {
 
 		// set initial actor position to be on the course above (0,0,0)
 		Ray ray(f3(this->actorTransform.position.x, rayHeightAboveGeometry, this->actorTransform.position.z));
-		f3 hitOut;
-		for (unsigned int i = 0, numbTriangles = this->floorTriangles.size(); i < numbTriangles; i++) {
-			if (Intersect(ray, this->floorTriangles[i], hitOut)) {
-				this->actorTransform.position = hitOut;
-				break;
-			}
+		collision::RayHit hit;
+		if (this->CastDown(ray, this->actorGround, hit)) {
+			this->actorTransform.position = hit.point;
 		}
 		this->actorTransform.position.y -= this->groundOffset;
 		this->prevModelHeight = this->actorTransform.position.y;
@@ -356,14 +371,10 @@ namespace demos {
 		f3 forward = actorTransform.rotation * f3(0,0,1); // world is +z forward
 
 		// update actor height by checking which track triangle we are above
-		unsigned int numbTriangles = this->floorTriangles.size();
 		Ray ray(f3(actorTransform.position.x, rayHeightAboveGeometry, actorTransform.position.z));
-		f3 hitOut;
-		for (unsigned int t = 0; t < numbTriangles; t++) {
-			if (Intersect(ray, this->floorTriangles[t], hitOut)) {
-				actorTransform.position = hitOut - f3(0,this->groundOffset,0);
-				break;
-			}
+		collision::RayHit hit;
+		if (this->CastDown(ray, this->actorGround, hit)) {
+			actorTransform.position = hit.point - f3(0,this->groundOffset,0);
 		}
 
 		// animation sample
@@ -382,25 +393,24 @@ namespace demos {
 
 		f3 ground = actorTransform.position;
 		float rayHeight = 2.1f; // derived from the actual model height
-		for (unsigned int t = 0; t < numbTriangles; t++) {
-			if (Intersect(leftRay, this->floorTriangles[t], hitOut)) {
-				if (lengthSquared(hitOut - leftRay.origin) < (rayHeight * rayHeight)) {
-					leftAnklePos = hitOut;
-					if (hitOut.y < ground.y) {
-						ground = hitOut - f3(0,this->groundOffset,0);
-					}
+		// the rays point straight down, so hit distances are heights
+		if (this->CastDown(leftRay, this->leftFootGround, hit)) {
+			if (hit.distance < rayHeight) {
+				leftAnklePos = hit.point;
+				if (hit.point.y < ground.y) {
+					ground = hit.point - f3(0,this->groundOffset,0);
 				}
-				predictedLeftAnklePos = hitOut;
 			}
-			if (Intersect(rightRay, this->floorTriangles[t], hitOut)) {
-				if (lengthSquared(hitOut - rightRay.origin) < (rayHeight * rayHeight)) {
-					rightAnklePos = hitOut;
-					if (hitOut.y < ground.y) {
-						ground = hitOut - f3(0, this->groundOffset, 0);
-					}
+			predictedLeftAnklePos = hit.point;
+		}
+		if (this->CastDown(rightRay, this->rightFootGround, hit)) {
+			if (hit.distance < rayHeight) {
+				rightAnklePos = hit.point;
+				if (hit.point.y < ground.y) {
+					ground = hit.point - f3(0, this->groundOffset, 0);
 				}
-				predictedRightAnklePos = hitOut;
 			}
+			predictedRightAnklePos = hit.point;
 		}
 		// move the model forwards a little bit
 		actorTransform.position.y = this->prevModelHeight;
@@ -443,19 +453,17 @@ namespace demos {
 
 		// check if the toe is clipping into the floor
 		float ankleRayHeight = 1.1f;
-		for (unsigned int t = 0; t < numbTriangles; t++) {
-			if (Intersect(leftToeRay, this->floorTriangles[t], hitOut)) {
-				if (lengthSquared(hitOut - leftToeRay.origin) < (ankleRayHeight * ankleRayHeight)) {
-					leftToeTarget = hitOut;
-				}
-				leftToePredicted = hitOut;
+		if (this->CastDown(leftToeRay, this->leftToeGround, hit)) {
+			if (hit.distance < ankleRayHeight) {
+				leftToeTarget = hit.point;
 			}
-			if (Intersect(rightToeRay, this->floorTriangles[t], hitOut)) {
-				if (lengthSquared(hitOut - rightToeRay.origin) < (ankleRayHeight * ankleRayHeight)) {
-					rightToeTarget = hitOut;
-				}
-				rightToePredicted = hitOut;
+			leftToePredicted = hit.point;
+		}
+		if (this->CastDown(rightToeRay, this->rightToeGround, hit)) {
+			if (hit.distance < ankleRayHeight) {
+				rightToeTarget = hit.point;
 			}
+			rightToePredicted = hit.point;
 		}
 
 		// move the toe based on the walk cycle
@@ -620,9 +628,9 @@ namespace demos {
 	}
 
 	void WalkingDemo::IKLeg::Sovle(const transforms::srt& modelTransform, anim::Pose& pose, const f3& footPlacementTarget) {
-		this->solver.SetLocalBone(0, transforms::combine(modelTransform, pose.GetWorldTransform(this->hipIndex)));
-		this->solver.SetLocalBone(1, pose.GetLocalTransform(kneeIndex));
-		this->solver.SetLocalBone(2, pose.GetLocalTransform(ankleIndex));
+		this->solver[0] = transforms::combine(modelTransform, pose.GetWorldTransform(this->hipIndex));
+		this->solver[1] = pose.GetLocalTransform(kneeIndex);
+		this->solver[2] = pose.GetLocalTransform(ankleIndex);
 
 		this->legPose = pose;
 
@@ -631,9 +639,9 @@ namespace demos {
 		this->solver.SolveChain(footTarget);
 		// write the solution out to the leg pose
 		transforms::srt root = transforms::combine(modelTransform, pose.GetWorldTransform(pose.ParentIndexOf(this->hipIndex)));
-		this->legPose.SetLocalTransform(this->hipIndex, transforms::combine(transforms::inverse(root), this->solver.GetLocalBone(0)));
-		this->legPose.SetLocalTransform(this->kneeIndex, this->solver.GetLocalBone(1));
-		this->legPose.SetLocalTransform(this->ankleIndex, this->solver.GetLocalBone(2));
+		this->legPose.SetLocalTransform(this->hipIndex, transforms::combine(transforms::inverse(root), this->solver[0]));
+		this->legPose.SetLocalTransform(this->kneeIndex, this->solver[1]);
+		this->legPose.SetLocalTransform(this->ankleIndex, this->solver[2]);
 
 		this->legVisualizer->FromIKSolver(this->solver);
 	}
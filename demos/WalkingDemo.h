@@ -13,6 +13,11 @@
 
 #include "../transforms/srt.h"
 
+#include "../collision/Triangle.h"
+#include "../collision/GroundGrid.h"
+#include "../collision/BVH.h"
+#include "../collision/RayBatch.h"
+
 namespace demos {
 
 	/// <summary>
@@ -20,50 +25,27 @@ namespace demos {
 	/// </summary>
 	class WalkingDemo : public Application {
 	protected:
-		// data structures and algorithms for ray casting intersections with triangles
-		struct Ray {
-			f3 origin;
-			f3 direction;
-
-			/// <summary>
-			/// Create a ray that points straight down, at the world origin
-			/// </summary>
-			Ray() : direction(f3(0,-1,0)), origin(f3(0,0,0)) {}
-
-			/// <summary>
-			/// Create a ray at a location that points straight down
-			/// </summary>
-			/// <param name="_origin"></param>
-			Ray(const f3& _origin) : direction(f3(0, -1, 0)), origin(_origin) {}
-
-			Ray(const f3& _origin, const f3& _direction) : direction(_direction), origin(_origin) {}
-		};
-		
-		struct Triangle {
-			/// <summary>
-			/// The three vertices of the triangle
-			/// </summary>
-			f3 v0, v1, v2;
-			f3 normal;
-
-			Triangle() {}
-			Triangle(const f3& _v0, const f3& _v1, const f3& _v2) : v0(_v0), v1(_v1), v2(_v2) {
-				// same algorithm as used in PushingP
-				normal = normalized(cross(v0 - v1, v2 - v0));
-			}
-		};
+		// data structures and algorithms for ray casting intersections with triangles live in collision
+		typedef collision::Ray Ray;
+		typedef collision::Triangle Triangle;
 		std::vector<Triangle> TrianglesFromMesh(render::Mesh& meshy);
 		std::vector<Triangle> TrianglesFromMeshes(std::vector<render::Mesh>& meshes);
 
 		/// <summary>
-		/// Perform a ray cast intersection test against a triangle.
-		/// This function returns false if the intersection point is behind the ray origin
+		/// Find where a ray lands on the floor grid. Vertical rays only: the ray's direction must be (0,-1,0),
+		/// the grid only knows the floor's height under a point. Rays in any other direction need a collision::BVH.
 		/// </summary>
-		/// <param name="ray"></param>
-		/// <param name="triangle"></param>
-		/// <param name="intersectPointOut">The point in space where the ray intersected with the triangle. Only valid if function returns true</param>
-		/// <returns>True if the ray hit the triangle</returns>
-		bool Intersect(const Ray& ray, const Triangle& triangle, f3& intersectPointOut);
+		/// <param name="ray">Points straight down, see Ray(origin)</param>
+		/// <param name="cache">The triangle the ray landed on last time</param>
+		/// <returns>True if the ray hit the floor</returns>
+		bool CastDown(const Ray& ray, collision::GroundCache& cache, collision::RayHit& hitOut);
+		/// <summary>
+		/// Debug check of floorGrid, casts a lattice of rays straight down onto a BVH of the same triangles with a RayBatch
+		/// and compares each hit with the grid's. Slow, builds the BVH and allocates, call it once after building the grid.
+		/// Prints the first ray the grid gets wrong.
+		/// </summary>
+		/// <returns>The number of rays the grid and the BVH don't agree on</returns>
+		unsigned int VerifyFloorGrid(const std::vector<Triangle>& triangles) const;
 
 		struct RenderOptions {
 			bool IKPose;
@@ -88,7 +70,10 @@ namespace demos {
 			/// 1 dimensional track that records the height of the leg over the duration of the walk cycle
 			/// </summary>
 			anim::TrackScalar legHeight;
-			ik::FABRIKSolver solver;
+			/// <summary>
+			/// hip -> knee -> ankle is solved exactly, the leg keeps bending in the plane the walk cycle bends it in
+			/// </summary>
+			ik::TwoBoneSolver solver;
 			/// <summary>
 			/// legPose stores the pose after inverse kinematics has been used to solve where the foot should be placed
 			/// </summary>
@@ -133,7 +118,14 @@ namespace demos {
 	protected:
 		render::Texture* floorTexture;
 		std::vector<render::Mesh> floorMeshes;
-		std::vector<Triangle> floorTriangles;
+		/// <summary>
+		/// The floor meshes' triangles baked into a grid, the actor, foot and toe rays all point straight down so they are answered by it
+		/// </summary>
+		collision::GroundGrid floorGrid;
+		/// <summary>
+		/// The floor triangle each ray landed on last update
+		/// </summary>
+		collision::GroundCache actorGround, leftFootGround, rightFootGround, leftToeGround, rightToeGround;
 		render::Shader* floorShader;
 
 		/// <summary>
@@ -1,4 +1,6 @@
 #include "CCDSolver.h"
+#include <cmath>
+#include <chrono>
 #include <cassert>
 
 namespace ik {
@@ -8,12 +10,17 @@ namespace ik {
 		constexpr float defaultThreshold = 0.0001f;
 		this->iterMaxSteps = defaultIterSteps;
 		this->solveThreshold = defaultThreshold;
+		this->budget = NULL;
+		this->lastIterations = 0;
+		this->lastError = 0.0f;
+		this->stats = NULL;
 	}
 
 	unsigned int CCDSolver::ChainSize()	{ return this->localBoneChain.size(); }
 
 	void CCDSolver::ResizeChain(unsigned int size) {
 		this->localBoneChain.resize(size);
+		this->modelBoneChain.resize(size);
 	}
 
 	transforms::srt& CCDSolver::operator[](unsigned int index) {
@@ -31,6 +38,18 @@ namespace ik {
 		return answer;
 	}
 
+	void CCDSolver::UpdateModelChain() {
+		unsigned int numbBones = this->ChainSize();
+		if (this->modelBoneChain.size() != numbBones) {
+			this->modelBoneChain.resize(numbBones);
+		}
+		if (numbBones == 0) { return; }
+		this->modelBoneChain[0] = this->localBoneChain[0];
+		for (unsigned int i = 1; i < numbBones; i++) {
+			this->modelBoneChain[i] = transforms::combine(this->modelBoneChain[i - 1], this->localBoneChain[i]);
+		}
+	}
+
 	unsigned int CCDSolver::GetIterMaxSteps() { return this->iterMaxSteps; }
 
 	void CCDSolver::SetIterMaxSteps(unsigned int numbSteps)	{
@@ -46,23 +65,39 @@ namespace ik {
 	bool CCDSolver::SolveChain(const transforms::srt& target) {
 		// set up
 		unsigned int numbBones = this->ChainSize();
+		this->lastIterations = 0;
+		this->lastError = 0.0f;
 		if (numbBones <= 1) { return false; }
+		std::chrono::steady_clock::time_point start;
+		if (this->stats != NULL) { start = std::chrono::steady_clock::now(); }
 		f3 targetPos = target.position;
 		float threshSq = this->solveThreshold * this->solveThreshold;
 		unsigned int effectorIndex = numbBones - 1;
 
-		f3 effectorPos = this->GetBoneAt(effectorIndex).position;
+		this->warmStart.Begin(this->localBoneChain);
+		this->UpdateModelChain();
+		f3 effectorPos = this->modelBoneChain[effectorIndex].position;
 		// check if we need to do any work
-		if (lengthSquared(targetPos - effectorPos) < threshSq) { return true; }
+		bool isSolved = lengthSquared(targetPos - effectorPos) < threshSq;
+		bool budgetSpent = false;
 
-		for (unsigned int i = 0; i < this->iterMaxSteps; i++) {
+		for (unsigned int i = 0; i < this->iterMaxSteps && !isSolved; i++) {
+			if (this->budget != NULL && !this->budget->Take()) {
+				budgetSpent = true;
+				break;
+			}
+			this->lastIterations++;
+			if (i > 0) {
+				// the last iteration rotated the bones, bring the cached model space chain up to date once for the whole iteration
+				this->UpdateModelChain();
+			}
 			// rotate every bone in the chain, skip the end effector, since rotating the effector has no effect.
 			// rotations move the effector towards the target. Check if we can stop after each bone rotation is applied.
 			for (int boneIndex = ((int)effectorIndex) - 1; boneIndex >= 0; boneIndex--) {
 				// the CCD algorithm
-				transforms::srt modelSpaceBone = this->GetBoneAt(boneIndex);
+				// the bones rotated so far this iteration are all children of this bone, so its cached model space transform is still correct
+				const transforms::srt& modelSpaceBone = this->modelBoneChain[boneIndex];
 				f3 bonePos = modelSpaceBone.position;
-					// effectorPos = this->GetBoneAt(effectorIndex).position; // TODO delete this line if no bugs in demo
 				// make a rotation for this bone that points the effector towards the target in model space
 				f3 boneToEffector = effectorPos - bonePos;
 				f3 boneToTarget = targetPos - bonePos;
@@ -79,11 +114,40 @@ namespace ik {
 				transforms::srt& bone = this->localBoneChain[boneIndex];
 				bone.rotation = newBoneRotationLocal * bone.rotation;
 				// CONSTRAINT LOGIC APPLIED AFTER ITERATION
-				// update effector model space position after each bone movement
-				effectorPos = this->GetBoneAt(effectorIndex).position;
-				if (lengthSquared(targetPos - effectorPos) < threshSq) { return true; }
+				// the rotation swings the effector around the bone, so the effector's new position doesn't need the whole chain
+				effectorPos = bonePos + effectorToTarget * boneToEffector;
+				if (lengthSquared(targetPos - effectorPos) < threshSq) {
+					isSolved = true;
+					break;
+				}
 			}
 		}
-		return false;
+		this->warmStart.End(this->localBoneChain);
+		// the exact distance, length() rounds misses shorter than sqrt(epsilon) down to 0
+		this->lastError = sqrtf(lengthSquared(targetPos - effectorPos));
+		if (this->stats != NULL) {
+			std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+			SolveEnd end = isSolved ? SolveEnd::Reached : (budgetSpent ? SolveEnd::Budget : SolveEnd::MaxSteps);
+			this->stats->Record(this->lastIterations, this->iterMaxSteps, end, this->lastError, seconds.count());
+		}
+		return isSolved;
 	}
+
+	WarmStart& CCDSolver::GetWarmStart() { return this->warmStart; }
+
+	void CCDSolver::SetIterationBudget(IterationBudget* budget) {
+		this->budget = budget;
+	}
+
+	IterationBudget* CCDSolver::GetIterationBudget() { return this->budget; }
+
+	void CCDSolver::SetStats(SolverStats* stats) {
+		this->stats = stats;
+	}
+
+	SolverStats* CCDSolver::GetStats() { return this->stats; }
+
+	unsigned int CCDSolver::GetLastIterations() { return this->lastIterations; }
+
+	float CCDSolver::GetLastError() { return this->lastError; }
 }
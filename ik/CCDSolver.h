@@ -2,6 +2,9 @@
 
 #include <vector>
 #include "../transforms/srt.h"
+#include "IterationBudget.h"
+#include "WarmStart.h"
+#include "SolverStats.h"
 
 // FABRIK and CCD are iterative IK solvers, but there are other solvers out there.
 // There is also analytical solution methods (plug values into a formula, get an answer, O(1)) and Jacobian Matrix Solvers
@@ -24,6 +27,11 @@ namespace ik {
 		/// The chain is modified in place during solving. 
 		/// </summary>
 		std::vector<transforms::srt> localBoneChain;
+
+		/// <summary>
+		/// localBoneChain in model space, rebuilt once per iteration instead of combining the chain from the root for every bone.
+		/// </summary>
+		std::vector<transforms::srt> modelBoneChain;
 		
 		/// <summary>
 		/// The maximum number of iteration steps before the solver gives up.
@@ -35,6 +43,34 @@ namespace ik {
 		/// the solver will accept the current solution and return early.
 		/// </summary>
 		float solveThreshold;
+
+		/// <summary>
+		/// Carries the last solve's answer over to the next solve, off by default
+		/// </summary>
+		WarmStart warmStart;
+
+		/// <summary>
+		/// Shared with other solvers, NULL if the solver is only limited by iterMaxSteps. Not owned by the solver.
+		/// </summary>
+		IterationBudget* budget;
+
+		/// <summary>
+		/// What the last solve did, see GetLastIterations and GetLastError
+		/// </summary>
+		unsigned int lastIterations;
+		float lastError;
+
+		/// <summary>
+		/// Every solve is recorded here when it isn't NULL. Not owned by the solver.
+		/// </summary>
+		SolverStats* stats;
+	protected:
+
+		/// <summary>
+		/// Combine localBoneChain into modelBoneChain from the root down. Called once per iteration: an iteration rotates the bones
+		/// from the effector back towards the root, so every bone it reaches still has an up to date parent in the cache.
+		/// </summary>
+		void UpdateModelChain();
 	public:
 		
 		/// <summary>
@@ -103,6 +139,37 @@ namespace ik {
 		/// <param name="target">The location that the IK solver should try to move the end effector to, in model space</param>
 		/// <returns>True if the end effector was able to reach the target</returns>
 		bool SolveChain(const transforms::srt& target);
+
+		/// <summary>
+		/// Start each solve from the last solve's answer, see WarmStart. For chains that are set from an animated pose before every solve.
+		/// </summary>
+		WarmStart& GetWarmStart();
+
+		/// <summary>
+		/// Share an iteration budget with other solvers, each iteration takes one from it and the solve stops when it is spent.
+		/// iterMaxSteps still limits each solve on its own.
+		/// </summary>
+		/// <param name="budget">Not owned by the solver, NULL to only use iterMaxSteps</param>
+		void SetIterationBudget(IterationBudget* budget);
+		IterationBudget* GetIterationBudget();
+
+		/// <summary>
+		/// Record the iterations, residual distance and time of every solve, to tune iterMaxSteps and solveThreshold.
+		/// Solves are only timed while stats are set.
+		/// </summary>
+		/// <param name="stats">Not owned by the solver, NULL to stop recording</param>
+		void SetStats(SolverStats* stats);
+		SolverStats* GetStats();
+
+		/// <summary>
+		/// The number of iterations the last solve ran, 0 if the end effector was already on the target.
+		/// </summary>
+		unsigned int GetLastIterations();
+
+		/// <summary>
+		/// The distance between the end effector and the target after the last solve
+		/// </summary>
+		float GetLastError();
 	};
 
 }
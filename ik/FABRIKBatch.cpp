@@ -0,0 +1,333 @@
+#include "FABRIKBatch.h"
+#include "../FloatHelp.h"
+#include "../SIMD.h"
+
+namespace ik {
+
+	FABRIKBatch::FABRIKBatch() {
+		constexpr unsigned int defaultIterCount = 15;
+		constexpr float defaultThreshold = 0.0001f;
+		this->numbChains = 0;
+		this->numbBones = 0;
+		this->stride = 0;
+		this->iterMaxSteps = defaultIterCount;
+		this->solveThreshold = defaultThreshold;
+	}
+
+	void FABRIKBatch::Resize(unsigned int numbChains, unsigned int numbBones) {
+		this->numbChains = numbChains;
+		this->numbBones = numbBones;
+		this->stride = (numbChains + SIMDWidestLanes - 1) / SIMDWidestLanes * SIMDWidestLanes;
+		// padding chains are all zeros, their end effector is always on their target so they are never moved
+		unsigned int size = this->stride * numbBones;
+		this->positionX.assign(size, 0.0f);
+		this->positionY.assign(size, 0.0f);
+		this->positionZ.assign(size, 0.0f);
+		this->boneLengths.assign(size, 0.0f);
+		this->targetX.assign(this->stride, 0.0f);
+		this->targetY.assign(this->stride, 0.0f);
+		this->targetZ.assign(this->stride, 0.0f);
+		this->solved.assign(this->stride, 0);
+	}
+
+	unsigned int FABRIKBatch::NumbChains() const { return this->numbChains; }
+
+	unsigned int FABRIKBatch::NumbBones() const { return this->numbBones; }
+
+	void FABRIKBatch::SetChain(unsigned int chain, const f3* modelPositions) {
+		for (unsigned int bone = 0; bone < this->numbBones; bone++) {
+			unsigned int i = bone * this->stride + chain;
+			this->positionX[i] = modelPositions[bone].x;
+			this->positionY[i] = modelPositions[bone].y;
+			this->positionZ[i] = modelPositions[bone].z;
+			this->boneLengths[i] = bone > 0 ? length(modelPositions[bone] - modelPositions[bone - 1]) : 0.0f;
+		}
+	}
+
+	void FABRIKBatch::GetChain(unsigned int chain, f3* modelPositionsOut) const {
+		for (unsigned int bone = 0; bone < this->numbBones; bone++) {
+			modelPositionsOut[bone] = this->GetBonePosition(chain, bone);
+		}
+	}
+
+	f3 FABRIKBatch::GetBonePosition(unsigned int chain, unsigned int bone) const {
+		unsigned int i = bone * this->stride + chain;
+		return f3(this->positionX[i], this->positionY[i], this->positionZ[i]);
+	}
+
+	void FABRIKBatch::SetTarget(unsigned int chain, const f3& target) {
+		this->targetX[chain] = target.x;
+		this->targetY[chain] = target.y;
+		this->targetZ[chain] = target.z;
+	}
+
+	f3 FABRIKBatch::GetTarget(unsigned int chain) const {
+		return f3(this->targetX[chain], this->targetY[chain], this->targetZ[chain]);
+	}
+
+	unsigned int FABRIKBatch::GetIterMaxSteps() const { return this->iterMaxSteps; }
+
+	void FABRIKBatch::SetIterMaxSteps(unsigned int numbSteps) {
+		this->iterMaxSteps = numbSteps;
+	}
+
+	float FABRIKBatch::GetSolveThreshold() const { return this->solveThreshold; }
+
+	void FABRIKBatch::SetSolveThreshold(float threshold) {
+		this->solveThreshold = threshold;
+	}
+
+	bool FABRIKBatch::IsSolved(unsigned int chain) const { return this->solved[chain] != 0; }
+
+	unsigned int FABRIKBatch::Solve() {
+		if (this->numbBones < 2) {
+			/* not enough bones to run the algorithm */
+			this->solved.assign(this->stride, 0);
+			return 0;
+		}
+		SIMDLevel level = GetSIMDLevel();
+		if (level == SIMDLevel::AVX2) {
+			this->SolveAVX2(0, this->stride);
+		} else if (level == SIMDLevel::SSE) {
+			this->SolveSSE(0, this->stride);
+		} else {
+			this->SolveScalar(0, this->numbChains);
+		}
+		unsigned int numbSolved = 0;
+		for (unsigned int chain = 0; chain < this->numbChains; chain++) {
+			numbSolved += this->solved[chain];
+		}
+		return numbSolved;
+	}
+
+	// Each kernel is FABRIKSolver::SolveChain, Forward and Backward on the batch's layout, and does the math in the same order
+	// (normalized() leaves vectors shorter than epsilon alone) so the SIMD kernels match the scalar solver.
+
+	void FABRIKBatch::SolveScalar(unsigned int begin, unsigned int end) {
+		unsigned int effectorIndex = this->numbBones - 1;
+		unsigned int stride = this->stride;
+		float threshSq = this->solveThreshold * this->solveThreshold;
+		float* px = this->positionX.data();
+		float* py = this->positionY.data();
+		float* pz = this->positionZ.data();
+		const float* lengths = this->boneLengths.data();
+		for (unsigned int chain = begin; chain < end; chain++) {
+			f3 target(this->targetX[chain], this->targetY[chain], this->targetZ[chain]);
+			f3 root(px[chain], py[chain], pz[chain]);
+			bool isSolved = false;
+			for (unsigned int iter = 0; ; iter++) {
+				unsigned int e = effectorIndex * stride + chain;
+				isSolved = lengthSquared(target - f3(px[e], py[e], pz[e])) < threshSq;
+				if (isSolved || iter == this->iterMaxSteps) { break; }
+				// forward, the end effector goes to the target and pulls the chain after it
+				f3 child = target;
+				px[e] = target.x; py[e] = target.y; pz[e] = target.z;
+				for (int bone = (int) effectorIndex - 1; bone >= 0; bone--) {
+					unsigned int i = bone * stride + chain;
+					f3 toChild = normalized(f3(px[i], py[i], pz[i]) - child);
+					child = child + toChild * lengths[i + stride];
+					px[i] = child.x; py[i] = child.y; pz[i] = child.z;
+				}
+				// backward, the root goes back and pushes the chain after it
+				f3 parent = root;
+				px[chain] = root.x; py[chain] = root.y; pz[chain] = root.z;
+				for (unsigned int bone = 1; bone <= effectorIndex; bone++) {
+					unsigned int i = bone * stride + chain;
+					f3 toParent = normalized(f3(px[i], py[i], pz[i]) - parent);
+					parent = parent + toParent * lengths[i];
+					px[i] = parent.x; py[i] = parent.y; pz[i] = parent.z;
+				}
+			}
+			this->solved[chain] = isSolved ? 1 : 0;
+		}
+	}
+
+	void FABRIKBatch::SolveSSE(unsigned int begin, unsigned int end) {
+#if defined(SIMD_X86)
+		unsigned int effectorIndex = this->numbBones - 1;
+		unsigned int stride = this->stride;
+		const __m128 threshSq = _mm_set1_ps(this->solveThreshold * this->solveThreshold);
+		const __m128 minLengthSq = _mm_set1_ps(epsilon);
+		const __m128 one = _mm_set1_ps(1.0f);
+		for (unsigned int chain = begin; chain < end; chain += 4) {
+			float* px = &this->positionX[chain];
+			float* py = &this->positionY[chain];
+			float* pz = &this->positionZ[chain];
+			const float* lengths = &this->boneLengths[chain];
+			const __m128 tx = _mm_loadu_ps(&this->targetX[chain]);
+			const __m128 ty = _mm_loadu_ps(&this->targetY[chain]);
+			const __m128 tz = _mm_loadu_ps(&this->targetZ[chain]);
+			const __m128 rx = _mm_loadu_ps(px);
+			const __m128 ry = _mm_loadu_ps(py);
+			const __m128 rz = _mm_loadu_ps(pz);
+			const unsigned int e = effectorIndex * stride;
+			__m128 active;
+			for (unsigned int iter = 0; ; iter++) {
+				__m128 dx = _mm_sub_ps(tx, _mm_loadu_ps(px + e));
+				__m128 dy = _mm_sub_ps(ty, _mm_loadu_ps(py + e));
+				__m128 dz = _mm_sub_ps(tz, _mm_loadu_ps(pz + e));
+				__m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+				// lanes that reached their target retire, their positions are blended back unchanged from here on
+				active = _mm_cmpge_ps(distSq, threshSq);
+				if (_mm_movemask_ps(active) == 0 || iter == this->iterMaxSteps) { break; }
+				// forward
+				__m128 cx = _mm_or_ps(_mm_and_ps(active, tx), _mm_andnot_ps(active, _mm_loadu_ps(px + e)));
+				__m128 cy = _mm_or_ps(_mm_and_ps(active, ty), _mm_andnot_ps(active, _mm_loadu_ps(py + e)));
+				__m128 cz = _mm_or_ps(_mm_and_ps(active, tz), _mm_andnot_ps(active, _mm_loadu_ps(pz + e)));
+				_mm_storeu_ps(px + e, cx);
+				_mm_storeu_ps(py + e, cy);
+				_mm_storeu_ps(pz + e, cz);
+				for (int bone = (int) effectorIndex - 1; bone >= 0; bone--) {
+					unsigned int i = bone * stride;
+					__m128 x = _mm_loadu_ps(px + i);
+					__m128 y = _mm_loadu_ps(py + i);
+					__m128 z = _mm_loadu_ps(pz + i);
+					__m128 vx = _mm_sub_ps(x, cx);
+					__m128 vy = _mm_sub_ps(y, cy);
+					__m128 vz = _mm_sub_ps(z, cz);
+					__m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+					__m128 isShort = _mm_cmplt_ps(lengthSq, minLengthSq);
+					__m128 inv = _mm_or_ps(_mm_and_ps(isShort, one), _mm_andnot_ps(isShort, _mm_div_ps(one, _mm_sqrt_ps(lengthSq))));
+					__m128 boneLength = _mm_loadu_ps(lengths + i + stride);
+					cx = _mm_add_ps(cx, _mm_mul_ps(_mm_mul_ps(vx, inv), boneLength));
+					cy = _mm_add_ps(cy, _mm_mul_ps(_mm_mul_ps(vy, inv), boneLength));
+					cz = _mm_add_ps(cz, _mm_mul_ps(_mm_mul_ps(vz, inv), boneLength));
+					cx = _mm_or_ps(_mm_and_ps(active, cx), _mm_andnot_ps(active, x));
+					cy = _mm_or_ps(_mm_and_ps(active, cy), _mm_andnot_ps(active, y));
+					cz = _mm_or_ps(_mm_and_ps(active, cz), _mm_andnot_ps(active, z));
+					_mm_storeu_ps(px + i, cx);
+					_mm_storeu_ps(py + i, cy);
+					_mm_storeu_ps(pz + i, cz);
+				}
+				// backward
+				cx = _mm_or_ps(_mm_and_ps(active, rx), _mm_andnot_ps(active, _mm_loadu_ps(px)));
+				cy = _mm_or_ps(_mm_and_ps(active, ry), _mm_andnot_ps(active, _mm_loadu_ps(py)));
+				cz = _mm_or_ps(_mm_and_ps(active, rz), _mm_andnot_ps(active, _mm_loadu_ps(pz)));
+				_mm_storeu_ps(px, cx);
+				_mm_storeu_ps(py, cy);
+				_mm_storeu_ps(pz, cz);
+				for (unsigned int bone = 1; bone <= effectorIndex; bone++) {
+					unsigned int i = bone * stride;
+					__m128 x = _mm_loadu_ps(px + i);
+					__m128 y = _mm_loadu_ps(py + i);
+					__m128 z = _mm_loadu_ps(pz + i);
+					__m128 vx = _mm_sub_ps(x, cx);
+					__m128 vy = _mm_sub_ps(y, cy);
+					__m128 vz = _mm_sub_ps(z, cz);
+					__m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+					__m128 isShort = _mm_cmplt_ps(lengthSq, minLengthSq);
+					__m128 inv = _mm_or_ps(_mm_and_ps(isShort, one), _mm_andnot_ps(isShort, _mm_div_ps(one, _mm_sqrt_ps(lengthSq))));
+					__m128 boneLength = _mm_loadu_ps(lengths + i);
+					cx = _mm_add_ps(cx, _mm_mul_ps(_mm_mul_ps(vx, inv), boneLength));
+					cy = _mm_add_ps(cy, _mm_mul_ps(_mm_mul_ps(vy, inv), boneLength));
+					cz = _mm_add_ps(cz, _mm_mul_ps(_mm_mul_ps(vz, inv), boneLength));
+					cx = _mm_or_ps(_mm_and_ps(active, cx), _mm_andnot_ps(active, x));
+					cy = _mm_or_ps(_mm_and_ps(active, cy), _mm_andnot_ps(active, y));
+					cz = _mm_or_ps(_mm_and_ps(active, cz), _mm_andnot_ps(active, z));
+					_mm_storeu_ps(px + i, cx);
+					_mm_storeu_ps(py + i, cy);
+					_mm_storeu_ps(pz + i, cz);
+				}
+			}
+			// still active lanes ran out of iterations without reaching their target
+			int unsolved = _mm_movemask_ps(active);
+			for (unsigned int lane = 0; lane < 4; lane++) {
+				this->solved[chain + lane] = (unsolved & (1 << lane)) ? 0 : 1;
+			}
+		}
+#else
+		this->SolveScalar(begin, end);
+#endif
+	}
+
+	SIMD_TARGET_AVX2
+	void FABRIKBatch::SolveAVX2(unsigned int begin, unsigned int end) {
+#if defined(SIMD_X86)
+		unsigned int effectorIndex = this->numbBones - 1;
+		unsigned int stride = this->stride;
+		const __m256 threshSq = _mm256_set1_ps(this->solveThreshold * this->solveThreshold);
+		const __m256 minLengthSq = _mm256_set1_ps(epsilon);
+		const __m256 one = _mm256_set1_ps(1.0f);
+		for (unsigned int chain = begin; chain < end; chain += 8) {
+			float* px = &this->positionX[chain];
+			float* py = &this->positionY[chain];
+			float* pz = &this->positionZ[chain];
+			const float* lengths = &this->boneLengths[chain];
+			const __m256 tx = _mm256_loadu_ps(&this->targetX[chain]);
+			const __m256 ty = _mm256_loadu_ps(&this->targetY[chain]);
+			const __m256 tz = _mm256_loadu_ps(&this->targetZ[chain]);
+			const __m256 rx = _mm256_loadu_ps(px);
+			const __m256 ry = _mm256_loadu_ps(py);
+			const __m256 rz = _mm256_loadu_ps(pz);
+			const unsigned int e = effectorIndex * stride;
+			__m256 active;
+			for (unsigned int iter = 0; ; iter++) {
+				__m256 dx = _mm256_sub_ps(tx, _mm256_loadu_ps(px + e));
+				__m256 dy = _mm256_sub_ps(ty, _mm256_loadu_ps(py + e));
+				__m256 dz = _mm256_sub_ps(tz, _mm256_loadu_ps(pz + e));
+				__m256 distSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+				active = _mm256_cmp_ps(distSq, threshSq, _CMP_GE_OQ);
+				if (_mm256_movemask_ps(active) == 0 || iter == this->iterMaxSteps) { break; }
+				// forward
+				__m256 cx = _mm256_blendv_ps(_mm256_loadu_ps(px + e), tx, active);
+				__m256 cy = _mm256_blendv_ps(_mm256_loadu_ps(py + e), ty, active);
+				__m256 cz = _mm256_blendv_ps(_mm256_loadu_ps(pz + e), tz, active);
+				_mm256_storeu_ps(px + e, cx);
+				_mm256_storeu_ps(py + e, cy);
+				_mm256_storeu_ps(pz + e, cz);
+				for (int bone = (int) effectorIndex - 1; bone >= 0; bone--) {
+					unsigned int i = bone * stride;
+					__m256 x = _mm256_loadu_ps(px + i);
+					__m256 y = _mm256_loadu_ps(py + i);
+					__m256 z = _mm256_loadu_ps(pz + i);
+					__m256 vx = _mm256_sub_ps(x, cx);
+					__m256 vy = _mm256_sub_ps(y, cy);
+					__m256 vz = _mm256_sub_ps(z, cz);
+					__m256 lengthSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy)), _mm256_mul_ps(vz, vz));
+					__m256 isShort = _mm256_cmp_ps(lengthSq, minLengthSq, _CMP_LT_OQ);
+					__m256 inv = _mm256_blendv_ps(_mm256_div_ps(one, _mm256_sqrt_ps(lengthSq)), one, isShort);
+					__m256 boneLength = _mm256_loadu_ps(lengths + i + stride);
+					cx = _mm256_blendv_ps(x, _mm256_add_ps(cx, _mm256_mul_ps(_mm256_mul_ps(vx, inv), boneLength)), active);
+					cy = _mm256_blendv_ps(y, _mm256_add_ps(cy, _mm256_mul_ps(_mm256_mul_ps(vy, inv), boneLength)), active);
+					cz = _mm256_blendv_ps(z, _mm256_add_ps(cz, _mm256_mul_ps(_mm256_mul_ps(vz, inv), boneLength)), active);
+					_mm256_storeu_ps(px + i, cx);
+					_mm256_storeu_ps(py + i, cy);
+					_mm256_storeu_ps(pz + i, cz);
+				}
+				// backward
+				cx = _mm256_blendv_ps(_mm256_loadu_ps(px), rx, active);
+				cy = _mm256_blendv_ps(_mm256_loadu_ps(py), ry, active);
+				cz = _mm256_blendv_ps(_mm256_loadu_ps(pz), rz, active);
+				_mm256_storeu_ps(px, cx);
+				_mm256_storeu_ps(py, cy);
+				_mm256_storeu_ps(pz, cz);
+				for (unsigned int bone = 1; bone <= effectorIndex; bone++) {
+					unsigned int i = bone * stride;
+					__m256 x = _mm256_loadu_ps(px + i);
+					__m256 y = _mm256_loadu_ps(py + i);
+					__m256 z = _mm256_loadu_ps(pz + i);
+					__m256 vx = _mm256_sub_ps(x, cx);
+					__m256 vy = _mm256_sub_ps(y, cy);
+					__m256 vz = _mm256_sub_ps(z, cz);
+					__m256 lengthSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy)), _mm256_mul_ps(vz, vz));
+					__m256 isShort = _mm256_cmp_ps(lengthSq, minLengthSq, _CMP_LT_OQ);
+					__m256 inv = _mm256_blendv_ps(_mm256_div_ps(one, _mm256_sqrt_ps(lengthSq)), one, isShort);
+					__m256 boneLength = _mm256_loadu_ps(lengths + i);
+					cx = _mm256_blendv_ps(x, _mm256_add_ps(cx, _mm256_mul_ps(_mm256_mul_ps(vx, inv), boneLength)), active);
+					cy = _mm256_blendv_ps(y, _mm256_add_ps(cy, _mm256_mul_ps(_mm256_mul_ps(vy, inv), boneLength)), active);
+					cz = _mm256_blendv_ps(z, _mm256_add_ps(cz, _mm256_mul_ps(_mm256_mul_ps(vz, inv), boneLength)), active);
+					_mm256_storeu_ps(px + i, cx);
+					_mm256_storeu_ps(py + i, cy);
+					_mm256_storeu_ps(pz + i, cz);
+				}
+			}
+			int unsolved = _mm256_movemask_ps(active);
+			for (unsigned int lane = 0; lane < 8; lane++) {
+				this->solved[chain + lane] = (unsolved & (1 << lane)) ? 0 : 1;
+			}
+		}
+#else
+		this->SolveScalar(begin, end);
+#endif
+	}
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <vector>
+#include "../Vector3.h"
+
+namespace ik {
+
+	/// <summary>
+	/// Solves many FABRIK chains with the same number of bones at once, e.g. the legs of a crowd.
+	/// The chains are stored structure of arrays, bone 'b' of every chain is next to each other in memory,
+	/// so the forward and backward passes move 4 (SSE) or 8 (AVX2) chains with each instruction.
+	/// Chains that reach their target stop moving while the rest of their group keeps iterating, a group stops when all its chains are done.
+	/// Gives the same positions as FABRIKSolver solving each chain on its own. Constraints aren't supported.
+	/// AnimGraph solves each character's IK nodes inside its own update, so it doesn't use the batch. Gather the chains of many
+	/// characters' output poses into one, e.g. after AnimationWorld::Update, then write the solved positions back.
+	/// </summary>
+	class FABRIKBatch {
+	protected:
+		/// <summary>
+		/// Chains are padded to a multiple of the widest SIMD group, padding chains never move.
+		/// </summary>
+		unsigned int numbChains;
+		unsigned int numbBones;
+		unsigned int stride;
+		/// <summary>
+		/// Model space bone positions, [bone * stride + chain]
+		/// </summary>
+		std::vector<float> positionX;
+		std::vector<float> positionY;
+		std::vector<float> positionZ;
+		/// <summary>
+		/// The length from bone - 1 to bone, [bone * stride + chain], bone 0 has no length.
+		/// </summary>
+		std::vector<float> boneLengths;
+		/// <summary>
+		/// Where each chain's end effector should go, [chain]
+		/// </summary>
+		std::vector<float> targetX;
+		std::vector<float> targetY;
+		std::vector<float> targetZ;
+		/// <summary>
+		/// 1 if the chain's end effector reached its target in the last Solve, [chain]
+		/// </summary>
+		std::vector<unsigned char> solved;
+		/// <summary>
+		/// The maximum number of iteration steps before a chain is given up on.
+		/// </summary>
+		unsigned int iterMaxSteps;
+		/// <summary>
+		/// A chain is done when its end effector is within this distance of its target.
+		/// </summary>
+		float solveThreshold;
+	protected:
+		/// <summary>
+		/// Solve chains [begin, end) one at a time, the reference the SIMD kernels are checked against.
+		/// </summary>
+		void SolveScalar(unsigned int begin, unsigned int end);
+		/// <summary>
+		/// Solve chains [begin, end) 4 at a time, begin and end are multiples of 4.
+		/// </summary>
+		void SolveSSE(unsigned int begin, unsigned int end);
+		/// <summary>
+		/// Solve chains [begin, end) 8 at a time, begin and end are multiples of 8.
+		/// </summary>
+		void SolveAVX2(unsigned int begin, unsigned int end);
+	public:
+		/// <summary>
+		/// Create an empty batch with the same default iteration steps and solution threshold as FABRIKSolver.
+		/// </summary>
+		FABRIKBatch();
+		/// <summary>
+		/// Change how many chains the batch holds, and how many bones each chain has. The solver needs 2 or more bones.
+		/// Existing positions are not kept.
+		/// </summary>
+		void Resize(unsigned int numbChains, unsigned int numbBones);
+		unsigned int NumbChains() const;
+		unsigned int NumbBones() const;
+		/// <summary>
+		/// Set every bone position of a chain, and measure the chain's bone lengths from them.
+		/// The first position is the root, it stays where it is when the chain is solved.
+		/// </summary>
+		/// <param name="chain"></param>
+		/// <param name="modelPositions">NumbBones positions, see FABRIKSolver::GetChainPositions</param>
+		void SetChain(unsigned int chain, const f3* modelPositions);
+		/// <summary>
+		/// Read every bone position of a chain, see FABRIKSolver::SetChainPositions
+		/// </summary>
+		/// <param name="chain"></param>
+		/// <param name="modelPositionsOut">NumbBones positions</param>
+		void GetChain(unsigned int chain, f3* modelPositionsOut) const;
+		f3 GetBonePosition(unsigned int chain, unsigned int bone) const;
+		void SetTarget(unsigned int chain, const f3& target);
+		f3 GetTarget(unsigned int chain) const;
+		unsigned int GetIterMaxSteps() const;
+		void SetIterMaxSteps(unsigned int numbSteps);
+		float GetSolveThreshold() const;
+		void SetSolveThreshold(float threshold);
+		/// <summary>
+		/// Move every chain's end effector towards its target, with the widest SIMD kernel the CPU supports.
+		/// </summary>
+		/// <returns>The number of chains whose end effector reached its target</returns>
+		unsigned int Solve();
+		/// <summary>
+		/// True if the chain's end effector reached its target in the last Solve
+		/// </summary>
+		bool IsSolved(unsigned int chain) const;
+	};
+}
@@ -1,15 +1,26 @@
 #include "FABRIKSolver.h"
+#include <cmath>
+#include <chrono>
 
 namespace ik {
 
+	void FABRIKSolver::UpdateModelChain() {
+		unsigned int numbBones = this->ChainSize();
+		if (numbBones == 0) { return; }
+		this->modelBoneChain[0] = this->localBoneChain[0];
+		for (unsigned int boneIndex = 1; boneIndex < numbBones; boneIndex++) {
+			this->modelBoneChain[boneIndex] = transforms::combine(this->modelBoneChain[boneIndex - 1], this->localBoneChain[boneIndex]);
+		}
+	}
+
 	void FABRIKSolver::ToChainPosition() {
+		this->UpdateModelChain();
 		unsigned int numbBones = this->ChainSize();
 		for (unsigned int boneIndex = 0; boneIndex < numbBones; boneIndex++) {
-			transforms::srt bone = this->GetBone(boneIndex);
-			this->bonePosChain[boneIndex] = bone.position;
+			this->bonePosChain[boneIndex] = this->modelBoneChain[boneIndex].position;
 			if (boneIndex > 0) {
 				f3 previous = this->bonePosChain[boneIndex - 1];
-				this->boneLengths[boneIndex] = length(bone.position - previous);
+				this->boneLengths[boneIndex] = length(this->bonePosChain[boneIndex] - previous);
 			}
 		}
 		if (numbBones > 0) {
@@ -49,10 +60,11 @@ namespace ik {
 	void FABRIKSolver::ChainPositionToLocalBone() {
 		unsigned int numbBones = this->ChainSize();
 		if (numbBones < 1) { return; }
+		// the parent's model space transform is carried down the chain, each bone is combined once
+		transforms::srt bone = this->localBoneChain[0];
 		for (unsigned int boneIndex = 0; boneIndex < numbBones - 1; boneIndex++) {
 			// skip last bone because modifying the end effector's rotation has no effect on reaching the goal
-			transforms::srt bone = GetBone(boneIndex);
-			transforms::srt childBone = GetBone(boneIndex + 1);
+			transforms::srt childBone = transforms::combine(bone, this->localBoneChain[boneIndex + 1]);
 			
 			f3 position = bone.position;
 			rotation::quaternion rotation = bone.rotation;
@@ -70,7 +82,12 @@ namespace ik {
 			rotation::quaternion difference = rotation::fromTo(toChild, toDesiredPosition);
 			// add this rotation to the bone
 			this->localBoneChain[boneIndex].rotation = difference * this->localBoneChain[boneIndex].rotation;
+			// the bone's new model space transform is the parent of the next bone
+			bone.rotation = difference * bone.rotation;
+			this->modelBoneChain[boneIndex] = bone;
+			bone = transforms::combine(bone, this->localBoneChain[boneIndex + 1]);
 		}
+		this->modelBoneChain[numbBones - 1] = bone;
 	}
 
 	void FABRIKSolver::BallSocketConstraint(unsigned int boneIndex, float limitRadians) {
@@ -80,10 +97,13 @@ namespace ik {
 		if (boneIndex == 0) { return; }
 		const f3 forward(0.0f, 0.0f, 1.0f);
 		
-		rotation::quaternion parentRotation = this->GetBone(boneIndex - 1).rotation;
+		const transforms::srt& parentBone = this->modelBoneChain[boneIndex - 1];
+		rotation::quaternion parentRotation = parentBone.rotation;
 		f3 parentDirection = parentRotation * forward;
 		
-		rotation::quaternion rotation = this->GetBone(boneIndex).rotation;
+		transforms::srt& bone = this->modelBoneChain[boneIndex];
+		bone = transforms::combine(parentBone, this->localBoneChain[boneIndex]);
+		rotation::quaternion rotation = bone.rotation;
 		f3 direction = rotation * forward;
 
 		float angle = ::angle(parentDirection, direction);
@@ -92,17 +112,20 @@ namespace ik {
 			f3 correction = ::cross(parentDirection, direction);
 			rotation::quaternion rotationModelSpace = parentRotation * rotation::angleAxis(limitRadians, correction);
 			this->localBoneChain[boneIndex].rotation = rotationModelSpace * rotation::inverse(parentRotation);
+			bone = transforms::combine(parentBone, this->localBoneChain[boneIndex]);
 		}
 	}
 
 	void FABRIKSolver::HingeSocketConstraint(unsigned int boneIndex, f3 constraintAxis) {
 		if (boneIndex == 0) { return; }
-		transforms::srt bone = this->GetBone(boneIndex);
-		transforms::srt parentBone = this->GetBone(boneIndex - 1);
+		const transforms::srt& parentBone = this->modelBoneChain[boneIndex - 1];
+		transforms::srt& bone = this->modelBoneChain[boneIndex];
+		bone = transforms::combine(parentBone, this->localBoneChain[boneIndex]);
 		f3 hinge = bone.rotation * constraintAxis;
 		f3 desiredHinge = parentBone.rotation * constraintAxis;
 		this->localBoneChain[boneIndex].rotation = 
 			this->localBoneChain[boneIndex].rotation * rotation::fromTo(hinge, desiredHinge);
+		bone = transforms::combine(parentBone, this->localBoneChain[boneIndex]);
 	}
 
 	FABRIKSolver::FABRIKSolver() {
@@ -110,12 +133,17 @@ namespace ik {
 		constexpr float defaultThreshold = 0.0001f;
 		this->iterMaxSteps = defaultIterCount;
 		this->solveThreshold = defaultThreshold;
+		this->budget = NULL;
+		this->lastIterations = 0;
+		this->lastError = 0.0f;
+		this->stats = NULL;
 	}
 
 	unsigned int FABRIKSolver::ChainSize() { return this->localBoneChain.size(); }
 
 	void FABRIKSolver::ResizeChain(unsigned int size) {
 		this->localBoneChain.resize(size);
+		this->modelBoneChain.resize(size);
 		this->bonePosChain.resize(size);
 		this->boneLengths.resize(size);
 	}
@@ -149,23 +177,36 @@ namespace ik {
 
 	bool FABRIKSolver::SolveChain(const transforms::srt& target) {
 		unsigned int numbBones = this->ChainSize();
+		this->lastIterations = 0;
+		this->lastError = 0.0f;
 		if (numbBones < 2) { return false; /* not enough bones to run the algorithm */ }
 
+		std::chrono::steady_clock::time_point start;
+		if (this->stats != NULL) { start = std::chrono::steady_clock::now(); }
+
 		unsigned int effectorIndex = numbBones - 1;
 		float threshSq = this->solveThreshold * this->solveThreshold;
 
+		this->warmStart.Begin(this->localBoneChain);
 		this->ToChainPosition();
 		f3 targetPos = target.position;
 		f3 rootBonePos = this->bonePosChain[0];
 
+		bool isSolved = false;
+		bool budgetSpent = false;
 		for (unsigned int iter = 0; iter < this->iterMaxSteps; iter++) {
 			f3 currEffectorPos = this->bonePosChain[effectorIndex];
 			if (lengthSquared(targetPos - currEffectorPos) < threshSq) {
-				this->ChainPositionToLocalBone();
-				return true;
+				isSolved = true;
+				break;
+			}
+			if (this->budget != NULL && !this->budget->Take()) {
+				budgetSpent = true;
+				break;
 			}
 			this->Forward(targetPos);
 			this->Backward(rootBonePos);
+			this->lastIterations++;
 			// CONSTRAINTS APPLIED AFTER ITERATION 
 			// Convert model space bone chain back to local bone space before applying constraints
 			// this->ChainPositionToLocalBone();
@@ -175,8 +216,51 @@ namespace ik {
 		}
 
 		this->ChainPositionToLocalBone();
-		f3 effectorPos = this->GetBone(effectorIndex).position;
-		return lengthSquared(targetPos - effectorPos) < threshSq;
+		this->warmStart.End(this->localBoneChain);
+		f3 effectorPos = this->modelBoneChain[effectorIndex].position;
+		float errorSq = lengthSquared(targetPos - effectorPos);
+		this->lastError = sqrtf(errorSq);
+		isSolved = isSolved || errorSq < threshSq;
+		if (this->stats != NULL) {
+			std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+			SolveEnd end = isSolved ? SolveEnd::Reached : (budgetSpent ? SolveEnd::Budget : SolveEnd::MaxSteps);
+			this->stats->Record(this->lastIterations, this->iterMaxSteps, end, this->lastError, seconds.count());
+		}
+		return isSolved;
+	}
+
+	WarmStart& FABRIKSolver::GetWarmStart() { return this->warmStart; }
+
+	void FABRIKSolver::SetIterationBudget(IterationBudget* budget) {
+		this->budget = budget;
+	}
+
+	IterationBudget* FABRIKSolver::GetIterationBudget() { return this->budget; }
+
+	void FABRIKSolver::SetStats(SolverStats* stats) {
+		this->stats = stats;
+	}
+
+	SolverStats* FABRIKSolver::GetStats() { return this->stats; }
+
+	unsigned int FABRIKSolver::GetLastIterations() { return this->lastIterations; }
+
+	float FABRIKSolver::GetLastError() { return this->lastError; }
+
+	void FABRIKSolver::GetChainPositions(f3* positionsOut) {
+		this->ToChainPosition();
+		unsigned int numbBones = this->ChainSize();
+		for (unsigned int boneIndex = 0; boneIndex < numbBones; boneIndex++) {
+			positionsOut[boneIndex] = this->bonePosChain[boneIndex];
+		}
+	}
+
+	void FABRIKSolver::SetChainPositions(const f3* positions) {
+		unsigned int numbBones = this->ChainSize();
+		for (unsigned int boneIndex = 0; boneIndex < numbBones; boneIndex++) {
+			this->bonePosChain[boneIndex] = positions[boneIndex];
+		}
+		this->ChainPositionToLocalBone();
 	}
 
 }
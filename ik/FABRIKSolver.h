@@ -2,6 +2,9 @@
 
 #include <vector>
 #include "../transforms/srt.h"
+#include "IterationBudget.h"
+#include "WarmStart.h"
+#include "SolverStats.h"
 
 namespace ik {
 
@@ -21,6 +24,12 @@ namespace ik {
 		/// </summary>
 		std::vector<transforms::srt> localBoneChain;
 
+		/// <summary>
+		/// localBoneChain in model space. Built with one pass down the chain that carries the parent's model space transform,
+		/// instead of combining the chain from the root for every bone.
+		/// </summary>
+		std::vector<transforms::srt> modelBoneChain;
+
 		/// <summary>
 		/// The model space bone chain, but as positions. Local model space.
 		/// FABRIK uses position data instead of rotation, so we need a second copy of the chain.
@@ -42,10 +51,38 @@ namespace ik {
 		/// the solver will accept the current solution and return early.
 		/// </summary>
 		float solveThreshold;
+
+		/// <summary>
+		/// Carries the last solve's answer over to the next solve, off by default
+		/// </summary>
+		WarmStart warmStart;
+
+		/// <summary>
+		/// Shared with other solvers, NULL if the solver is only limited by iterMaxSteps. Not owned by the solver.
+		/// </summary>
+		IterationBudget* budget;
+
+		/// <summary>
+		/// What the last solve did, see GetLastIterations and GetLastError
+		/// </summary>
+		unsigned int lastIterations;
+		float lastError;
+
+		/// <summary>
+		/// Every solve is recorded here when it isn't NULL. Not owned by the solver.
+		/// </summary>
+		SolverStats* stats;
 	protected:
 
+		/// <summary>
+		/// Combine localBoneChain into modelBoneChain, only when a solve starts (see ToChainPosition).
+		/// After that ChainPositionToLocalBone and the constraints write each bone's model space transform as they change it.
+		/// </summary>
+		void UpdateModelChain();
+
 		/// <summary>
 		/// Converts the local bone space chain to model space positions and writes the result to bonePosChain.
+		/// Also rebuilds modelBoneChain.
 		/// </summary>
 		void ToChainPosition();
 
@@ -79,6 +116,7 @@ namespace ik {
 
 		/// <summary>
 		/// Converts the model space bone position chain back into local bone space SRT chain.
+		/// One pass from the root, each bone is rotated after its parent, so modelBoneChain is up to date afterwards.
 		/// </summary>
 		void ChainPositionToLocalBone();
 
@@ -86,6 +124,9 @@ namespace ik {
 		// We will include it anyway for FABRIK solver for the sake of completeness. The book author's constraint code also 
 		// refers member fields that don't exist in the IK solver classes, not sure what's going on with that.
 
+		// The constraints read the parent's transform from modelBoneChain and refresh the bone's own entry, so applying them
+		// from the root down after UpdateModelChain keeps the cache correct without recombining the chain.
+
 		/// <summary>
 		/// Apply a ball and socket rotation constraint to a bone in the IK chain
 		/// </summary>
@@ -172,5 +213,49 @@ namespace ik {
 		/// <param name="target">The model space location that the IK solver should try to move the end effector to</param>
 		/// <returns>True if the end effector was able to reach the target</returns>
 		bool SolveChain(const transforms::srt& target);
+
+		/// <summary>
+		/// Start each solve from the last solve's answer, see WarmStart. For chains that are set from an animated pose before every solve.
+		/// </summary>
+		WarmStart& GetWarmStart();
+
+		/// <summary>
+		/// Share an iteration budget with other solvers, each iteration takes one from it and the solve stops when it is spent.
+		/// iterMaxSteps still limits each solve on its own.
+		/// </summary>
+		/// <param name="budget">Not owned by the solver, NULL to only use iterMaxSteps</param>
+		void SetIterationBudget(IterationBudget* budget);
+		IterationBudget* GetIterationBudget();
+
+		/// <summary>
+		/// Record the iterations, residual distance and time of every solve, to tune iterMaxSteps and solveThreshold.
+		/// Solves are only timed while stats are set.
+		/// </summary>
+		/// <param name="stats">Not owned by the solver, NULL to stop recording</param>
+		void SetStats(SolverStats* stats);
+		SolverStats* GetStats();
+
+		/// <summary>
+		/// The number of iterations the last solve ran, 0 if the end effector was already on the target.
+		/// </summary>
+		unsigned int GetLastIterations();
+
+		/// <summary>
+		/// The distance between the end effector and the target after the last solve
+		/// </summary>
+		float GetLastError();
+
+		/// <summary>
+		/// Model space positions of the chain's bones, e.g. to solve many chains together in a FABRIKBatch.
+		/// </summary>
+		/// <param name="positionsOut">One position per bone in the chain</param>
+		void GetChainPositions(f3* positionsOut);
+
+		/// <summary>
+		/// Rotate the chain's bones so they point at solved model space positions, e.g. the result of a FABRIKBatch.
+		/// The bone lengths are kept, only the direction from each bone to its child is used.
+		/// </summary>
+		/// <param name="positions">One position per bone in the chain</param>
+		void SetChainPositions(const f3* positions);
 	};
 }
@@ -0,0 +1,29 @@
+#include "IterationBudget.h"
+
+namespace ik {
+
+	IterationBudget::IterationBudget() : remaining(0), numbRefused(0) { }
+
+	IterationBudget::IterationBudget(unsigned int numbIterations) : remaining((int) numbIterations), numbRefused(0) { }
+
+	void IterationBudget::Reset(unsigned int numbIterations) {
+		this->remaining.store((int) numbIterations, std::memory_order_relaxed);
+		this->numbRefused.store(0, std::memory_order_relaxed);
+	}
+
+	bool IterationBudget::Take() {
+		// remaining can go below zero while several threads are refused at once, Remaining clamps it
+		if (this->remaining.fetch_sub(1, std::memory_order_relaxed) > 0) { return true; }
+		this->numbRefused.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	unsigned int IterationBudget::Remaining() const {
+		int left = this->remaining.load(std::memory_order_relaxed);
+		return left > 0 ? (unsigned int) left : 0;
+	}
+
+	unsigned int IterationBudget::NumbRefused() const {
+		return this->numbRefused.load(std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+
+namespace ik {
+
+	/// <summary>
+	/// A number of solver iterations shared by many IK solves, e.g. every character's IK in a frame.
+	/// Solvers given a budget take one iteration from it before each iteration they run, and stop early once it is spent,
+	/// so a frame with many hard to reach targets can't blow the frame time. Safe to share between threads.
+	/// </summary>
+	class IterationBudget {
+	protected:
+		std::atomic<int> remaining;
+		std::atomic<unsigned int> numbRefused;
+	public:
+		/// <summary>
+		/// Create a budget with no iterations, call Reset before using it.
+		/// </summary>
+		IterationBudget();
+		/// <summary>
+		/// Create a budget with a number of iterations.
+		/// </summary>
+		IterationBudget(unsigned int numbIterations);
+		/// <summary>
+		/// Refill the budget, usually once per frame before any solves run.
+		/// </summary>
+		/// <param name="numbIterations"></param>
+		void Reset(unsigned int numbIterations);
+		/// <summary>
+		/// Take one iteration from the budget.
+		/// </summary>
+		/// <returns>False if the budget is spent, the solver should stop iterating</returns>
+		bool Take();
+		/// <summary>
+		/// The number of iterations left in the budget
+		/// </summary>
+		unsigned int Remaining() const;
+		/// <summary>
+		/// The number of iterations solvers asked for after the budget was spent, since the last Reset
+		/// </summary>
+		unsigned int NumbRefused() const;
+	};
+}
@@ -0,0 +1,344 @@
+#include "JacobianSolver.h"
+#include <cmath>
+#include <iostream>
+
+namespace ik {
+
+	typedef float SquareMatrix[JacobianSolver::MaxRows][JacobianSolver::MaxRows];
+
+	/// <summary>
+	/// Solve a * x = b in place for a symmetric positive definite n by n matrix, x is written over b.
+	/// Cholesky: a = L L^T, then two triangular solves. a's lower triangle is overwritten by L.
+	/// </summary>
+	/// <returns>False if a isn't positive definite</returns>
+	static bool CholeskySolve(SquareMatrix& a, float* b, unsigned int n) {
+		for (unsigned int col = 0; col < n; col++) {
+			float diagonal = a[col][col];
+			for (unsigned int k = 0; k < col; k++) { diagonal -= a[col][k] * a[col][k]; }
+			if (diagonal <= 0.0f) { return false; }
+			diagonal = sqrtf(diagonal);
+			a[col][col] = diagonal;
+			for (unsigned int row = col + 1; row < n; row++) {
+				float sum = a[row][col];
+				for (unsigned int k = 0; k < col; k++) { sum -= a[row][k] * a[col][k]; }
+				a[row][col] = sum / diagonal;
+			}
+		}
+		// L y = b
+		for (unsigned int row = 0; row < n; row++) {
+			float sum = b[row];
+			for (unsigned int k = 0; k < row; k++) { sum -= a[row][k] * b[k]; }
+			b[row] = sum / a[row][row];
+		}
+		// L^T x = y
+		for (int row = (int) n - 1; row >= 0; row--) {
+			float sum = b[row];
+			for (unsigned int k = row + 1; k < n; k++) { sum -= a[k][row] * b[k]; }
+			b[row] = sum / a[row][row];
+		}
+		return true;
+	}
+
+	JacobianSolver::JacobianSolver() {
+		constexpr unsigned int defaultIterCount = 20;
+		constexpr float defaultThreshold = 0.0001f;
+		constexpr float defaultDamping = 0.05f;
+		constexpr float defaultMaxStepAngle = 0.25f;
+		this->numbBones = 0;
+		this->numbEffectors = 0;
+		this->damping = defaultDamping;
+		this->maxStepAngle = defaultMaxStepAngle;
+		this->iterMaxSteps = defaultIterCount;
+		this->solveThreshold = defaultThreshold;
+		this->budget = NULL;
+		this->lastIterations = 0;
+		this->lastError = 0.0f;
+	}
+
+	bool JacobianSolver::SetBones(const anim::Pose& pose, unsigned int rootBone, const std::vector<unsigned int>& effectorBones) {
+		this->numbBones = 0;
+		this->numbEffectors = 0;
+		unsigned int numbEffectors = effectorBones.size();
+		if (numbEffectors == 0 || numbEffectors > MaxEffectors) {
+			std::cout << "jacobian solver needs 1 to " << MaxEffectors << " effectors, was given " << numbEffectors << "\n";
+			return false;
+		}
+		unsigned int depths[MaxBones];
+		unsigned int numbBones = 0;
+		for (unsigned int effector = 0; effector < numbEffectors; effector++) {
+			// walk up from the effector to the root, adding the bones that aren't in the branch yet
+			int bone = (int) effectorBones[effector];
+			unsigned int effectorDepth = 0;
+			for (int walk = bone; walk != (int) rootBone; walk = pose.ParentIndexOf(walk)) {
+				if (walk < 0) {
+					std::cout << "jacobian solver effector " << effectorBones[effector] << " is not below bone " << rootBone << "\n";
+					return false;
+				}
+				effectorDepth++;
+			}
+			for (unsigned int depth = effectorDepth + 1; depth > 0; depth--) {
+				bool isInBranch = false;
+				for (unsigned int slot = 0; slot < numbBones && !isInBranch; slot++) {
+					isInBranch = this->bones[slot] == (unsigned int) bone;
+				}
+				if (!isInBranch) {
+					if (numbBones == MaxBones) {
+						std::cout << "jacobian solver branch has more than " << MaxBones << " bones\n";
+						return false;
+					}
+					this->bones[numbBones] = bone;
+					depths[numbBones] = depth - 1;
+					numbBones++;
+				}
+				bone = pose.ParentIndexOf(bone);
+			}
+		}
+		// parents first, a bone is always one deeper than its parent
+		for (unsigned int i = 1; i < numbBones; i++) {
+			for (unsigned int j = i; j > 0 && depths[j - 1] > depths[j]; j--) {
+				unsigned int depth = depths[j]; depths[j] = depths[j - 1]; depths[j - 1] = depth;
+				unsigned int bone = this->bones[j]; this->bones[j] = this->bones[j - 1]; this->bones[j - 1] = bone;
+			}
+		}
+		for (unsigned int slot = 0; slot < numbBones; slot++) {
+			this->parentSlots[slot] = -1;
+			this->movesEffectors[slot] = 0;
+			int parent = slot == 0 ? -1 : pose.ParentIndexOf(this->bones[slot]);
+			for (unsigned int other = 0; other < slot; other++) {
+				if ((int) this->bones[other] == parent) { this->parentSlots[slot] = other; }
+			}
+		}
+		for (unsigned int effector = 0; effector < numbEffectors; effector++) {
+			for (unsigned int slot = 0; slot < numbBones; slot++) {
+				if (this->bones[slot] == effectorBones[effector]) { this->effectorSlots[effector] = slot; }
+			}
+			// every bone above the effector swings it, the effector's own rotation doesn't move it
+			for (int slot = this->parentSlots[this->effectorSlots[effector]]; slot >= 0; slot = this->parentSlots[slot]) {
+				this->movesEffectors[slot] |= 1 << effector;
+			}
+			this->targets[effector] = f3();
+			this->weights[effector] = 1.0f;
+		}
+		this->numbBones = numbBones;
+		this->numbEffectors = numbEffectors;
+		return true;
+	}
+
+	unsigned int JacobianSolver::NumbBones() { return this->numbBones; }
+
+	unsigned int JacobianSolver::NumbEffectors() { return this->numbEffectors; }
+
+	void JacobianSolver::SetTarget(unsigned int effector, const f3& target) {
+		this->targets[effector] = target;
+	}
+
+	f3 JacobianSolver::GetTarget(unsigned int effector) { return this->targets[effector]; }
+
+	void JacobianSolver::SetWeight(unsigned int effector, float weight) {
+		this->weights[effector] = weight < 0.0f ? 0.0f : weight;
+	}
+
+	float JacobianSolver::GetWeight(unsigned int effector) { return this->weights[effector]; }
+
+	void JacobianSolver::SetDamping(float damping) {
+		this->damping = damping;
+	}
+
+	float JacobianSolver::GetDamping() { return this->damping; }
+
+	void JacobianSolver::SetMaxStepAngle(float radians) {
+		this->maxStepAngle = radians;
+	}
+
+	float JacobianSolver::GetMaxStepAngle() { return this->maxStepAngle; }
+
+	unsigned int JacobianSolver::GetIterMaxSteps() { return this->iterMaxSteps; }
+
+	void JacobianSolver::SetIterMaxSteps(unsigned int numbSteps) {
+		this->iterMaxSteps = numbSteps;
+	}
+
+	float JacobianSolver::GetSolveThreshold() { return this->solveThreshold; }
+
+	void JacobianSolver::SetSolveThreshold(float threshold) {
+		this->solveThreshold = threshold;
+	}
+
+	void JacobianSolver::SetIterationBudget(IterationBudget* budget) {
+		this->budget = budget;
+	}
+
+	unsigned int JacobianSolver::GetLastIterations() { return this->lastIterations; }
+
+	float JacobianSolver::GetLastError() { return this->lastError; }
+
+	void JacobianSolver::UpdateModelBones() {
+		for (unsigned int slot = 0; slot < this->numbBones; slot++) {
+			int parent = this->parentSlots[slot];
+			const transforms::srt& parentBone = parent >= 0 ? this->modelBones[parent] : this->rootParent;
+			this->modelBones[slot] = transforms::combine(parentBone, this->localBones[slot]);
+		}
+	}
+
+	float JacobianSolver::UpdateErrors(float& weightedErrorSq) {
+		float largestError = 0.0f;
+		weightedErrorSq = 0.0f;
+		for (unsigned int effector = 0; effector < this->numbEffectors; effector++) {
+			f3 offset = this->targets[effector] - this->modelBones[this->effectorSlots[effector]].position;
+			// rows are scaled by sqrt(weight), so the least squares error of each effector is scaled by its weight
+			float rowScale = sqrtf(this->weights[effector]);
+			this->errors[effector * 3 + 0] = offset.x * rowScale;
+			this->errors[effector * 3 + 1] = offset.y * rowScale;
+			this->errors[effector * 3 + 2] = offset.z * rowScale;
+			float errorSq = lengthSquared(offset);
+			weightedErrorSq += errorSq * this->weights[effector];
+			if (this->weights[effector] > 0.0f) {
+				float error = sqrtf(errorSq);
+				if (error > largestError) { largestError = error; }
+			}
+		}
+		return largestError;
+	}
+
+	void JacobianSolver::UpdateJacobian() {
+		for (unsigned int effector = 0; effector < this->numbEffectors; effector++) {
+			float rowScale = sqrtf(this->weights[effector]);
+			f3 effectorPos = this->modelBones[this->effectorSlots[effector]].position;
+			float* rowX = this->jacobian[effector * 3 + 0];
+			float* rowY = this->jacobian[effector * 3 + 1];
+			float* rowZ = this->jacobian[effector * 3 + 2];
+			for (unsigned int slot = 0; slot < this->numbBones; slot++) {
+				unsigned int col = slot * 3;
+				if ((this->movesEffectors[slot] & (1 << effector)) == 0) {
+					for (unsigned int axis = 0; axis < 3; axis++) { rowX[col + axis] = rowY[col + axis] = rowZ[col + axis] = 0.0f; }
+					continue;
+				}
+				// rotating about an axis through the joint moves the effector along axis x (effector - joint)
+				f3 r = (effectorPos - this->modelBones[slot].position) * rowScale;
+				rowX[col + 0] = 0.0f;  rowY[col + 0] = -r.z;  rowZ[col + 0] = r.y;
+				rowX[col + 1] = r.z;   rowY[col + 1] = 0.0f;  rowZ[col + 1] = -r.x;
+				rowX[col + 2] = -r.y;  rowY[col + 2] = r.x;   rowZ[col + 2] = 0.0f;
+			}
+		}
+	}
+
+	bool JacobianSolver::SolveAngles(float damping) {
+		unsigned int numbRows = this->numbEffectors * 3;
+		unsigned int numbColumns = this->numbBones * 3;
+		// (J J^T + damping^2 I) y = error, the matrix is only rows x rows (12 x 12 at most) however many bones there are
+		SquareMatrix a;
+		float dampingSq = damping * damping;
+		for (unsigned int row = 0; row < numbRows; row++) {
+			for (unsigned int other = 0; other <= row; other++) {
+				// only bones that move both effectors add to the sum, e.g. the spine for two hands
+				unsigned int sharedMask = (1 << (row / 3)) | (1 << (other / 3));
+				float sum = 0.0f;
+				for (unsigned int slot = 0; slot < this->numbBones; slot++) {
+					if ((this->movesEffectors[slot] & sharedMask) != sharedMask) { continue; }
+					unsigned int col = slot * 3;
+					sum += this->jacobian[row][col] * this->jacobian[other][col]
+						+ this->jacobian[row][col + 1] * this->jacobian[other][col + 1]
+						+ this->jacobian[row][col + 2] * this->jacobian[other][col + 2];
+				}
+				a[row][other] = sum;
+			}
+			a[row][row] += dampingSq;
+		}
+		float y[MaxRows];
+		for (unsigned int row = 0; row < numbRows; row++) { y[row] = this->errors[row]; }
+		if (!CholeskySolve(a, y, numbRows)) {
+			// only happens with no damping at a singular pose
+			for (unsigned int col = 0; col < numbColumns; col++) { this->angles[col] = 0.0f; }
+			return false;
+		}
+		// angles = J^T y, the rows of effectors a bone doesn't move are zero
+		for (unsigned int slot = 0; slot < this->numbBones; slot++) {
+			for (unsigned int col = slot * 3; col < slot * 3 + 3; col++) {
+				float sum = 0.0f;
+				for (unsigned int row = 0; row < numbRows; row++) {
+					if (this->movesEffectors[slot] & (1 << (row / 3))) { sum += this->jacobian[row][col] * y[row]; }
+				}
+				this->angles[col] = sum;
+			}
+		}
+		return true;
+	}
+
+	void JacobianSolver::ApplyAngles() {
+		for (unsigned int slot = 0; slot < this->numbBones; slot++) {
+			if (this->movesEffectors[slot] == 0) { continue; }
+			f3 axis(this->angles[slot * 3 + 0], this->angles[slot * 3 + 1], this->angles[slot * 3 + 2]);
+			// not length(), it rounds vectors shorter than about 0.003 to zero and the small steps near the target would be lost
+			float angle = sqrtf(lengthSquared(axis));
+			if (angle <= 0.0f) { continue; }
+			axis = axis * (1.0f / angle);
+			if (angle > this->maxStepAngle) { angle = this->maxStepAngle; }
+			// a model space rotation about the joint, converted into the bone's local space like CCDSolver does
+			rotation::quaternion modelRotation = this->modelBones[slot].rotation;
+			rotation::quaternion localRotation = modelRotation * rotation::angleAxis(angle, axis) * rotation::inverse(modelRotation);
+			transforms::srt& bone = this->localBones[slot];
+			bone.rotation = rotation::normalized(localRotation * bone.rotation);
+		}
+	}
+
+	bool JacobianSolver::Solve(anim::Pose& pose) {
+		this->lastIterations = 0;
+		this->lastError = 0.0f;
+		if (this->numbBones == 0) { return false; }
+		for (unsigned int slot = 0; slot < this->numbBones; slot++) {
+			this->localBones[slot] = pose.GetLocalTransform(this->bones[slot]);
+		}
+		int rootParentBone = pose.ParentIndexOf(this->bones[0]);
+		this->rootParent = rootParentBone >= 0 ? pose.GetWorldTransform(rootParentBone) : transforms::srt();
+
+		// damping goes up while steps make the error worse and back down while they make it better
+		constexpr float dampingGrowth = 2.0f;
+		constexpr float maxDamping = 1000000.0f;
+		float damping = this->damping;
+		float weightedErrorSq = 0.0f;
+		this->UpdateModelBones();
+		this->lastError = this->UpdateErrors(weightedErrorSq);
+		bool isSolved = false;
+		for (unsigned int iter = 0; ; iter++) {
+			if (this->lastError < this->solveThreshold) {
+				isSolved = true;
+				break;
+			}
+			if (iter == this->iterMaxSteps) { break; }
+			if (this->budget != NULL && !this->budget->Take()) { break; }
+			this->lastIterations++;
+			this->UpdateJacobian();
+			if (!this->SolveAngles(damping)) {
+				damping = damping > 0.0f ? damping * dampingGrowth : this->solveThreshold;
+				continue;
+			}
+			for (unsigned int slot = 0; slot < this->numbBones; slot++) {
+				this->previousLocalBones[slot] = this->localBones[slot];
+				this->previousModelBones[slot] = this->modelBones[slot];
+			}
+			for (unsigned int row = 0; row < this->numbEffectors * 3; row++) { this->previousErrors[row] = this->errors[row]; }
+			this->ApplyAngles();
+			this->UpdateModelBones();
+			float stepErrorSq = 0.0f;
+			float stepError = this->UpdateErrors(stepErrorSq);
+			if (stepErrorSq > weightedErrorSq) {
+				// the linear guess overshot, take the step back and try a shorter one
+				for (unsigned int slot = 0; slot < this->numbBones; slot++) {
+					this->localBones[slot] = this->previousLocalBones[slot];
+					this->modelBones[slot] = this->previousModelBones[slot];
+				}
+				for (unsigned int row = 0; row < this->numbEffectors * 3; row++) { this->errors[row] = this->previousErrors[row]; }
+				if (damping < maxDamping) { damping = damping > 0.0f ? damping * dampingGrowth : this->solveThreshold; }
+				continue;
+			}
+			weightedErrorSq = stepErrorSq;
+			this->lastError = stepError;
+			damping = damping / dampingGrowth > this->damping ? damping / dampingGrowth : this->damping;
+		}
+
+		for (unsigned int slot = 0; slot < this->numbBones; slot++) {
+			pose.SetLocalTransform(this->bones[slot], this->localBones[slot]);
+		}
+		return isSolved;
+	}
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <vector>
+#include "../transforms/srt.h"
+#include "../animation/Pose.h"
+#include "IterationBudget.h"
+
+namespace ik {
+
+	/// <summary>
+	/// Damped Least Squares Jacobian Inverse Kinematic Solver for a branch of a pose with several end effectors, e.g. both hands on a wall
+	/// and both feet on the ground. All effectors are solved together, so effectors that share joints (a spine) don't undo
+	/// each other's work like separate CCD and FABRIK solves do. Each effector has a weight that decides which one wins
+	/// when they can't all be reached.
+	/// Every joint rotates about the model space x, y and z axes through its position. Positions only, effector orientation is not solved.
+	/// Each iteration moves the joints by J^T (J J^T + damping^2 I)^-1 error. A step that makes the weighted error worse is taken back and
+	/// retried with more damping (Levenberg-Marquardt), so targets that can't be reached don't make the pose oscillate.
+	/// The matrices have a fixed maximum size and live inside the solver, so solving doesn't allocate.
+	/// Not used by AnimGraph, whose IK nodes solve one chain towards one target. Run it on the graph's output pose instead.
+	/// </summary>
+	class JacobianSolver {
+	public:
+		static constexpr unsigned int MaxEffectors = 4;
+		static constexpr unsigned int MaxBones = 32;
+		static constexpr unsigned int MaxRows = MaxEffectors * 3;
+		static constexpr unsigned int MaxColumns = MaxBones * 3;
+	protected:
+		/// <summary>
+		/// The bones being solved, parents before their children: every bone on the way from the root to an effector.
+		/// bones[0] is the root.
+		/// </summary>
+		unsigned int bones[MaxBones];
+		/// <summary>
+		/// Index into bones of each bone's parent, -1 for the root
+		/// </summary>
+		int parentSlots[MaxBones];
+		/// <summary>
+		/// Bit 'e' is set if the bone is the parent, grand parent... of effector 'e'. Only these bones can move the effector.
+		/// </summary>
+		unsigned int movesEffectors[MaxBones];
+		unsigned int numbBones;
+		/// <summary>
+		/// Index into bones of each effector
+		/// </summary>
+		unsigned int effectorSlots[MaxEffectors];
+		f3 targets[MaxEffectors];
+		float weights[MaxEffectors];
+		unsigned int numbEffectors;
+		/// <summary>
+		/// The bones read from the pose, solved in place then written back
+		/// </summary>
+		transforms::srt localBones[MaxBones];
+		transforms::srt modelBones[MaxBones];
+		/// <summary>
+		/// The bones before the last step, to take the step back if it made the error worse
+		/// </summary>
+		transforms::srt previousLocalBones[MaxBones];
+		transforms::srt previousModelBones[MaxBones];
+		/// <summary>
+		/// The root's parent in model space, the solve doesn't move it
+		/// </summary>
+		transforms::srt rootParent;
+		/// <summary>
+		/// Row major, rows are effector x, y, z, columns are each bone's rotation about x, y and z. numbEffectors * 3 by numbBones * 3.
+		/// </summary>
+		float jacobian[MaxRows][MaxColumns];
+		float errors[MaxRows];
+		float previousErrors[MaxRows];
+		float angles[MaxColumns];
+		/// <summary>
+		/// Lambda of damped least squares, bigger is steadier but slower to converge. In the pose's distance units.
+		/// The smallest damping used, the solve raises it while steps keep making the error worse.
+		/// </summary>
+		float damping;
+		/// <summary>
+		/// The most a bone can rotate in one iteration, in radians. Keeps big errors from flinging the pose around.
+		/// </summary>
+		float maxStepAngle;
+		unsigned int iterMaxSteps;
+		/// <summary>
+		/// The solve is done when every weighted effector is within this distance of its target.
+		/// </summary>
+		float solveThreshold;
+		/// <summary>
+		/// Shared with other solvers, NULL if the solver is only limited by iterMaxSteps. Not owned by the solver.
+		/// </summary>
+		IterationBudget* budget;
+		unsigned int lastIterations;
+		float lastError;
+	protected:
+		/// <summary>
+		/// Rebuilds modelBones from localBones, parents first.
+		/// </summary>
+		void UpdateModelBones();
+		/// <summary>
+		/// Fill errors with each effector's weighted offset to its target.
+		/// </summary>
+		/// <param name="weightedErrorSq">Sum of each effector's squared distance to its target times its weight, what the solve minimizes</param>
+		/// <returns>The largest distance between a weighted effector and its target</returns>
+		float UpdateErrors(float& weightedErrorSq);
+		void UpdateJacobian();
+		/// <summary>
+		/// Turn errors into the joint rotations in angles, angles = J^T (J J^T + damping^2 I)^-1 errors
+		/// </summary>
+		/// <returns>False if the matrix couldn't be inverted, angles is left at zero</returns>
+		bool SolveAngles(float damping);
+		/// <summary>
+		/// Rotate each bone by its three angles about the model space axes.
+		/// </summary>
+		void ApplyAngles();
+	public:
+		/// <summary>
+		/// Create a solver with no bones, default iteration steps, damping and solution threshold.
+		/// </summary>
+		JacobianSolver();
+		/// <summary>
+		/// Choose the branch of the pose to solve. Bones from rootBone down to each effector are rotated, other bones are left alone.
+		/// </summary>
+		/// <param name="pose">Only its hierarchy is read, any pose of the same armature can be solved afterwards</param>
+		/// <param name="rootBone">The highest bone the solve rotates, e.g. the hips or the lowest spine bone</param>
+		/// <param name="effectorBones">Up to MaxEffectors bones below rootBone that should reach targets, e.g. hands and feet</param>
+		/// <returns>False if an effector isn't below rootBone or the branch has too many bones, the solver is left empty</returns>
+		bool SetBones(const anim::Pose& pose, unsigned int rootBone, const std::vector<unsigned int>& effectorBones);
+		unsigned int NumbBones();
+		unsigned int NumbEffectors();
+		/// <summary>
+		/// Set the model space position an effector should reach.
+		/// </summary>
+		/// <param name="effector">Index into the effectorBones given to SetBones</param>
+		void SetTarget(unsigned int effector, const f3& target);
+		f3 GetTarget(unsigned int effector);
+		/// <summary>
+		/// How much an effector counts when not every effector can reach its target. 0 turns the effector off, default 1.
+		/// </summary>
+		void SetWeight(unsigned int effector, float weight);
+		float GetWeight(unsigned int effector);
+		void SetDamping(float damping);
+		float GetDamping();
+		void SetMaxStepAngle(float radians);
+		float GetMaxStepAngle();
+		unsigned int GetIterMaxSteps();
+		void SetIterMaxSteps(unsigned int numbSteps);
+		float GetSolveThreshold();
+		void SetSolveThreshold(float threshold);
+		/// <summary>
+		/// Share an iteration budget with other solvers, see IterationBudget.
+		/// </summary>
+		/// <param name="budget">Not owned by the solver, NULL to only use iterMaxSteps</param>
+		void SetIterationBudget(IterationBudget* budget);
+		/// <summary>
+		/// The number of iterations the last solve ran, including steps that were taken back
+		/// </summary>
+		unsigned int GetLastIterations();
+		/// <summary>
+		/// The largest distance between a weighted effector and its target after the last solve
+		/// </summary>
+		float GetLastError();
+		/// <summary>
+		/// Rotate the branch's bones so the effectors reach their targets, the solved rotations are written into the pose.
+		/// </summary>
+		/// <param name="pose">A pose with the hierarchy given to SetBones, in model space</param>
+		/// <returns>True if every weighted effector reached its target</returns>
+		bool Solve(anim::Pose& pose);
+	};
+}
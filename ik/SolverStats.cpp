@@ -0,0 +1,190 @@
+#include "SolverStats.h"
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+namespace ik {
+
+	LogHistogram::LogHistogram() : LogHistogram(1.0f, 1, 1) { }
+
+	LogHistogram::LogHistogram(float smallest, unsigned int numbDecades, unsigned int bucketsPerDecade) {
+		this->smallest = smallest;
+		this->bucketsPerDecade = bucketsPerDecade;
+		// one bucket below smallest and one above the last decade
+		this->counts.resize(numbDecades * bucketsPerDecade + 2, 0);
+	}
+
+	void LogHistogram::Add(float value) {
+		unsigned int bucket = 0;
+		if (value >= this->smallest) {
+			float decades = log10f(value / this->smallest);
+			bucket = (unsigned int)(decades * (float) this->bucketsPerDecade) + 1;
+			unsigned int last = this->NumbBuckets() - 1;
+			if (bucket > last) { bucket = last; }
+		}
+		this->counts[bucket]++;
+	}
+
+	void LogHistogram::Merge(const LogHistogram& other) {
+		if (other.counts.size() != this->counts.size() || other.smallest != this->smallest || other.bucketsPerDecade != this->bucketsPerDecade) {
+			std::cout << "can't merge histograms with different buckets\n";
+			return;
+		}
+		for (unsigned int i = 0; i < this->counts.size(); i++) {
+			this->counts[i] += other.counts[i];
+		}
+	}
+
+	void LogHistogram::Clear() {
+		for (unsigned int& count : this->counts) { count = 0; }
+	}
+
+	unsigned int LogHistogram::NumbBuckets() const { return this->counts.size(); }
+
+	unsigned int LogHistogram::GetCount(unsigned int bucket) const { return this->counts[bucket]; }
+
+	float LogHistogram::GetLower(unsigned int bucket) const {
+		if (bucket == 0) { return 0.0f; }
+		return this->smallest * powf(10.0f, (float)(bucket - 1) / (float) this->bucketsPerDecade);
+	}
+
+	float LogHistogram::GetUpper(unsigned int bucket) const {
+		if (bucket + 1 >= this->NumbBuckets()) { return -1.0f; }
+		return this->smallest * powf(10.0f, (float) bucket / (float) this->bucketsPerDecade);
+	}
+
+	SolverStats::SolverStats() :
+		// 1e-7 to 100 units of distance, 0.1 microseconds to 1 second, 4 buckets per power of ten
+		residuals(1e-7f, 9, 4), times(1e-7f, 7, 4) {
+		this->iterationCounts.resize(MaxIterationBucket + 1, 0);
+		this->Clear();
+	}
+
+	void SolverStats::Record(unsigned int iterations, unsigned int iterMaxSteps, SolveEnd end, float residual, double seconds) {
+		unsigned int bucket = iterations < MaxIterationBucket ? iterations : MaxIterationBucket;
+		this->iterationCounts[bucket]++;
+		this->residuals.Add(residual);
+		this->times.Add((float) seconds);
+		this->numbSolves++;
+		switch (end) {
+		case SolveEnd::Reached:
+			this->numbReached++;
+			if (iterations < iterMaxSteps) { this->numbEarlyExits++; }
+			break;
+		case SolveEnd::MaxSteps:
+			this->numbMaxSteps++;
+			break;
+		case SolveEnd::Budget:
+			this->numbBudgetStops++;
+			break;
+		}
+		this->totalIterations += iterations;
+		this->totalSeconds += seconds;
+		if (residual > this->largestResidual) { this->largestResidual = residual; }
+	}
+
+	void SolverStats::Merge(const SolverStats& other) {
+		for (unsigned int i = 0; i < this->iterationCounts.size(); i++) {
+			this->iterationCounts[i] += other.iterationCounts[i];
+		}
+		this->residuals.Merge(other.residuals);
+		this->times.Merge(other.times);
+		this->numbSolves += other.numbSolves;
+		this->numbReached += other.numbReached;
+		this->numbEarlyExits += other.numbEarlyExits;
+		this->numbMaxSteps += other.numbMaxSteps;
+		this->numbBudgetStops += other.numbBudgetStops;
+		this->totalIterations += other.totalIterations;
+		this->totalSeconds += other.totalSeconds;
+		if (other.largestResidual > this->largestResidual) { this->largestResidual = other.largestResidual; }
+	}
+
+	void SolverStats::Clear() {
+		for (unsigned int& count : this->iterationCounts) { count = 0; }
+		this->residuals.Clear();
+		this->times.Clear();
+		this->numbSolves = 0;
+		this->numbReached = 0;
+		this->numbEarlyExits = 0;
+		this->numbMaxSteps = 0;
+		this->numbBudgetStops = 0;
+		this->totalIterations = 0;
+		this->totalSeconds = 0.0;
+		this->largestResidual = 0.0f;
+	}
+
+	unsigned int SolverStats::NumbSolves() const { return this->numbSolves; }
+
+	unsigned int SolverStats::NumbReached() const { return this->numbReached; }
+
+	unsigned int SolverStats::NumbEarlyExits() const { return this->numbEarlyExits; }
+
+	unsigned int SolverStats::NumbMaxSteps() const { return this->numbMaxSteps; }
+
+	unsigned int SolverStats::NumbBudgetStops() const { return this->numbBudgetStops; }
+
+	float SolverStats::GetAverageIterations() const {
+		if (this->numbSolves == 0) { return 0.0f; }
+		return (float)((double) this->totalIterations / (double) this->numbSolves);
+	}
+
+	double SolverStats::GetAverageTime() const {
+		if (this->numbSolves == 0) { return 0.0; }
+		return this->totalSeconds / (double) this->numbSolves;
+	}
+
+	float SolverStats::GetLargestResidual() const { return this->largestResidual; }
+
+	const std::vector<unsigned int>& SolverStats::GetIterationHistogram() const { return this->iterationCounts; }
+
+	const LogHistogram& SolverStats::GetResidualHistogram() const { return this->residuals; }
+
+	const LogHistogram& SolverStats::GetTimeHistogram() const { return this->times; }
+
+	namespace {
+		void WriteHistogram(std::ostream& out, const char* metric, const LogHistogram& histogram, float scale) {
+			unsigned int last = histogram.NumbBuckets() - 1;
+			for (unsigned int bucket = 0; bucket <= last; bucket++) {
+				unsigned int count = histogram.GetCount(bucket);
+				if (count == 0) { continue; }
+				out << metric << ',' << histogram.GetLower(bucket) * scale << ',';
+				// the last bucket has no upper edge
+				if (bucket != last) { out << histogram.GetUpper(bucket) * scale; }
+				out << ',' << count << '\n';
+			}
+		}
+	}
+
+	void SolverStats::WriteCSV(std::ostream& out) const {
+		out << "metric,lower,upper,count\n";
+		out << "solves,,," << this->numbSolves << '\n';
+		out << "reached,,," << this->numbReached << '\n';
+		out << "early_exits,,," << this->numbEarlyExits << '\n';
+		out << "max_steps,,," << this->numbMaxSteps << '\n';
+		out << "budget_stops,,," << this->numbBudgetStops << '\n';
+		out << "total_iterations,,," << this->totalIterations << '\n';
+		out << "average_iterations,,," << this->GetAverageIterations() << '\n';
+		out << "average_time_us,,," << this->GetAverageTime() * 1e6 << '\n';
+		out << "largest_residual,,," << this->largestResidual << '\n';
+		unsigned int last = this->iterationCounts.size() - 1;
+		for (unsigned int iterations = 0; iterations <= last; iterations++) {
+			unsigned int count = this->iterationCounts[iterations];
+			if (count == 0) { continue; }
+			out << "iterations," << iterations << ',';
+			if (iterations != last) { out << iterations; }
+			out << ',' << count << '\n';
+		}
+		WriteHistogram(out, "residual", this->residuals, 1.0f);
+		WriteHistogram(out, "time_us", this->times, 1e6f);
+	}
+
+	bool SolverStats::WriteCSV(const char* path) const {
+		std::ofstream file(path);
+		if (!file.is_open()) {
+			std::cout << "couldn't open " << path << " to write the IK solver stats\n";
+			return false;
+		}
+		this->WriteCSV(file);
+		return true;
+	}
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <vector>
+#include <ostream>
+
+namespace ik {
+
+	/// <summary>
+	/// How an iterative IK solve finished.
+	/// </summary>
+	enum class SolveEnd {
+		Reached, // the end effector got within the solve threshold, before running out of iterations
+		MaxSteps, // every one of iterMaxSteps iterations ran without reaching the target
+		Budget // the shared IterationBudget was spent before the solve finished
+	};
+
+	/// <summary>
+	/// Counts values into buckets that are a fixed fraction of a power of ten wide, so values from 0.1 microseconds to
+	/// 0.1 seconds, or residuals from 1e-7 to 10, fit in a few dozen buckets. Bucket 0 holds values below the smallest bucket,
+	/// the last bucket holds values above the largest.
+	/// </summary>
+	class LogHistogram {
+	protected:
+		std::vector<unsigned int> counts;
+		float smallest;
+		unsigned int bucketsPerDecade;
+	public:
+		LogHistogram();
+		/// <summary>
+		/// </summary>
+		/// <param name="smallest">The lower edge of the first real bucket</param>
+		/// <param name="numbDecades">How many powers of ten the buckets cover</param>
+		/// <param name="bucketsPerDecade">How many buckets each power of ten is split into</param>
+		LogHistogram(float smallest, unsigned int numbDecades, unsigned int bucketsPerDecade);
+		void Add(float value);
+		void Merge(const LogHistogram& other);
+		void Clear();
+		unsigned int NumbBuckets() const;
+		unsigned int GetCount(unsigned int bucket) const;
+		/// <summary>
+		/// The range of values in a bucket, 0 for the lower edge of the first bucket and -1 for the upper edge of the last.
+		/// </summary>
+		float GetLower(unsigned int bucket) const;
+		float GetUpper(unsigned int bucket) const;
+	};
+
+	/// <summary>
+	/// Counters and histograms of what an iterative IK solver's solves cost: iterations, how each solve ended, the distance left
+	/// between the end effector and the target, and the time each solve took. Used to tune iterMaxSteps and solveThreshold against
+	/// real animation instead of guessing.
+	/// Solvers only record into stats they are given (see FABRIKSolver::SetStats), and only time their solves then.
+	/// Not thread safe, give solvers on different threads their own stats and Merge them.
+	/// </summary>
+	class SolverStats {
+	public:
+		/// <summary>
+		/// Solves that ran this many iterations or more share the last iteration bucket
+		/// </summary>
+		static constexpr unsigned int MaxIterationBucket = 64;
+	protected:
+		/// <summary>
+		/// iterationCounts[n] is the number of solves that ran n iterations
+		/// </summary>
+		std::vector<unsigned int> iterationCounts;
+		/// <summary>
+		/// End effector to target distance after each solve
+		/// </summary>
+		LogHistogram residuals;
+		/// <summary>
+		/// Seconds per solve
+		/// </summary>
+		LogHistogram times;
+		unsigned int numbSolves;
+		unsigned int numbReached;
+		/// <summary>
+		/// Solves that reached the target without running every iteration they were allowed
+		/// </summary>
+		unsigned int numbEarlyExits;
+		unsigned int numbMaxSteps;
+		unsigned int numbBudgetStops;
+		unsigned long long totalIterations;
+		double totalSeconds;
+		float largestResidual;
+	public:
+		SolverStats();
+		/// <summary>
+		/// Record one solve.
+		/// </summary>
+		/// <param name="iterations">The iterations the solve ran</param>
+		/// <param name="iterMaxSteps">The iterations the solve was allowed, to tell early exits apart</param>
+		/// <param name="end">Why the solve stopped</param>
+		/// <param name="residual">End effector to target distance after the solve</param>
+		/// <param name="seconds">How long the solve took</param>
+		void Record(unsigned int iterations, unsigned int iterMaxSteps, SolveEnd end, float residual, double seconds);
+		/// <summary>
+		/// Add another stats' counts to these, e.g. to combine the stats of solvers that ran on different threads.
+		/// </summary>
+		void Merge(const SolverStats& other);
+		void Clear();
+		unsigned int NumbSolves() const;
+		unsigned int NumbReached() const;
+		unsigned int NumbEarlyExits() const;
+		unsigned int NumbMaxSteps() const;
+		unsigned int NumbBudgetStops() const;
+		float GetAverageIterations() const;
+		/// <summary>
+		/// In seconds
+		/// </summary>
+		double GetAverageTime() const;
+		float GetLargestResidual() const;
+		const std::vector<unsigned int>& GetIterationHistogram() const;
+		const LogHistogram& GetResidualHistogram() const;
+		const LogHistogram& GetTimeHistogram() const;
+		/// <summary>
+		/// Write the counters and histograms as CSV with the columns metric,lower,upper,count.
+		/// Counters only fill the count column. Histogram rows are named iterations, residual and time_us, empty buckets are skipped.
+		/// </summary>
+		void WriteCSV(std::ostream& out) const;
+		/// <summary>
+		/// Write the CSV to a file, see WriteCSV(std::ostream&).
+		/// </summary>
+		/// <returns>False if the file couldn't be opened</returns>
+		bool WriteCSV(const char* path) const;
+	};
+}
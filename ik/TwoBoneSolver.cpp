@@ -0,0 +1,141 @@
+#include "TwoBoneSolver.h"
+#include <cassert>
+#include <cmath>
+
+namespace ik {
+
+	TwoBoneSolver::TwoBoneSolver() {
+		constexpr float defaultThreshold = 0.0001f;
+		this->hasPole = false;
+		this->softness = 0.0f;
+		this->solveThreshold = defaultThreshold;
+		this->localBoneChain.resize(3);
+	}
+
+	unsigned int TwoBoneSolver::ChainSize() { return this->localBoneChain.size(); }
+
+	void TwoBoneSolver::ResizeChain(unsigned int size) {
+		this->localBoneChain.resize(size);
+	}
+
+	transforms::srt& TwoBoneSolver::operator[](unsigned int index) {
+		assert(this->localBoneChain.size() > index); // catch trying to access an empty IK chain
+		return this->localBoneChain[index];
+	}
+
+	transforms::srt TwoBoneSolver::GetBoneAt(unsigned int index) {
+		transforms::srt answer = this->localBoneChain[index];
+		for (int i = ((int)index) - 1; i >= 0; i--) {
+			answer = transforms::combine(this->localBoneChain[i], answer);
+		}
+		return answer;
+	}
+
+	void TwoBoneSolver::SetPole(const f3& pole) {
+		this->pole = pole;
+		this->hasPole = true;
+	}
+
+	void TwoBoneSolver::ClearPole() { this->hasPole = false; }
+
+	void TwoBoneSolver::SetSoftness(float distance) {
+		this->softness = distance > 0.0f ? distance : 0.0f;
+	}
+
+	float TwoBoneSolver::GetSoftness() { return this->softness; }
+
+	float TwoBoneSolver::GetSolveThreshold() { return this->solveThreshold; }
+
+	void TwoBoneSolver::SetSolveThreshold(float threshold) {
+		this->solveThreshold = threshold;
+	}
+
+	void TwoBoneSolver::RotateBone(unsigned int boneIndex, const rotation::quaternion& modelSpaceRotation, f3* positions, rotation::quaternion* rotations) {
+		// same as CCD, the model space rotation is moved into the bone's space before it is added to the local rotation
+		rotation::quaternion boneRotation = rotations[boneIndex];
+		rotation::quaternion localRotation = boneRotation * modelSpaceRotation * rotation::inverse(boneRotation);
+		transforms::srt& bone = this->localBoneChain[boneIndex];
+		bone.rotation = normalized(localRotation * bone.rotation);
+		// move the model space copy of the chain along, instead of rebuilding it from the local bones
+		for (unsigned int i = boneIndex + 1; i < 3; i++) {
+			positions[i] = positions[boneIndex] + modelSpaceRotation * (positions[i] - positions[boneIndex]);
+		}
+		for (unsigned int i = boneIndex; i < 2; i++) {
+			rotations[i] = rotations[i] * modelSpaceRotation;
+		}
+	}
+
+	bool TwoBoneSolver::SolveChain(const transforms::srt& target) {
+		if (this->ChainSize() != 3) { return false; }
+		// model space joints, kept up to date by RotateBone
+		f3 positions[3];
+		rotation::quaternion rotations[2];
+		transforms::srt bone = this->localBoneChain[0];
+		positions[0] = bone.position;
+		rotations[0] = bone.rotation;
+		bone = transforms::combine(bone, this->localBoneChain[1]);
+		positions[1] = bone.position;
+		rotations[1] = bone.rotation;
+		positions[2] = transforms::combine(bone, this->localBoneChain[2]).position;
+		const f3& hip = positions[0];
+		const f3& knee = positions[1];
+		const f3& ankle = positions[2];
+		f3 targetPos = target.position;
+		float upperLength = length(knee - hip);
+		float lowerLength = length(ankle - knee);
+		f3 toTarget = targetPos - hip;
+		float targetDistance = length(toTarget);
+		if (upperLength <= 0.0f || lowerLength <= 0.0f || targetDistance <= 0.0f) { return false; }
+
+		// how far the ankle will be from the hip
+		float maxReach = upperLength + lowerLength;
+		float minReach = fabsf(upperLength - lowerLength);
+		float reach = targetDistance;
+		float softStart = maxReach - this->softness;
+		if (this->softness > 0.0f && reach > softStart) {
+			// approach full reach exponentially, the chain only straightens completely for targets infinitely far away
+			reach = softStart + this->softness * (1.0f - expf((softStart - reach) / this->softness));
+		}
+		reach = fminf(fmaxf(reach, minReach), maxReach);
+
+		// 1. bend: open or close the knee in the current bend plane until the ankle is 'reach' from the hip
+		f3 hipToAnkle = ankle - hip;
+		f3 axis = lengthSquared(hipToAnkle) > 0.0f ? normalized(hipToAnkle) : toTarget * (1.0f / targetDistance);
+		f3 bendDirection = reject(knee - hip, axis);
+		if (lengthSquared(bendDirection) < 1e-12f) {
+			// the chain is straight, so there is no bend plane, bend towards the pole or any direction at right angles to the chain
+			f3 hint = this->hasPole ? this->pole - hip : f3(0.0f, 0.0f, 1.0f);
+			bendDirection = reject(hint, axis);
+			if (lengthSquared(bendDirection) < 1e-12f) { bendDirection = reject(f3(1.0f, 0.0f, 0.0f), axis); }
+		}
+		bendDirection = normalized(bendDirection);
+		// law of cosines: the angle between the hip to knee and hip to ankle directions
+		float cosHip = (upperLength * upperLength + reach * reach - lowerLength * lowerLength) / (2.0f * upperLength * reach);
+		cosHip = fminf(fmaxf(cosHip, -1.0f), 1.0f);
+		float sinHip = sqrtf(1.0f - cosHip * cosHip);
+		f3 desiredKnee = hip + axis * (upperLength * cosHip) + bendDirection * (upperLength * sinHip);
+		f3 desiredAnkle = hip + axis * reach;
+		this->RotateBone(0, rotation::fromTo(knee - hip, desiredKnee - hip), positions, rotations);
+		this->RotateBone(1, rotation::fromTo(ankle - knee, desiredAnkle - knee), positions, rotations);
+
+		// 2. swing: point the whole chain at the target
+		this->RotateBone(0, rotation::fromTo(ankle - hip, toTarget), positions, rotations);
+
+		// 3. twist: spin the chain about the hip to target line until the knee faces the pole
+		if (this->hasPole) {
+			f3 targetAxis = toTarget * (1.0f / targetDistance);
+			f3 kneeDirection = reject(knee - hip, targetAxis);
+			f3 poleDirection = reject(this->pole - hip, targetAxis);
+			if (lengthSquared(kneeDirection) > 1e-12f && lengthSquared(poleDirection) > 1e-12f) {
+				kneeDirection = normalized(kneeDirection);
+				poleDirection = normalized(poleDirection);
+				// fromTo picks its own axis for opposite vectors, half a turn about the target line is the same rotation either way
+				rotation::quaternion twist = dot(kneeDirection, poleDirection) < -0.9999f ?
+					rotation::angleAxis(3.14159265f, targetAxis) : rotation::fromTo(kneeDirection, poleDirection);
+				this->RotateBone(0, twist, positions, rotations);
+			}
+		}
+
+		return lengthSquared(targetPos - ankle) < this->solveThreshold * this->solveThreshold;
+	}
+}
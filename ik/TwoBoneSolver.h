@@ -0,0 +1,118 @@
+#pragma once
+
+#include <vector>
+#include "../transforms/srt.h"
+
+namespace ik {
+
+	/// <summary>
+	/// Analytical Inverse Kinematic Solver for three bone chains (hip, knee, ankle or shoulder, elbow, wrist).
+	/// The law of cosines gives the knee angle that puts the ankle at the target's distance, so the chain is solved
+	/// exactly in constant time instead of iterating like CCD and FABRIK. Use the iterative solvers for longer chains.
+	/// </summary>
+	class TwoBoneSolver {
+	protected:
+		/// <summary>
+		/// The inverse kinematic bone chain is stored in hierarchical order.
+		/// boneChain[0] is the root in model space, boneChain[1] and boneChain[2] are local to the bone before them.
+		/// The chain's end effector is stored at boneChain[2].
+		/// The chain is modified in place during solving.
+		/// </summary>
+		std::vector<transforms::srt> localBoneChain;
+
+		/// <summary>
+		/// Model space point the middle joint bends towards, only used if hasPole is true.
+		/// </summary>
+		f3 pole;
+		bool hasPole;
+
+		/// <summary>
+		/// Distance before full reach where the chain starts to straighten more slowly. 0 for a hard limit.
+		/// </summary>
+		float softness;
+
+		/// <summary>
+		/// If the end effector gets within this distance of the target the solve counts as reaching it.
+		/// </summary>
+		float solveThreshold;
+	protected:
+		/// <summary>
+		/// Apply a model space rotation to a bone of the chain, its children follow.
+		/// </summary>
+		/// <param name="positions">The chain's model space positions, updated for the rotation</param>
+		/// <param name="rotations">The first two bones' model space rotations, updated for the rotation</param>
+		void RotateBone(unsigned int boneIndex, const rotation::quaternion& modelSpaceRotation, f3* positions, rotation::quaternion* rotations);
+	public:
+		/// <summary>
+		/// Create a two bone solver with no pole, a hard reach limit, and the default threshold.
+		/// </summary>
+		TwoBoneSolver();
+
+		/// <summary>
+		/// Get the number of bones in the IK chain that this solver is using
+		/// </summary>
+		/// <returns>The number of bones in the solver's IK chain</returns>
+		unsigned int ChainSize();
+
+		/// <summary>
+		/// Change the amount of memory allocated to store bones in the solver's IK chain. The solver only solves chains of 3 bones.
+		/// </summary>
+		/// <param name="size">The new number of bones to allocate memory for</param>
+		void ResizeChain(unsigned int size);
+
+		/// <summary>
+		/// Get a bone in the solver's IK chain in local bone space
+		/// </summary>
+		/// <param name="index">the index of the bone to retrieve</param>
+		/// <returns>the bone stored at the given index</returns>
+		transforms::srt& operator[](unsigned int index);
+
+		/// <summary>
+		/// Get a bone in the solver's IK chain in model space.
+		/// </summary>
+		/// <param name="index">the index of the bone to retrieve</param>
+		/// <returns>the bone stored at the given index in model space</returns>
+		transforms::srt GetBoneAt(unsigned int index);
+
+		/// <summary>
+		/// Make the middle joint bend towards a model space point, e.g. a point in front of the knee.
+		/// Without a pole the chain keeps bending in the plane it is already bent in.
+		/// </summary>
+		/// <param name="pole"></param>
+		void SetPole(const f3& pole);
+
+		/// <summary>
+		/// Stop using the pole, the chain keeps its current bend plane.
+		/// </summary>
+		void ClearPole();
+
+		/// <summary>
+		/// Soft reach limit: the last 'softness' of the chain's length is approached smoothly, so the middle joint
+		/// doesn't snap straight as a target moves out of reach. The end effector falls short of targets inside the soft zone.
+		/// </summary>
+		/// <param name="distance">0 for a hard limit</param>
+		void SetSoftness(float distance);
+
+		float GetSoftness();
+
+		/// <summary>
+		/// Get the distance the solver uses to determine if the end effector is close enough to the target
+		/// </summary>
+		/// <returns></returns>
+		float GetSolveThreshold();
+
+		/// <summary>
+		/// Change the distance the solver uses to determine if the end effector is close enough to the target
+		/// </summary>
+		/// <param name="threshold">the new distance to determine when the end effector is close enough to the target</param>
+		void SetSolveThreshold(float threshold);
+
+		/// <summary>
+		/// Rotate the chain's first two bones so that the end effector reaches the target.
+		/// Solving the chain will modify the solver's bone chain in-place.
+		/// </summary>
+		/// <param name="target">The location that the IK solver should try to move the end effector to, in model space</param>
+		/// <returns>True if the end effector reached the target, false if the target is out of reach or the chain isn't 3 bones</returns>
+		bool SolveChain(const transforms::srt& target);
+	};
+}
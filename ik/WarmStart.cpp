@@ -0,0 +1,45 @@
+#include "WarmStart.h"
+
+namespace ik {
+
+	WarmStart::WarmStart() {
+		this->isEnabled = false;
+		this->hasCorrections = false;
+	}
+
+	void WarmStart::SetEnabled(bool isEnabled) {
+		this->isEnabled = isEnabled;
+		if (!isEnabled) { this->Reset(); }
+	}
+
+	bool WarmStart::IsEnabled() const { return this->isEnabled; }
+
+	void WarmStart::Reset() {
+		this->hasCorrections = false;
+	}
+
+	void WarmStart::Begin(std::vector<transforms::srt>& localBoneChain) {
+		if (!this->isEnabled) { return; }
+		unsigned int numbBones = localBoneChain.size();
+		this->inputRotations.resize(numbBones);
+		for (unsigned int i = 0; i < numbBones; i++) {
+			this->inputRotations[i] = localBoneChain[i].rotation;
+		}
+		// a chain that changed size is a different chain
+		if (!this->hasCorrections || this->corrections.size() != numbBones) { return; }
+		for (unsigned int i = 0; i < numbBones; i++) {
+			localBoneChain[i].rotation = rotation::normalized(this->corrections[i] * localBoneChain[i].rotation);
+		}
+	}
+
+	void WarmStart::End(const std::vector<transforms::srt>& localBoneChain) {
+		if (!this->isEnabled) { return; }
+		unsigned int numbBones = localBoneChain.size();
+		if (this->inputRotations.size() != numbBones) { return; }
+		this->corrections.resize(numbBones);
+		for (unsigned int i = 0; i < numbBones; i++) {
+			this->corrections[i] = rotation::normalized(localBoneChain[i].rotation * rotation::inverse(this->inputRotations[i]));
+		}
+		this->hasCorrections = true;
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include "../transforms/srt.h"
+
+namespace ik {
+
+	/// <summary>
+	/// Starts an iterative IK solve from the last solve's answer instead of the caller's pose.
+	/// The caller sets the chain from the animated pose before every solve, which throws away the solver's work from last frame.
+	/// WarmStart remembers how far the solve rotated each bone away from the pose it was given, and applies the same rotation
+	/// to the next pose before solving it. Targets and animation only move a little between frames, so the solve starts next to
+	/// the answer and most solves finish in one or two iterations.
+	/// Only useful when the chain is set before every solve; a chain that is left as it was solved already starts from the last answer.
+	/// </summary>
+	class WarmStart {
+	protected:
+		/// <summary>
+		/// The local rotations the caller set, before Begin changed them
+		/// </summary>
+		std::vector<rotation::quaternion> inputRotations;
+		/// <summary>
+		/// solved rotation * inverse(input rotation) for each bone of the last solve, a rotation in the bone's own space
+		/// so it still fits when the bone's parent moves
+		/// </summary>
+		std::vector<rotation::quaternion> corrections;
+		bool isEnabled;
+		bool hasCorrections;
+	public:
+		/// <summary>
+		/// Warm starting is off until it is enabled
+		/// </summary>
+		WarmStart();
+		void SetEnabled(bool isEnabled);
+		bool IsEnabled() const;
+		/// <summary>
+		/// Forget the last solve, e.g. after a teleport or a cut, so the next solve starts from the caller's pose.
+		/// </summary>
+		void Reset();
+		/// <summary>
+		/// Called by the solver before solving, rotates the caller's local bone chain by the last solve's corrections.
+		/// </summary>
+		void Begin(std::vector<transforms::srt>& localBoneChain);
+		/// <summary>
+		/// Called by the solver after solving, measures the corrections the next Begin applies.
+		/// </summary>
+		void End(const std::vector<transforms::srt>& localBoneChain);
+	};
+}
@@ -121,7 +121,7 @@ namespace helpers {
     /// <param name="skin"></param>
     /// <param name="nodeArray"></param>
     /// <param name="numbNodes"></param>
-    void MeshFromAttribute(render::Mesh& mesh,
+    void MeshFromAttribute(render::MeshData& mesh,
         cgltf_attribute& attribute, cgltf_skin* skin, cgltf_node* nodeArray, unsigned int numbNodes) {
         cgltf_accessor& accessor = *attribute.data;
         unsigned int numbComponents = 0;
@@ -189,6 +189,78 @@ namespace helpers {
         }
     }
 
+    /// <summary>
+    /// Upload CPU meshes, built in place so each mesh is only uploaded once.
+    /// </summary>
+    std::vector<render::Mesh> UploadMeshes(const std::vector<render::MeshData>& meshData) {
+        std::vector<render::Mesh> result;
+        result.reserve(meshData.size());
+        for (const render::MeshData& mesh : meshData) {
+            result.emplace_back(mesh);
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// Read and optimize the skinned meshes' CPU data, without building their skinning streams.
+    /// </summary>
+    std::vector<render::MeshData> ReadMeshData(cgltf_data* data) {
+        // check all nodes, skip nodes that do not possess a mesh and skin
+        std::vector<render::MeshData> result;
+        cgltf_node* nodes = data->nodes;
+        unsigned int numbNodes = data->nodes_count;
+        for (unsigned int i = 0; i < numbNodes; i++) {
+            cgltf_node* node = &nodes[i];
+            if (node->mesh == 0 || node->skin == 0) { continue; }
+            cgltf_size primCount = node->mesh->primitives_count; // basically an unsigned int
+            for (unsigned int j = 0; j < primCount; j++) {
+                result.push_back(render::MeshData());
+                render::MeshData& mesh = result.back();
+                cgltf_primitive* primative = &node->mesh->primitives[j];
+                unsigned int attributeCount = primative->attributes_count;
+                for (unsigned int k = 0; k < attributeCount; k++) {
+                    // extracting verts, norms, textCoords, and more attributes for the mesh
+                    cgltf_attribute* attribute = &primative->attributes[k];
+                    helpers::MeshFromAttribute(mesh, *attribute, node->skin, nodes, numbNodes);
+                }
+                if (primative->indices != 0) {
+                    unsigned int indicesCount = primative->indices->count;
+                    auto& indices = mesh.GetVertexIndices();
+                    indices.resize(indicesCount);
+                    for (unsigned int k = 0; k < indicesCount; k++) {
+                        indices[k] = cgltf_accessor_read_index(primative->indices, k);
+                    }
+                }
+                if (primative->type == cgltf_primitive_type_triangles) {
+                    // fewer vertices to skin, triangles in post transform cache order, and vertices in the order the triangles read them
+                    mesh.WeldVertices();
+                    mesh.OptimizeVertexCache();
+                    mesh.OptimizeVertexFetch();
+                }
+                // lets CPU skinning skip the bones a vertex doesn't use, keeps the fetch order inside each group
+                mesh.SortVerticesByInfluenceCount();
+            }
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// Store the meshes' bone indices and weights in compact formats, a mesh whose bones don't fit keeps full size bone data.
+    /// </summary>
+    void SetSkinningFormat(std::vector<render::MeshData>& meshData, render::BoneIndexFormat indexFormat, render::BoneWeightFormat weightFormat) {
+        for (render::MeshData& mesh : meshData) {
+            mesh.SetSkinningFormat(indexFormat, weightFormat);
+        }
+    }
+
+    /// <summary>
+    /// Build the skinning streams of meshes that will be skinned on the CPU straight away.
+    /// </summary>
+    void BuildSkinningStreams(std::vector<render::MeshData>& meshData) {
+        for (render::MeshData& mesh : meshData) {
+            mesh.UpdateSkinningStreams();
+        }
+    }
 }
 
 anim::Pose MakeRestPose(cgltf_data* data) {
@@ -253,39 +325,30 @@ anim::Armature MakeArmature(cgltf_data* data) {
     );
 }
 
-std::vector<render::Mesh> LoadMeshes(cgltf_data* data) {
-    // check all nodes, skip nodes that do not possess a mesh and skin
-    std::vector<render::Mesh> result;
-    cgltf_node* nodes = data->nodes;
-    unsigned int numbNodes = data->nodes_count;
-    for (unsigned int i = 0; i < numbNodes; i++) {
-        cgltf_node* node = &nodes[i];
-        if (node->mesh == 0 || node->skin == 0) { continue; }
-        cgltf_size primCount = node->mesh->primitives_count; // basically an unsigned int
-        for (unsigned int j = 0; j < primCount; j++) {
-            result.push_back(render::Mesh());
-            render::Mesh& mesh = result.back();
-            cgltf_primitive* primative = &node->mesh->primitives[j];
-            unsigned int attributeCount = primative->attributes_count;
-            for (unsigned int k = 0; k < attributeCount; k++) {
-                // extracting verts, norms, textCoords, and more attributes for the mesh
-                cgltf_attribute* attribute = &primative->attributes[k];
-                helpers::MeshFromAttribute(mesh, *attribute, node->skin, nodes, numbNodes);
-            }
-            if (primative->indices != 0) {
-                unsigned int indicesCount = primative->indices->count;
-                auto& indices = mesh.GetVertexIndices();
-                indices.resize(indicesCount);
-                for (unsigned int k = 0; k < indicesCount; k++) {
-                    indices[k] = cgltf_accessor_read_index(primative->indices, k);
-                }
-            }
-            mesh.SyncOpenGL();
-        }
-    }
+std::vector<render::MeshData> LoadMeshData(cgltf_data* data) {
+    std::vector<render::MeshData> result = helpers::ReadMeshData(data);
+    helpers::BuildSkinningStreams(result);
+    return result;
+}
+
+std::vector<render::MeshData> LoadMeshData(cgltf_data* data, render::BoneIndexFormat indexFormat, render::BoneWeightFormat weightFormat) {
+    std::vector<render::MeshData> result = helpers::ReadMeshData(data);
+    helpers::SetSkinningFormat(result, indexFormat, weightFormat);
+    helpers::BuildSkinningStreams(result);
     return result;
 }
 
+std::vector<render::Mesh> LoadMeshes(cgltf_data* data) {
+    // the streams are built on a mesh's first CPU skin, GPU skinned meshes never need them
+    return helpers::UploadMeshes(helpers::ReadMeshData(data));
+}
+
+std::vector<render::Mesh> LoadMeshes(cgltf_data* data, render::BoneIndexFormat indexFormat, render::BoneWeightFormat weightFormat) {
+    std::vector<render::MeshData> meshData = helpers::ReadMeshData(data);
+    helpers::SetSkinningFormat(meshData, indexFormat, weightFormat);
+    return helpers::UploadMeshes(meshData);
+}
+
 cgltf_data* LoadGLTFFile(const char* path) {
     cgltf_options options{};
     cgltf_data* data = nullptr;
@@ -32,6 +32,36 @@ anim::Pose MakeBindPose(cgltf_data* data);
 
 anim::Armature MakeArmature(cgltf_data* data);
 
+/// <summary>
+/// Load the skinned meshes' CPU data only, nothing is uploaded so it works without an OpenGL context.
+/// Duplicate vertices are welded, triangles and vertices are reordered for the GPU's caches, vertices are sorted by influence count
+/// and the skinning streams are built, the meshes can be skinned on the CPU straight away.
+/// </summary>
+/// <param name="data"></param>
+/// <returns></returns>
+std::vector<render::MeshData> LoadMeshData(cgltf_data* data);
+
+/// <summary>
+/// Load the meshes' CPU data, storing their bone indices and weights in compact formats. See LoadMeshes.
+/// </summary>
+std::vector<render::MeshData> LoadMeshData(cgltf_data* data, render::BoneIndexFormat indexFormat, render::BoneWeightFormat weightFormat);
+
+/// <summary>
+/// Load the skinned meshes and upload them to OpenGL.
+/// The skinning streams aren't built, a mesh builds them the first time it is skinned on the CPU.
+/// </summary>
+/// <param name="data"></param>
+/// <returns></returns>
 std::vector<render::Mesh> LoadMeshes(cgltf_data* data);
 
+/// <summary>
+/// Load the meshes, storing their bone indices and weights in compact formats.
+/// A mesh whose bones don't fit in the index format keeps full size bone data.
+/// </summary>
+/// <param name="data"></param>
+/// <param name="indexFormat">e.g. UInt8 for rigs with up to 256 bones, UInt16 for larger rigs</param>
+/// <param name="weightFormat">e.g. UNorm8, weights are quantized to sum to exactly one</param>
+/// <returns></returns>
+std::vector<render::Mesh> LoadMeshes(cgltf_data* data, render::BoneIndexFormat indexFormat, render::BoneWeightFormat weightFormat);
+
 }
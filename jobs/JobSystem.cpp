@@ -0,0 +1,155 @@
+#include "JobSystem.h"
+
+namespace jobs {
+
+	// the job system and queue index of the worker running on this thread, workers only
+	static thread_local JobSystem* workerOwner = NULL;
+	static thread_local unsigned int workerIndex = 0;
+
+	JobSystem::JobSystem() {
+		unsigned int numbHardwareThreads = std::thread::hardware_concurrency();
+		// the calling thread also executes jobs, so it counts as one of the hardware threads
+		this->Start(numbHardwareThreads > 1 ? numbHardwareThreads - 1 : 0);
+	}
+
+	JobSystem::JobSystem(unsigned int numbWorkers) {
+		this->Start(numbWorkers);
+	}
+
+	JobSystem::~JobSystem() {
+		this->isRunning = false;
+		{
+			std::lock_guard<std::mutex> lock(this->sleepLock);
+		}
+		this->wakeUp.notify_all();
+		unsigned int numbWorkers = this->workers.size();
+		for (unsigned int i = 0; i < numbWorkers; i++) {
+			this->workers[i].join();
+		}
+		unsigned int numbQueues = this->queues.size();
+		for (unsigned int i = 0; i < numbQueues; i++) {
+			delete this->queues[i];
+		}
+	}
+
+	void JobSystem::Start(unsigned int numbWorkers) {
+		this->isRunning = true;
+		this->numbQueuedJobs = 0;
+		// queues must exist before any worker starts looking for work
+		for (unsigned int i = 0; i < numbWorkers + 1; i++) {
+			this->queues.push_back(new WorkQueue());
+		}
+		for (unsigned int i = 0; i < numbWorkers; i++) {
+			this->workers.push_back(std::thread(&JobSystem::WorkerLoop, this, i));
+		}
+	}
+
+	unsigned int JobSystem::NumbThreads() {
+		return (unsigned int) this->workers.size() + 1;
+	}
+
+	unsigned int JobSystem::LocalQueue() {
+		if (workerOwner == this) { return workerIndex; }
+		// threads that aren't workers share the last queue
+		return (unsigned int) this->queues.size() - 1;
+	}
+
+	void JobSystem::Push(unsigned int queue, const Job& job) {
+		WorkQueue& workQueue = *this->queues[queue];
+		std::lock_guard<std::mutex> lock(workQueue.lock);
+		workQueue.jobs.push_back(job);
+		this->numbQueuedJobs++;
+	}
+
+	bool JobSystem::FindJob(unsigned int queue, Job& jobOut) {
+		// newest job from our own queue first, its data is most likely still in cache
+		{
+			WorkQueue& own = *this->queues[queue];
+			std::lock_guard<std::mutex> lock(own.lock);
+			if (!own.jobs.empty()) {
+				jobOut = own.jobs.back();
+				own.jobs.pop_back();
+				this->numbQueuedJobs--;
+				return true;
+			}
+		}
+		// steal the oldest job from someone else
+		unsigned int numbQueues = this->queues.size();
+		for (unsigned int i = 1; i < numbQueues; i++) {
+			WorkQueue& victim = *this->queues[(queue + i) % numbQueues];
+			std::lock_guard<std::mutex> lock(victim.lock);
+			if (!victim.jobs.empty()) {
+				jobOut = victim.jobs.front();
+				victim.jobs.pop_front();
+				this->numbQueuedJobs--;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void JobSystem::Execute(Job& job) {
+		job.function(job.data, job.begin, job.end);
+		job.remaining->fetch_sub(1);
+	}
+
+	void JobSystem::WorkerLoop(unsigned int index) {
+		workerOwner = this;
+		workerIndex = index;
+		while (this->isRunning) {
+			Job job;
+			if (this->FindJob(index, job)) {
+				this->Execute(job);
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(this->sleepLock);
+			this->wakeUp.wait(lock, [this]() { return this->numbQueuedJobs > 0 || !this->isRunning; });
+		}
+	}
+
+	void JobSystem::ParallelFor(unsigned int count, unsigned int grainSize, JobFunction function, void* data) {
+		if (count == 0) { return; }
+		if (grainSize == 0) {
+			// a few jobs per thread gives the thieves something to take when the work is uneven
+			grainSize = count / (this->NumbThreads() * 4);
+			grainSize = grainSize > 0 ? grainSize : 1;
+		}
+		unsigned int numbJobs = (count + grainSize - 1) / grainSize;
+		if (this->workers.empty() || numbJobs == 1) {
+			function(data, 0, count);
+			return;
+		}
+		std::atomic<unsigned int> remaining(numbJobs);
+		unsigned int local = this->LocalQueue();
+		bool isWorker = workerOwner == this;
+		unsigned int numbWorkers = this->workers.size();
+		// the first job is run by this thread, the rest are queued
+		for (unsigned int i = 1; i < numbJobs; i++) {
+			Job job;
+			job.function = function;
+			job.data = data;
+			job.begin = i * grainSize;
+			job.end = (job.begin + grainSize) < count ? (job.begin + grainSize) : count;
+			job.remaining = &remaining;
+			// workers keep their jobs local and let idle workers steal them,
+			// other threads spread their jobs so every worker starts with something to do
+			this->Push(isWorker ? local : (i % numbWorkers), job);
+		}
+		{
+			std::lock_guard<std::mutex> lock(this->sleepLock);
+		}
+		this->wakeUp.notify_all();
+
+		function(data, 0, grainSize);
+		remaining--;
+		// help out until every job from this call is finished
+		while (remaining > 0) {
+			Job job;
+			if (this->FindJob(local, job)) {
+				this->Execute(job);
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	}
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+namespace jobs {
+
+	/// <summary>
+	/// A work stealing thread pool.
+	/// Each worker thread owns a queue of jobs. Workers take jobs from the back of their own queue, and when their queue
+	/// runs dry they steal jobs from the front of the other workers' queues. The thread that submits work helps execute
+	/// jobs until all of its work is done, so ParallelFor can also be called from inside a job.
+	/// </summary>
+	class JobSystem {
+	public:
+		/// <summary>
+		/// A job processes the items [begin, end) of a ParallelFor range.
+		/// </summary>
+		typedef void (*JobFunction)(void* data, unsigned int begin, unsigned int end);
+	protected:
+		struct Job {
+			JobFunction function;
+			void* data;
+			unsigned int begin;
+			unsigned int end;
+			/// <summary>
+			/// Decremented once the job has finished, owned by the ParallelFor call that made the job
+			/// </summary>
+			std::atomic<unsigned int>* remaining;
+		};
+
+		struct WorkQueue {
+			std::mutex lock;
+			std::deque<Job> jobs;
+		};
+
+		std::vector<std::thread> workers;
+		/// <summary>
+		/// One queue per worker, plus a shared queue at the back for threads that are not workers
+		/// </summary>
+		std::vector<WorkQueue*> queues;
+		std::atomic<bool> isRunning;
+		/// <summary>
+		/// Number of jobs sitting in queues, lets idle workers sleep instead of spinning
+		/// </summary>
+		std::atomic<unsigned int> numbQueuedJobs;
+		std::mutex sleepLock;
+		std::condition_variable wakeUp;
+	protected:
+		void Start(unsigned int numbWorkers);
+		void WorkerLoop(unsigned int workerIndex);
+		/// <summary>
+		/// Index of the queue that the calling thread pushes to and pops from
+		/// </summary>
+		unsigned int LocalQueue();
+		void Push(unsigned int queue, const Job& job);
+		/// <summary>
+		/// Take a job from the back of our own queue, otherwise steal one from the front of another queue.
+		/// </summary>
+		/// <returns>True if a job was found</returns>
+		bool FindJob(unsigned int queue, Job& jobOut);
+		void Execute(Job& job);
+	private:
+		// the worker threads hold a pointer to the job system, so it can't be copied
+		JobSystem(const JobSystem&);
+		JobSystem& operator=(const JobSystem&);
+	public:
+		/// <summary>
+		/// Create a job system with one worker per hardware thread, minus one for the calling thread.
+		/// </summary>
+		JobSystem();
+		/// <summary>
+		/// Create a job system with a specific number of worker threads. 0 workers runs every job on the calling thread.
+		/// </summary>
+		JobSystem(unsigned int numbWorkers);
+		~JobSystem();
+		/// <summary>
+		/// The number of threads that execute jobs, including the calling thread.
+		/// </summary>
+		unsigned int NumbThreads();
+		/// <summary>
+		/// Split the range [0, count) into jobs of grainSize items and run them across all threads.
+		/// Returns once every item has been processed.
+		/// </summary>
+		/// <param name="count">The number of items to process</param>
+		/// <param name="grainSize">The number of items each job processes, 0 picks a size from the number of threads</param>
+		/// <param name="function">Called once per job with the job's sub range</param>
+		/// <param name="data">Passed through to the function</param>
+		void ParallelFor(unsigned int count, unsigned int grainSize, JobFunction function, void* data);
+		/// <summary>
+		/// ParallelFor for callables (lambdas) with the signature void(unsigned int begin, unsigned int end).
+		/// </summary>
+		template<typename FUNCTION>
+		void ParallelFor(unsigned int count, unsigned int grainSize, FUNCTION& function) {
+			this->ParallelFor(count, grainSize, &JobSystem::CallFunction<FUNCTION>, (void*) &function);
+		}
+	protected:
+		template<typename FUNCTION>
+		static void CallFunction(void* data, unsigned int begin, unsigned int end) {
+			(*(FUNCTION*) data)(begin, end);
+		}
+	};
+}
@@ -11,6 +11,8 @@ namespace render {
 	template Attribute<f3>;
 	template Attribute<f4>;
 	template Attribute<i4>;
+	template Attribute<us4>;
+	template Attribute<ub4>;
 
 	// https://registry.khronos.org/OpenGL-Refpages/gl4/html/glVertexAttribPointer.xhtml
 	template<>
@@ -36,6 +38,26 @@ namespace render {
 		);
 	}
 
+	template<>
+	void Attribute<us4>::SetAttributePointer(unsigned int slot) {
+		if (this->mNormalized) {
+			// divided by 65535 on the way into the shader
+			glad_glVertexAttribPointer(slot, 4, GL_UNSIGNED_SHORT, GL_TRUE, 0, (void*)NULL);
+		} else {
+			glad_glVertexAttribIPointer(slot, 4, GL_UNSIGNED_SHORT, 0, (void*)NULL);
+		}
+	}
+
+	template<>
+	void Attribute<ub4>::SetAttributePointer(unsigned int slot) {
+		if (this->mNormalized) {
+			// divided by 255 on the way into the shader
+			glad_glVertexAttribPointer(slot, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, (void*)NULL);
+		} else {
+			glad_glVertexAttribIPointer(slot, 4, GL_UNSIGNED_BYTE, 0, (void*)NULL);
+		}
+	}
+
 	template<>
 	void Attribute<float>::SetAttributePointer(unsigned int slot) {
 		glad_glVertexAttribPointer(
@@ -90,6 +112,7 @@ namespace render {
 		// https://registry.khronos.org/OpenGL-Refpages/gl4/html/glGenBuffers.xhtml 
 		glad_glGenBuffers(1, &this->mHandle);
 		this->mCount = 0;
+		this->mNormalized = false;
 	}
 
 	template<typename T>
@@ -99,7 +122,7 @@ namespace render {
 	}
 
 	template<typename t>
-	void Attribute<t>::Set(t* dataArray, unsigned int arrayLength) {
+	void Attribute<t>::Set(const t* dataArray, unsigned int arrayLength) {
 		// Tell OpenGL we want to send data to a buffer
 		glad_glBindBuffer(GL_ARRAY_BUFFER, this->mHandle);
 		this->mCount = arrayLength;
@@ -117,7 +140,7 @@ namespace render {
 	}
 
 	template<typename t>
-	void Attribute<t>::Set(std::vector<t>& data) {
+	void Attribute<t>::Set(const std::vector<t>& data) {
 		this->Set(&data[0], (unsigned int)data.size());
 	}
 
@@ -147,4 +170,9 @@ namespace render {
 		return this->mHandle;
 	}
 
+	template<typename T>
+	void Attribute<T>::SetNormalized(bool normalized) {
+		this->mNormalized = normalized;
+	}
+
 }
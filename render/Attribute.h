@@ -19,6 +19,10 @@ protected:
 	/// The amount of data being stored in this attribute.
 	/// </summary>
 	unsigned int mCount;
+	/// <summary>
+	/// For the integer vector types, should the shader see them as floats in the range [0,1] instead of as integers.
+	/// </summary>
+	bool mNormalized;
 private:
 	/// <summary>
 	/// Hide the copy constructor to prevent multiple objects aliasing the same OpenGL resources.
@@ -42,12 +46,12 @@ public:
 	/// </summary>
 	/// <param name="inputArray"></param>
 	/// <param name="arrayLength"></param>
-	void Set(t* dataArray, unsigned int arrayLength);
+	void Set(const t* dataArray, unsigned int arrayLength);
 	/// <summary>
 	/// Upload data to the GPU.
 	/// </summary>
 	/// <param name="data"></param>
-	void Set(std::vector<t>& data);
+	void Set(const std::vector<t>& data);
 	/// <summary>
 	/// Binds to the buffer then associates the buffer with the provided vertex attribute array slot.
 	/// </summary>
@@ -68,6 +72,12 @@ public:
 	/// </summary>
 	/// <returns></returns>
 	unsigned int GetHandle();
+	/// <summary>
+	/// Make an unsigned integer attribute (ub4, us4) show up in the shader as normalized floats, e.g. 255 -> 1.0, instead of integers.
+	/// Used for compact bone weights. Has no effect on float attributes.
+	/// </summary>
+	/// <param name="normalized"></param>
+	void SetNormalized(bool normalized);
 };
 
 }
@@ -0,0 +1,88 @@
+#include "Bounds.h"
+#include <cfloat>
+#include <cmath>
+
+namespace render {
+
+	Bounds::Bounds() : min(FLT_MAX), max(-FLT_MAX) { }
+
+	Bounds::Bounds(const f3& min, const f3& max) : min(min), max(max) { }
+
+	bool Bounds::IsEmpty() const {
+		return this->min.x > this->max.x || this->min.y > this->max.y || this->min.z > this->max.z;
+	}
+
+	void Bounds::Grow(const f3& point) {
+		for (unsigned int axis = 0; axis < 3; axis++) {
+			this->min.v[axis] = fminf(this->min.v[axis], point.v[axis]);
+			this->max.v[axis] = fmaxf(this->max.v[axis], point.v[axis]);
+		}
+	}
+
+	void Bounds::Grow(const Bounds& other) {
+		if (other.IsEmpty()) { return; }
+		this->Grow(other.min);
+		this->Grow(other.max);
+	}
+
+	Bounds TransformBounds(const mat4f& transform, const Bounds& bounds) {
+		if (bounds.IsEmpty()) { return bounds; }
+		f3 center = (bounds.min + bounds.max) * 0.5f;
+		f3 extents = (bounds.max - bounds.min) * 0.5f;
+		f3 newCenter = multiplyPoint(transform, center);
+		f3 newExtents;
+		for (unsigned int row = 0; row < 3; row++) {
+			newExtents.v[row] =
+				fabsf(transform.v[0 * 4 + row]) * extents.x +
+				fabsf(transform.v[1 * 4 + row]) * extents.y +
+				fabsf(transform.v[2 * 4 + row]) * extents.z;
+		}
+		return Bounds(newCenter - newExtents, newCenter + newExtents);
+	}
+
+	Bounds SkinnedBounds(const std::vector<Bounds>& boneBounds, const std::vector<mat4f>& posedBones) {
+		Bounds result;
+		unsigned int numbBones = boneBounds.size() < posedBones.size() ? boneBounds.size() : posedBones.size();
+		for (unsigned int bone = 0; bone < numbBones; bone++) {
+			// bones without vertices, and bones collapsed onto another bone, have empty boxes
+			if (boneBounds[bone].IsEmpty()) { continue; }
+			result.Grow(TransformBounds(posedBones[bone], boneBounds[bone]));
+		}
+		return result;
+	}
+
+	Frustum::Frustum() {
+		for (unsigned int plane = 0; plane < 6; plane++) {
+			this->planes[plane] = f4(0.0f, 0.0f, 0.0f, 1.0f);
+		}
+	}
+
+	Frustum::Frustum(const mat4f& viewProjection) {
+		// a point is inside the clip volume when -w <= x, y, z <= w, each plane is the fourth row plus or minus one of the others
+		const mat4f& m = viewProjection;
+		for (unsigned int row = 0; row < 3; row++) {
+			for (unsigned int side = 0; side < 2; side++) {
+				float sign = side == 0 ? 1.0f : -1.0f;
+				this->planes[row * 2 + side] = f4(
+					m.v[3] + sign * m.v[row],
+					m.v[7] + sign * m.v[4 + row],
+					m.v[11] + sign * m.v[8 + row],
+					m.v[15] + sign * m.v[12 + row]
+				);
+			}
+		}
+	}
+
+	bool Intersects(const Frustum& frustum, const Bounds& bounds) {
+		if (bounds.IsEmpty()) { return false; }
+		for (unsigned int i = 0; i < 6; i++) {
+			const f4& plane = frustum.planes[i];
+			// the corner of the box furthest along the plane's normal
+			float x = plane.x >= 0.0f ? bounds.max.x : bounds.min.x;
+			float y = plane.y >= 0.0f ? bounds.max.y : bounds.min.y;
+			float z = plane.z >= 0.0f ? bounds.max.z : bounds.min.z;
+			if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f) { return false; }
+		}
+		return true;
+	}
+}
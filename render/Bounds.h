@@ -0,0 +1,61 @@
+#pragma once
+#include <vector>
+#include "../Vector3.h"
+#include "../Vector4.h"
+#include "../Mat4f.h"
+
+namespace render {
+
+	/// <summary>
+	/// An axis aligned bounding box.
+	/// </summary>
+	struct Bounds {
+		f3 min;
+		f3 max;
+		/// <summary>
+		/// Makes an empty box, growing it by a point makes a box around just that point
+		/// </summary>
+		Bounds();
+		Bounds(const f3& min, const f3& max);
+		bool IsEmpty() const;
+		void Grow(const f3& point);
+		void Grow(const Bounds& other);
+	};
+
+	/// <summary>
+	/// The box around a transformed box, grows the extents by the absolute value of the transform's rotation and scale.
+	/// </summary>
+	Bounds TransformBounds(const mat4f& transform, const Bounds& bounds);
+
+	/// <summary>
+	/// A conservative box around a linear blend skinned mesh, without skinning it. O(bones) instead of O(vertices).
+	/// A skinned vertex is a weighted average of the vertex moved rigidly by each of its bones, so it is inside the
+	/// union of its bones' boxes as long as its weights are positive and sum to one.
+	/// Dual quaternion skinning can bulge slightly past the box at twisting joints.
+	/// </summary>
+	/// <param name="boneBounds">Each bone's vertices in the bone's space, see MeshData::BuildBoneBounds</param>
+	/// <param name="posedBones">Each bone in model space, see Pose::ToMatrixPalette</param>
+	/// <returns>Empty if no bone has vertices</returns>
+	Bounds SkinnedBounds(const std::vector<Bounds>& boneBounds, const std::vector<mat4f>& posedBones);
+
+	/// <summary>
+	/// The six planes of a camera's view volume, for culling boxes before they are animated, skinned or drawn.
+	/// </summary>
+	struct Frustum {
+		/// <summary>
+		/// left, right, bottom, top, near, far. Each plane is (normal, distance), with the normal pointing into the volume.
+		/// </summary>
+		f4 planes[6];
+		Frustum();
+		/// <summary>
+		/// Extract the planes of a projection * view matrix, planes are in the space the matrix transforms from.
+		/// Pass projection * view * model to get the planes in a model's space.
+		/// </summary>
+		Frustum(const mat4f& viewProjection);
+	};
+
+	/// <summary>
+	/// False if the box is completely outside one of the frustum's planes. Can return true for boxes that are just outside a corner of the frustum.
+	/// </summary>
+	bool Intersects(const Frustum& frustum, const Bounds& bounds);
+}
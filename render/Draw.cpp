@@ -22,6 +22,10 @@ namespace render {
 		}
 	}
 
+	static GLenum IndexType(IndexBuffer& indexBuffer) {
+		return indexBuffer.IndexSize() == sizeof(unsigned short) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	}
+
 	void Draw(IndexBuffer& indexBuffer, DrawMode mode) {
 		unsigned int handle = indexBuffer.GetHandle();
 		unsigned int numIndices = indexBuffer.Count();
@@ -30,7 +34,7 @@ namespace render {
 		glad_glDrawElements(
 			ToGLenum(mode), // type of primitives being rendered
 			numIndices,		// number of elements to render, elements will be found in the enabled array, initial offset into the array is the last parameter of this function
-			GL_UNSIGNED_INT,// the type of the value in the bound buffer?
+			IndexType(indexBuffer),// the type of the value in the bound buffer, 16 or 32 bit indices
 			0 // offset into the enabled array to where the indices are
 		);
 		glad_glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -52,7 +56,7 @@ namespace render {
 		glad_glDrawElementsInstanced(
 			ToGLenum(mode), 
 			numIndices, 
-			GL_UNSIGNED_INT, 
+			IndexType(indexBuffer), 
 			0, 
 			instanceCount
 		);
@@ -7,21 +7,36 @@ IndexBuffer::IndexBuffer() {
 	// https://registry.khronos.org/OpenGL-Refpages/gl4/html/glGenBuffers.xhtml 
 	glad_glGenBuffers(1, &this->mHandle); // write the handle of the buffer into 'this' handle
 	this->mCount = 0;
+	this->mIndexSize = sizeof(unsigned int);
 }
 
 IndexBuffer::~IndexBuffer() {
 	glad_glDeleteBuffers(1, &this->mHandle);
 }
 
-void IndexBuffer::Set(unsigned int* intArray, unsigned int arrayLength) {
+void IndexBuffer::Set(const unsigned int* intArray, unsigned int arrayLength) {
 	this->mCount = arrayLength;
+	this->mIndexSize = sizeof(unsigned int);
 	unsigned int bufferSize = arrayLength * sizeof(unsigned int);
 	glad_glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->mHandle);
 	glad_glBufferData(GL_ELEMENT_ARRAY_BUFFER, bufferSize, intArray, GL_STATIC_DRAW);
 	glad_glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
-void IndexBuffer::Set(std::vector<unsigned int>& data) {
+void IndexBuffer::Set(const std::vector<unsigned int>& data) {
+	Set(&data[0], (unsigned int) data.size());
+}
+
+void IndexBuffer::Set(const unsigned short* shortArray, unsigned int arrayLength) {
+	this->mCount = arrayLength;
+	this->mIndexSize = sizeof(unsigned short);
+	unsigned int bufferSize = arrayLength * sizeof(unsigned short);
+	glad_glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->mHandle);
+	glad_glBufferData(GL_ELEMENT_ARRAY_BUFFER, bufferSize, shortArray, GL_STATIC_DRAW);
+	glad_glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void IndexBuffer::Set(const std::vector<unsigned short>& data) {
 	Set(&data[0], (unsigned int) data.size());
 }
 
@@ -29,6 +44,10 @@ unsigned int IndexBuffer::Count() {
 	return this->mCount;
 }
 
+unsigned int IndexBuffer::IndexSize() {
+	return this->mIndexSize;
+}
+
 unsigned int IndexBuffer::GetHandle() {
 	return this->mHandle;
 }
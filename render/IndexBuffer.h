@@ -22,6 +22,10 @@ public:
 	/// How much stuff is stored in the buffer.
 	/// </summary>
 	unsigned int mCount;
+	/// <summary>
+	/// Size of each index in bytes, 2 for 16 bit indices, 4 for 32 bit indices.
+	/// </summary>
+	unsigned int mIndexSize;
 private:
 	// Hide the copy constructor and assignment operator to
 	// prevent multiple buffers having references to the same index buffer objects.
@@ -35,9 +39,17 @@ public:
 	/// </summary>
 	/// <param name="intArray">The data to send</param>
 	/// <param name="arrayLength">The size of the array</param>
-	void Set(unsigned int* intArray, unsigned int arrayLength);
-	void Set(std::vector<unsigned int>& data);
+	void Set(const unsigned int* intArray, unsigned int arrayLength);
+	void Set(const std::vector<unsigned int>& data);
+	/// <summary>
+	/// Send 16 bit indices to the GPU, half the memory and bandwidth of 32 bit indices. For meshes with up to 65536 vertices.
+	/// </summary>
+	/// <param name="shortArray">The data to send</param>
+	/// <param name="arrayLength">The size of the array</param>
+	void Set(const unsigned short* shortArray, unsigned int arrayLength);
+	void Set(const std::vector<unsigned short>& data);
 	unsigned int Count();
+	unsigned int IndexSize();
 	unsigned int GetHandle();
 };
 
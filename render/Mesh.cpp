@@ -1,35 +1,36 @@
 #include "Mesh.h"
 #include "Draw.h"
+#include "../Fingerprint.h"
 
 namespace render {
 
 Mesh::Mesh() {
+	this->boneIndex16Attribute = NULL;
+	this->boneIndex8Attribute = NULL;
+	this->boneWeight16Attribute = NULL;
+	this->boneWeight8Attribute = NULL;
 	this->boneIndexAttribute = new Attribute<i4>();
 	this->boneWeightAttribute = new Attribute<f4>();
 	this->normalAttribute = new Attribute<f3>();
 	this->textureCoordAttribute = new Attribute<f2>();
 	this->positionAttribute = new Attribute<f3>();
 	this->vertexIndexBuffer = new IndexBuffer();
+	this->isSkinCurrent = false;
+	this->skinFingerprint = 0;
 }
 
-Mesh::Mesh(const Mesh& other) {
-	this->boneIndexAttribute = new Attribute<i4>();
-	this->boneWeightAttribute = new Attribute<f4>();
-	this->normalAttribute = new Attribute<f3>();
-	this->textureCoordAttribute = new Attribute<f2>();
-	this->positionAttribute = new Attribute<f3>();
-	this->vertexIndexBuffer = new IndexBuffer();
+Mesh::Mesh(const MeshData& data) : Mesh() {
+	this->data = data;
+	this->SyncOpenGL();
+}
+
+Mesh::Mesh(const Mesh& other) : Mesh() {
 	*this = other;
 }
 
 Mesh& Mesh::operator=(const Mesh& other) {
 	if (this == &other) { return *this; }
-	this->boneIndices = other.boneIndices;
-	this->boneWeights = other.boneWeights;
-	this->normals = other.normals;
-	this->positions = other.positions;
-	this->textureCoords = other.textureCoords;
-	this->vertexIndices = other.vertexIndices;
+	this->data = other.data;
 	this->SyncOpenGL();
 	return *this;
 }
@@ -37,115 +38,240 @@ Mesh& Mesh::operator=(const Mesh& other) {
 Mesh::~Mesh() {
 	delete this->boneIndexAttribute;
 	delete this->boneWeightAttribute;
+	delete this->boneIndex16Attribute;
+	delete this->boneIndex8Attribute;
+	delete this->boneWeight16Attribute;
+	delete this->boneWeight8Attribute;
 	delete this->normalAttribute;
 	delete this->textureCoordAttribute;
 	delete this->positionAttribute;
 	delete this->vertexIndexBuffer;
 }
 
-std::vector<f3>& Mesh::GetPositions() { return this->positions; }
+MeshData& Mesh::GetData() { return this->data; }
 
-std::vector<f3>& Mesh::GetNormals() { return this->normals; }
+const MeshData& Mesh::GetData() const { return this->data; }
 
-std::vector<f2>& Mesh::GetTextureCoords() { return this->textureCoords; }
+std::vector<f3>& Mesh::GetPositions() { return this->data.GetPositions(); }
 
-std::vector<i4>& Mesh::GetBoneIndices() { return this->boneIndices; }
+std::vector<f3>& Mesh::GetNormals() { return this->data.GetNormals(); }
 
-std::vector<f4>& Mesh::GetBoneWeights() { return this->boneWeights; }
+std::vector<f2>& Mesh::GetTextureCoords() { return this->data.GetTextureCoords(); }
 
-std::vector<unsigned int>& Mesh::GetVertexIndices() { return this->vertexIndices; }
+std::vector<i4>& Mesh::GetBoneIndices() { return this->data.GetBoneIndices(); }
 
-void Mesh::Skin(anim::Armature& skeleton, anim::Pose& animatedPose) {
-	unsigned int vertCount = this->positions.size();
-	if (vertCount == 0) { return; } // no 'skin' to apply
-	this->skinnedPositions.resize(vertCount);
-	this->skinnedNormals.resize(vertCount);
-	// write the animated pose bone's into the mat4f vector
-	animatedPose.ToMatrixPalette(this->posedBones);
-	std::vector<mat4f> invBindPose = skeleton.GetInverseBindPose();
-	// skinning every vertex
-	for (int i = 0; i < vertCount; i++) {
-		// bones that influence this vertex
-		i4& bones = this->boneIndices[i];
-		// how much each bone affects this vertex (if a bone has no influence, its weight will be zero)
-		f4& weights = this->boneWeights[i];
-		// create the skinning matrix
-		mat4f skinningTransform0 = (this->posedBones[bones.x] * invBindPose[bones.x]) * weights.x;
-		mat4f skinningTransform1 = (this->posedBones[bones.y] * invBindPose[bones.y]) * weights.y;
-		mat4f skinningTransform2 = (this->posedBones[bones.z] * invBindPose[bones.z]) * weights.z;
-		mat4f skinningTransform3 = (this->posedBones[bones.w] * invBindPose[bones.w]) * weights.w;
-		// combined matrix that skins to all of the bones
-		mat4f skinningTransform = skinningTransform0 + skinningTransform1 + skinningTransform2 + skinningTransform3;
-		this->skinnedPositions[i] = multiplyPoint(skinningTransform, this->positions[i]);
-		this->skinnedNormals[i] = multiplyVector(skinningTransform, this->normals[i]);
+std::vector<f4>& Mesh::GetBoneWeights() { return this->data.GetBoneWeights(); }
+
+std::vector<unsigned int>& Mesh::GetVertexIndices() { return this->data.GetVertexIndices(); }
+
+const std::vector<f3>& Mesh::GetPositions() const { return this->data.GetPositions(); }
+
+const std::vector<f3>& Mesh::GetNormals() const { return this->data.GetNormals(); }
+
+const std::vector<f2>& Mesh::GetTextureCoords() const { return this->data.GetTextureCoords(); }
+
+const std::vector<i4>& Mesh::GetBoneIndices() const { return this->data.GetBoneIndices(); }
+
+const std::vector<f4>& Mesh::GetBoneWeights() const { return this->data.GetBoneWeights(); }
+
+const std::vector<unsigned int>& Mesh::GetVertexIndices() const { return this->data.GetVertexIndices(); }
+
+const std::vector<us4>& Mesh::GetBoneIndices16() const { return this->data.GetBoneIndices16(); }
+
+const std::vector<ub4>& Mesh::GetBoneIndices8() const { return this->data.GetBoneIndices8(); }
+
+const std::vector<us4>& Mesh::GetBoneWeights16() const { return this->data.GetBoneWeights16(); }
+
+const std::vector<ub4>& Mesh::GetBoneWeights8() const { return this->data.GetBoneWeights8(); }
+
+BoneIndexFormat Mesh::GetBoneIndexFormat() const { return this->data.GetBoneIndexFormat(); }
+
+BoneWeightFormat Mesh::GetBoneWeightFormat() const { return this->data.GetBoneWeightFormat(); }
+
+bool Mesh::SetSkinningFormat(BoneIndexFormat indexFormat, BoneWeightFormat weightFormat) {
+	return this->data.SetSkinningFormat(indexFormat, weightFormat);
+}
+
+void Mesh::GetInfluences(unsigned int vertex, i4& bonesOut, f4& weightsOut) const {
+	this->data.GetInfluences(vertex, bonesOut, weightsOut);
+}
+
+/// <summary>
+/// Fingerprint of the inputs to a skin that builds its own palette, the pose, the armature's inverse bind pose and which skinning method.
+/// The bind pose is hashed by value, an armature that is reloaded or edited in place still gets a new skin.
+/// </summary>
+static unsigned long long SkinInputFingerprint(const anim::Armature& skeleton, const anim::Pose& animatedPose, unsigned int method) {
+	unsigned long long fingerprint = animatedPose.Fingerprint();
+	if (method == 0) {
+		const std::vector<mat4f>& inverseBindPose = skeleton.GetInverseBindPose();
+		if (inverseBindPose.size() > 0) {
+			fingerprint = Fingerprint(&inverseBindPose[0], inverseBindPose.size() * sizeof(mat4f) / 4, fingerprint);
+		}
+	} else {
+		const std::vector<transforms::DualQuaternion>& inverseBindPose = skeleton.GetInverseBindPoseDualQuaternion();
+		if (inverseBindPose.size() > 0) {
+			fingerprint = Fingerprint(&inverseBindPose[0], inverseBindPose.size() * sizeof(transforms::DualQuaternion) / 4, fingerprint);
+		}
 	}
-	// tell the GPU about the work we've done
+	return Fingerprint(&method, 1, fingerprint);
+}
+
+void Mesh::Skin(anim::Armature& skeleton, anim::Pose& animatedPose) {
+	if (this->data.GetPositions().size() == 0) { return; } // no 'skin' to apply
+	// an idle character's pose doesn't change, its palette, skinned vertices and upload would all be the same as last time
+	unsigned long long fingerprint = SkinInputFingerprint(skeleton, animatedPose, 0);
+	if (this->isSkinCurrent && this->skinFingerprint == fingerprint) { return; }
+	// one [posed bone * inverse bind pose] product per bone, rather than four per vertex
+	if (!animatedPose.ToSkinningPalette(this->posedBones, this->skinningPalette, skeleton.GetInverseBindPose())) { return; }
+	if (!this->data.HasSkinningStreams()) { this->data.UpdateSkinningStreams(); }
+	this->Skin(this->skinningPalette, this->skinnedPositions, this->skinnedNormals, NULL);
 	this->positionAttribute->Set(this->skinnedPositions);
 	this->normalAttribute->Set(this->skinnedNormals);
+	this->skinFingerprint = fingerprint;
+	this->isSkinCurrent = true;
 }
 
 void Mesh::Skin(std::vector<mat4f>& posedBones) {
-	unsigned int numbVerts = this->positions.size();
-	if (numbVerts == 0) { return; } // nothing to skin
-	this->skinnedPositions.resize(numbVerts);
-	this->skinnedNormals.resize(numbVerts);
-	// skin every vertex
-	for (unsigned int i = 0; i < numbVerts; i++) {
-		i4& bones = this->boneIndices[i]; // which bones affect this vertex
-		f4& weights = this->boneWeights[i]; // how much the bones affect the vertex. Invalid bones will have a weight of zero
-		f3& vertex = this->positions[i];
-		f3 posedVertX = multiplyPoint(posedBones[bones.x], vertex);
-		f3 posedVertY = multiplyPoint(posedBones[bones.y], vertex);
-		f3 posedVertZ = multiplyPoint(posedBones[bones.z], vertex);
-		f3 posedVertW = multiplyPoint(posedBones[bones.w], vertex);
-		this->skinnedPositions[i] = (posedVertX * weights.x) +
-									(posedVertY * weights.y) +
-									(posedVertZ * weights.z) +
-									(posedVertW * weights.w);
-		f3& normal = this->normals[i];
-		f3 posedNormX = multiplyVector(posedBones[bones.x], normal);
-		f3 posedNormY = multiplyVector(posedBones[bones.y], normal);
-		f3 posedNormZ = multiplyVector(posedBones[bones.z], normal);
-		f3 posedNormW = multiplyVector(posedBones[bones.w], normal);
-		this->skinnedNormals[i] = (posedNormX * weights.x) +
-								  (posedNormY * weights.y) +
-								  (posedNormZ * weights.z) +
-								  (posedNormW * weights.w);
-	}
+	this->Skin(posedBones, NULL);
+}
+
+void Mesh::Skin(std::vector<mat4f>& posedBones, jobs::JobSystem* jobSystem) {
+	if (this->data.GetPositions().size() == 0) { return; } // nothing to skin
+	if (posedBones.size() == 0) { return; } // no pose to skin with yet
+	// hashing the palette costs far less than skinning every vertex with it
+	unsigned long long fingerprint = Fingerprint(&posedBones[0], posedBones.size() * 16, FingerprintSeed);
+	if (this->isSkinCurrent && this->skinFingerprint == fingerprint) { return; }
+	if (!this->data.HasSkinningStreams()) { this->data.UpdateSkinningStreams(); }
+	this->Skin(posedBones, this->skinnedPositions, this->skinnedNormals, jobSystem);
+	this->positionAttribute->Set(this->skinnedPositions);
+	this->normalAttribute->Set(this->skinnedNormals);
+	this->skinFingerprint = fingerprint;
+	this->isSkinCurrent = true;
+}
+
+void Mesh::SkinDualQuaternion(anim::Armature& skeleton, anim::Pose& animatedPose) {
+	if (this->data.GetPositions().size() == 0) { return; } // no 'skin' to apply
+	unsigned long long fingerprint = SkinInputFingerprint(skeleton, animatedPose, 1);
+	if (this->isSkinCurrent && this->skinFingerprint == fingerprint) { return; }
+	animatedPose.ToDualQuaternionSkinningPalette(this->posedBonesDualQuat, this->dualQuatPalette, skeleton.GetInverseBindPoseDualQuaternion());
+	if (!this->data.HasSkinningStreams()) { this->data.UpdateSkinningStreams(); }
+	this->Skin(this->dualQuatPalette, this->skinnedPositions, this->skinnedNormals, NULL);
 	this->positionAttribute->Set(this->skinnedPositions);
 	this->normalAttribute->Set(this->skinnedNormals);
+	this->skinFingerprint = fingerprint;
+	this->isSkinCurrent = true;
+}
+
+void Mesh::Skin(const std::vector<mat4f>& posedBones, std::vector<f3>& positionsOut, std::vector<f3>& normalsOut) const {
+	this->data.Skin(posedBones, positionsOut, normalsOut);
+}
+
+void Mesh::Skin(const std::vector<mat4f>& posedBones, std::vector<f3>& positionsOut, std::vector<f3>& normalsOut, jobs::JobSystem* jobSystem) const {
+	this->data.Skin(posedBones, positionsOut, normalsOut, jobSystem);
+}
+
+void Mesh::Skin(const std::vector<transforms::DualQuaternion>& palette, std::vector<f3>& positionsOut, std::vector<f3>& normalsOut, jobs::JobSystem* jobSystem) const {
+	this->data.Skin(palette, positionsOut, normalsOut, jobSystem);
 }
 
 void Mesh::SyncOpenGL() {
-	if (this->boneIndices.size() > 0) {
-		this->boneIndexAttribute->Set(this->boneIndices);
+	// the bind pose vertices are about to replace the skinned ones on the GPU
+	this->isSkinCurrent = false;
+	// the vertex data may have changed, the streams are rebuilt if the mesh is skinned on the CPU again
+	this->data.ClearSkinningStreams();
+	if (this->data.GetBoneIndices().size() > 0) {
+		this->boneIndexAttribute->Set(this->data.GetBoneIndices());
+	}
+	if (this->data.GetBoneWeights().size() > 0) {
+		this->boneWeightAttribute->Set(this->data.GetBoneWeights());
+	}
+	if (this->data.GetBoneIndices16().size() > 0) {
+		if (this->boneIndex16Attribute == NULL) { this->boneIndex16Attribute = new Attribute<us4>(); }
+		this->boneIndex16Attribute->Set(this->data.GetBoneIndices16());
+	}
+	if (this->data.GetBoneIndices8().size() > 0) {
+		if (this->boneIndex8Attribute == NULL) { this->boneIndex8Attribute = new Attribute<ub4>(); }
+		this->boneIndex8Attribute->Set(this->data.GetBoneIndices8());
 	}
-	if (this->boneWeights.size() > 0) {
-		this->boneWeightAttribute->Set(this->boneWeights);
+	if (this->data.GetBoneWeights16().size() > 0) {
+		if (this->boneWeight16Attribute == NULL) {
+			this->boneWeight16Attribute = new Attribute<us4>();
+			this->boneWeight16Attribute->SetNormalized(true);
+		}
+		this->boneWeight16Attribute->Set(this->data.GetBoneWeights16());
 	}
-	if (this->normals.size() > 0) {
-		this->normalAttribute->Set(this->normals);
+	if (this->data.GetBoneWeights8().size() > 0) {
+		if (this->boneWeight8Attribute == NULL) {
+			this->boneWeight8Attribute = new Attribute<ub4>();
+			this->boneWeight8Attribute->SetNormalized(true);
+		}
+		this->boneWeight8Attribute->Set(this->data.GetBoneWeights8());
 	}
-	if (this->positions.size() > 0) {
-		this->positionAttribute->Set(this->positions);
+	if (this->data.GetNormals().size() > 0) {
+		this->normalAttribute->Set(this->data.GetNormals());
 	}
-	if (this->textureCoords.size() > 0) {
-		this->textureCoordAttribute->Set(this->textureCoords);
+	if (this->data.GetPositions().size() > 0) {
+		this->positionAttribute->Set(this->data.GetPositions());
 	}
-	if (this->vertexIndices.size() > 0) {
-		this->vertexIndexBuffer->Set(this->vertexIndices);
+	if (this->data.GetTextureCoords().size() > 0) {
+		this->textureCoordAttribute->Set(this->data.GetTextureCoords());
 	}
+	const std::vector<unsigned int>& indices = this->data.GetVertexIndices();
+	if (indices.size() > 0 && this->data.GetPositions().size() <= 65536) {
+		// every index fits in 16 bits, the GPU reads half as much index data
+		std::vector<unsigned short> shortIndices(indices.begin(), indices.end());
+		this->vertexIndexBuffer->Set(shortIndices);
+	} else if (indices.size() > 0) {
+		this->vertexIndexBuffer->Set(indices);
+	}
+}
+
+void Mesh::UpdateSkinningStreams() {
+	this->data.UpdateSkinningStreams();
+}
+
+void Mesh::SortVerticesByInfluenceCount() {
+	this->data.SortVerticesByInfluenceCount();
+}
+
+void Mesh::WeldVertices() {
+	this->data.WeldVertices();
+}
+
+void Mesh::OptimizeVertexCache() {
+	this->data.OptimizeVertexCache();
+}
+
+void Mesh::OptimizeVertexFetch() {
+	this->data.OptimizeVertexFetch();
+}
+
+void Mesh::BuildBoneBounds(const std::vector<mat4f>& inverseBindPose, std::vector<Bounds>& boneBoundsOut) const {
+	this->data.BuildBoneBounds(inverseBindPose, boneBoundsOut);
 }
 
 void Mesh::Bind(int positionIdx, int normalIdx, int textureCoordIdx, int boneIdx, int boneWeightIdx) {
-	if (boneIdx >= 0) { this->boneIndexAttribute->BindTo(boneIdx); }
-	if (boneWeightIdx >= 0) { this->boneWeightAttribute->BindTo(boneWeightIdx); }
+	if (boneIdx >= 0) {
+		switch (this->data.GetBoneIndexFormat()) {
+		case BoneIndexFormat::Int32: this->boneIndexAttribute->BindTo(boneIdx); break;
+		case BoneIndexFormat::UInt16: if (this->boneIndex16Attribute != NULL) { this->boneIndex16Attribute->BindTo(boneIdx); } break;
+		case BoneIndexFormat::UInt8: if (this->boneIndex8Attribute != NULL) { this->boneIndex8Attribute->BindTo(boneIdx); } break;
+		}
+	}
+	if (boneWeightIdx >= 0) {
+		switch (this->data.GetBoneWeightFormat()) {
+		case BoneWeightFormat::Float32: this->boneWeightAttribute->BindTo(boneWeightIdx); break;
+		case BoneWeightFormat::UNorm16: if (this->boneWeight16Attribute != NULL) { this->boneWeight16Attribute->BindTo(boneWeightIdx); } break;
+		case BoneWeightFormat::UNorm8: if (this->boneWeight8Attribute != NULL) { this->boneWeight8Attribute->BindTo(boneWeightIdx); } break;
+		}
+	}
 	if (normalIdx >= 0) { this->normalAttribute->BindTo(normalIdx); }
 	if (positionIdx >= 0) { this->positionAttribute->BindTo(positionIdx); }
 	if (textureCoordIdx >= 0) { this->textureCoordAttribute->BindTo(textureCoordIdx); }
 }
 
 void Mesh::UnBind(int positionIdx, int normalIdx, int textureCoordIdx, int boneIdx, int boneWeightIdx) {
+	// disabling the attribute slot is the same whichever buffer was bound to it
 	if (boneIdx >= 0) { this->boneIndexAttribute->UnBindFrom(boneIdx); }
 	if (boneWeightIdx >= 0) { this->boneWeightAttribute->UnBindFrom(boneWeightIdx); }
 	if (normalIdx >= 0) { this->normalAttribute->UnBindFrom(normalIdx); }
@@ -154,18 +280,18 @@ void Mesh::UnBind(int positionIdx, int normalIdx, int textureCoordIdx, int boneI
 }
 
 void Mesh::Draw() {
-	if (this->vertexIndices.size() > 0) {
+	if (this->data.GetVertexIndices().size() > 0) {
 		render::Draw(*this->vertexIndexBuffer, DrawMode::Triangles);
 	} else {
-		render::Draw(this->positions.size(), DrawMode::Triangles);
+		render::Draw(this->data.GetPositions().size(), DrawMode::Triangles);
 	}
 }
 
 void Mesh::DrawInstanced(unsigned int numbInstances) {
-	if (this->vertexIndices.size() > 0) {
+	if (this->data.GetVertexIndices().size() > 0) {
 		render::DrawInstanced(*this->vertexIndexBuffer, DrawMode::Triangles, numbInstances);
 	} 	else {
-		render::DrawInstanced(this->positions.size(), DrawMode::Triangles, numbInstances);
+		render::DrawInstanced(this->data.GetPositions().size(), DrawMode::Triangles, numbInstances);
 	}
 }
 
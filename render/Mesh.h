@@ -6,24 +6,22 @@
 #include "../Mat4f.h"
 #include "Attribute.h"
 #include "IndexBuffer.h"
+#include "MeshData.h"
 #include "../animation/Armature.h"
 #include "../animation/Pose.h"
+#include "../transforms/DualQuaternion.h"
+#include "../jobs/JobSystem.h"
 
 namespace render {
 
 	/// <summary>
 	/// A mesh stores the vertices and their attributes of a 3D model.
+	/// The vertices and CPU skinning live in a MeshData, the mesh adds the OpenGL buffers they are uploaded to.
 	/// </summary>
 	class Mesh {
 	protected:
 		// CPU data...
-		std::vector<f3> positions;
-		std::vector<f3> normals;
-		std::vector<f2> textureCoords;
-		std::vector<i4> boneIndices;
-		std::vector<f4> boneWeights;
-		// Vertex indices are optional.
-		std::vector<unsigned int> vertexIndices;
+		MeshData data;
 	protected:
 		// ...is synchronised with GPU data.
 		Attribute<f3>* positionAttribute;
@@ -31,6 +29,11 @@ namespace render {
 		Attribute<f2>* textureCoordAttribute;
 		Attribute<i4>* boneIndexAttribute;
 		Attribute<f4>* boneWeightAttribute;
+		// Compact skinning attributes are only made once a mesh uses them
+		Attribute<us4>* boneIndex16Attribute;
+		Attribute<ub4>* boneIndex8Attribute;
+		Attribute<us4>* boneWeight16Attribute;
+		Attribute<ub4>* boneWeight8Attribute;
 		// Vertex indices are optional.
 		IndexBuffer* vertexIndexBuffer;
 	protected:
@@ -41,12 +44,32 @@ namespace render {
 		/// Each bone in world space converted into mat4f, from an animated pose.
 		/// </summary>
 		std::vector<mat4f> posedBones;
+		/// <summary>
+		/// posedBones[bone] * invBindPose[bone], built once per skin instead of once per vertex
+		/// </summary>
+		std::vector<mat4f> skinningPalette;
+		// Information needed to perform CPU side dual quaternion skinning
+		std::vector<transforms::DualQuaternion> posedBonesDualQuat;
+		std::vector<transforms::DualQuaternion> dualQuatPalette;
+		/// <summary>
+		/// Fingerprint of what the uploaded skinned vertices were made from, a skin with the same inputs is skipped
+		/// </summary>
+		unsigned long long skinFingerprint;
+		/// <summary>
+		/// False until the mesh is skinned, and after SyncOpenGL uploads the bind pose vertices
+		/// </summary>
+		bool isSkinCurrent;
 	public:
 		/// <summary>
 		/// Default Constructor
 		/// </summary>
 		Mesh();
 		/// <summary>
+		/// Make a mesh from CPU data, e.g. data loaded by io::LoadMeshData, and upload it.
+		/// </summary>
+		/// <param name="data"></param>
+		Mesh(const MeshData& data);
+		/// <summary>
 		/// Copy Constructor
 		/// </summary>
 		/// <param name="other"></param>
@@ -62,15 +85,46 @@ namespace render {
 		/// </summary>
 		~Mesh();
 	public:
+		/// <summary>
+		/// The mesh's CPU data. Call SyncOpenGL after changing it.
+		/// </summary>
+		MeshData& GetData();
+		const MeshData& GetData() const;
 		std::vector<f3>& GetPositions();
 		std::vector<f3>& GetNormals();
 		std::vector<f2>& GetTextureCoords();
 		std::vector<i4>& GetBoneIndices();
 		std::vector<f4>& GetBoneWeights();
 		std::vector<unsigned int>& GetVertexIndices();
+		// read only access, so one mesh can be shared by many threads
+		const std::vector<f3>& GetPositions() const;
+		const std::vector<f3>& GetNormals() const;
+		const std::vector<f2>& GetTextureCoords() const;
+		const std::vector<i4>& GetBoneIndices() const;
+		const std::vector<f4>& GetBoneWeights() const;
+		const std::vector<unsigned int>& GetVertexIndices() const;
+		const std::vector<us4>& GetBoneIndices16() const;
+		const std::vector<ub4>& GetBoneIndices8() const;
+		const std::vector<us4>& GetBoneWeights16() const;
+		const std::vector<ub4>& GetBoneWeights8() const;
+		BoneIndexFormat GetBoneIndexFormat() const;
+		BoneWeightFormat GetBoneWeightFormat() const;
+		/// <summary>
+		/// See MeshData::SetSkinningFormat. Call SyncOpenGL afterwards.
+		/// </summary>
+		/// <param name="indexFormat"></param>
+		/// <param name="weightFormat"></param>
+		/// <returns>False if a bone index doesn't fit in the index format, the mesh is left unchanged</returns>
+		bool SetSkinningFormat(BoneIndexFormat indexFormat, BoneWeightFormat weightFormat);
+		/// <summary>
+		/// Read a vertex's bones and weights, whatever format they are stored in.
+		/// </summary>
+		void GetInfluences(unsigned int vertex, i4& bonesOut, f4& weightsOut) const;
 	public:
 		/// <summary>
 		/// Performs CPU side mesh skinning.
+		/// Builds the pose's skinning palette (see Pose::ToSkinningPalette) and skins with it.
+		/// Does nothing if the pose and the armature's inverse bind pose are the same as the last skin's (see Pose::Fingerprint).
 		/// </summary>
 		/// <param name="skeleton"></param>
 		/// <param name="animatedPose"></param>
@@ -79,14 +133,68 @@ namespace render {
 		/// Perform CPU side mesh skinning with precalculated skinning transforms
 		/// Updates the meshes internal datastructures that store skinned vertices and normals
 		/// </summary>
-		/// <param name="posedBones">The result of each bone: [animatedPose[bone] * invBindPose[bone]]</param>
+		/// <param name="posedBones">The result of each bone: [animatedPose[bone] * invBindPose[bone]], see Pose::ToSkinningPalette</param>
 		void Skin(std::vector<mat4f>& posedBones);
 		/// <summary>
+		/// Skin the mesh's internal skinned vertices on a thread pool, then upload them.
+		/// Does nothing if the palette is the same as the last skin's.
+		/// </summary>
+		/// <param name="posedBones">The result of each bone: [animatedPose[bone] * invBindPose[bone]], see Pose::ToSkinningPalette</param>
+		/// <param name="jobSystem">Skins on the calling thread if NULL</param>
+		void Skin(std::vector<mat4f>& posedBones, jobs::JobSystem* jobSystem);
+		/// <summary>
+		/// See MeshData::Skin, doesn't touch OpenGL.
+		/// </summary>
+		void Skin(const std::vector<mat4f>& posedBones, std::vector<f3>& positionsOut, std::vector<f3>& normalsOut) const;
+		/// <summary>
+		/// See MeshData::Skin, doesn't touch OpenGL.
+		/// </summary>
+		void Skin(const std::vector<mat4f>& posedBones, std::vector<f3>& positionsOut, std::vector<f3>& normalsOut, jobs::JobSystem* jobSystem) const;
+		/// <summary>
+		/// Performs CPU side dual quaternion skinning, the CPU version of skinned_dual_quat_vert.glsl.
+		/// Builds the pose's dual quaternion palette (see Pose::ToDualQuaternionSkinningPalette), skins with it and uploads the result.
+		/// Does nothing if the pose and armature are the same as the last skin's.
+		/// </summary>
+		/// <param name="skeleton"></param>
+		/// <param name="animatedPose"></param>
+		void SkinDualQuaternion(anim::Armature& skeleton, anim::Pose& animatedPose);
+		/// <summary>
+		/// See MeshData::Skin, doesn't touch OpenGL.
+		/// </summary>
+		void Skin(const std::vector<transforms::DualQuaternion>& palette, std::vector<f3>& positionsOut, std::vector<f3>& normalsOut, jobs::JobSystem* jobSystem) const;
+		/// <summary>
 		/// Synchronises the data on the GPU with the data stored in this mesh.
-		/// Should be called after skinning is completed.
+		/// Should be called after skinning is completed. Meshes with up to 65536 vertices upload 16 bit indices.
+		/// Frees the skinning streams, the next CPU skin rebuilds them from the synced data.
 		/// </summary>
 		void SyncOpenGL();
 		/// <summary>
+		/// Rebuild the skinning streams that the SIMD skinning kernels read from.
+		/// The Skin functions that skin the mesh's own vertices build them on their first call, SyncOpenGL frees them.
+		/// Call it before skinning through the const Skin functions (e.g. meshes shared by an AnimationWorld's threads), they can't build them.
+		/// </summary>
+		void UpdateSkinningStreams();
+		/// <summary>
+		/// See MeshData::SortVerticesByInfluenceCount. Call SyncOpenGL afterwards.
+		/// </summary>
+		void SortVerticesByInfluenceCount();
+		/// <summary>
+		/// See MeshData::WeldVertices. Call SyncOpenGL afterwards.
+		/// </summary>
+		void WeldVertices();
+		/// <summary>
+		/// See MeshData::OptimizeVertexCache. Call SyncOpenGL afterwards.
+		/// </summary>
+		void OptimizeVertexCache();
+		/// <summary>
+		/// See MeshData::OptimizeVertexFetch. Call SyncOpenGL afterwards.
+		/// </summary>
+		void OptimizeVertexFetch();
+		/// <summary>
+		/// See MeshData::BuildBoneBounds.
+		/// </summary>
+		void BuildBoneBounds(const std::vector<mat4f>& inverseBindPose, std::vector<Bounds>& boneBoundsOut) const;
+		/// <summary>
 		/// TODO document what this function does...
 		/// </summary>
 		/// <param name="positionIdx">TODO</param>
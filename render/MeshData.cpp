@@ -0,0 +1,751 @@
+#include "MeshData.h"
+#include <cmath>
+#include <climits>
+#include <algorithm>
+#include <iostream>
+#include "../Fingerprint.h"
+
+namespace render {
+
+MeshData::MeshData() {
+	this->boneIndexFormat = BoneIndexFormat::Int32;
+	this->boneWeightFormat = BoneWeightFormat::Float32;
+}
+
+std::vector<f3>& MeshData::GetPositions() { return this->positions; }
+
+std::vector<f3>& MeshData::GetNormals() { return this->normals; }
+
+std::vector<f2>& MeshData::GetTextureCoords() { return this->textureCoords; }
+
+std::vector<i4>& MeshData::GetBoneIndices() { return this->boneIndices; }
+
+std::vector<f4>& MeshData::GetBoneWeights() { return this->boneWeights; }
+
+std::vector<unsigned int>& MeshData::GetVertexIndices() { return this->vertexIndices; }
+
+const std::vector<f3>& MeshData::GetPositions() const { return this->positions; }
+
+const std::vector<f3>& MeshData::GetNormals() const { return this->normals; }
+
+const std::vector<f2>& MeshData::GetTextureCoords() const { return this->textureCoords; }
+
+const std::vector<i4>& MeshData::GetBoneIndices() const { return this->boneIndices; }
+
+const std::vector<f4>& MeshData::GetBoneWeights() const { return this->boneWeights; }
+
+const std::vector<unsigned int>& MeshData::GetVertexIndices() const { return this->vertexIndices; }
+
+const std::vector<us4>& MeshData::GetBoneIndices16() const { return this->boneIndices16; }
+
+const std::vector<ub4>& MeshData::GetBoneIndices8() const { return this->boneIndices8; }
+
+const std::vector<us4>& MeshData::GetBoneWeights16() const { return this->boneWeights16; }
+
+const std::vector<ub4>& MeshData::GetBoneWeights8() const { return this->boneWeights8; }
+
+BoneIndexFormat MeshData::GetBoneIndexFormat() const { return this->boneIndexFormat; }
+
+BoneWeightFormat MeshData::GetBoneWeightFormat() const { return this->boneWeightFormat; }
+
+void MeshData::GetInfluences(unsigned int vertex, i4& bonesOut, f4& weightsOut) const {
+	switch (this->boneIndexFormat) {
+	case BoneIndexFormat::Int32: bonesOut = this->boneIndices[vertex]; break;
+	case BoneIndexFormat::UInt16: {
+		const us4& bones = this->boneIndices16[vertex];
+		bonesOut = i4(bones.x, bones.y, bones.z, bones.w);
+		break;
+	}
+	case BoneIndexFormat::UInt8: {
+		const ub4& bones = this->boneIndices8[vertex];
+		bonesOut = i4(bones.x, bones.y, bones.z, bones.w);
+		break;
+	}
+	}
+	switch (this->boneWeightFormat) {
+	case BoneWeightFormat::Float32: weightsOut = this->boneWeights[vertex]; break;
+	case BoneWeightFormat::UNorm16: {
+		const us4& weights = this->boneWeights16[vertex];
+		const float scale = 1.0f / 65535.0f;
+		weightsOut = f4(weights.x * scale, weights.y * scale, weights.z * scale, weights.w * scale);
+		break;
+	}
+	case BoneWeightFormat::UNorm8: {
+		const ub4& weights = this->boneWeights8[vertex];
+		const float scale = 1.0f / 255.0f;
+		weightsOut = f4(weights.x * scale, weights.y * scale, weights.z * scale, weights.w * scale);
+		break;
+	}
+	}
+}
+
+/// <summary>
+/// Quantize four weights into integers that add up to exactly 'total' (largest remainder rounding).
+/// </summary>
+static void QuantizeWeights(const f4& weights, unsigned int total, unsigned int out[4]) {
+	float sum = 0.0f;
+	for (unsigned int i = 0; i < 4; i++) {
+		sum += weights.v[i] > 0.0f ? weights.v[i] : 0.0f;
+	}
+	if (sum <= 0.0f) {
+		// no weights at all, give the whole vertex to its first bone
+		out[0] = total; out[1] = 0; out[2] = 0; out[3] = 0;
+		return;
+	}
+	float remainder[4];
+	unsigned int assigned = 0;
+	for (unsigned int i = 0; i < 4; i++) {
+		float scaled = (weights.v[i] > 0.0f ? weights.v[i] : 0.0f) / sum * total;
+		out[i] = (unsigned int) scaled;
+		if (out[i] > total) { out[i] = total; }
+		remainder[i] = scaled - out[i];
+		assigned += out[i];
+	}
+	while (assigned < total) {
+		unsigned int largest = 0;
+		for (unsigned int i = 1; i < 4; i++) {
+			if (remainder[i] > remainder[largest]) { largest = i; }
+		}
+		out[largest]++;
+		remainder[largest] = -1.0f;
+		assigned++;
+	}
+	while (assigned > total) {
+		// float rounding overshot, take the step back from the biggest weight
+		unsigned int biggest = 0;
+		for (unsigned int i = 1; i < 4; i++) {
+			if (out[i] > out[biggest]) { biggest = i; }
+		}
+		out[biggest]--;
+		assigned--;
+	}
+}
+
+bool MeshData::SetSkinningFormat(BoneIndexFormat indexFormat, BoneWeightFormat weightFormat) {
+	unsigned int numbVerts = this->positions.size();
+	unsigned int numbSkinned = 0;
+	switch (this->boneIndexFormat) {
+	case BoneIndexFormat::Int32: numbSkinned = this->boneIndices.size(); break;
+	case BoneIndexFormat::UInt16: numbSkinned = this->boneIndices16.size(); break;
+	case BoneIndexFormat::UInt8: numbSkinned = this->boneIndices8.size(); break;
+	}
+	if (numbSkinned != numbVerts) {
+		std::cout << "mesh skinning format: the mesh doesn't have bone data for every vertex\n";
+		return false;
+	}
+	// decode everything, then check it fits before changing anything
+	std::vector<i4> bones(numbVerts);
+	std::vector<f4> weights(numbVerts);
+	int largestBone = 0;
+	for (unsigned int i = 0; i < numbVerts; i++) {
+		this->GetInfluences(i, bones[i], weights[i]);
+		for (unsigned int slot = 0; slot < 4; slot++) {
+			if (bones[i].v[slot] > largestBone) { largestBone = bones[i].v[slot]; }
+		}
+	}
+	if ((indexFormat == BoneIndexFormat::UInt8 && largestBone > 255) || (indexFormat == BoneIndexFormat::UInt16 && largestBone > 65535)) {
+		std::cout << "mesh skinning format: bone " << largestBone << " doesn't fit in the requested index format\n";
+		return false;
+	}
+	// bone indices
+	std::vector<i4>().swap(this->boneIndices);
+	std::vector<us4>().swap(this->boneIndices16);
+	std::vector<ub4>().swap(this->boneIndices8);
+	switch (indexFormat) {
+	case BoneIndexFormat::Int32: bones.swap(this->boneIndices); break;
+	case BoneIndexFormat::UInt16:
+		this->boneIndices16.resize(numbVerts);
+		for (unsigned int i = 0; i < numbVerts; i++) {
+			this->boneIndices16[i] = us4((unsigned short) bones[i].x, (unsigned short) bones[i].y, (unsigned short) bones[i].z, (unsigned short) bones[i].w);
+		}
+		break;
+	case BoneIndexFormat::UInt8:
+		this->boneIndices8.resize(numbVerts);
+		for (unsigned int i = 0; i < numbVerts; i++) {
+			this->boneIndices8[i] = ub4((unsigned char) bones[i].x, (unsigned char) bones[i].y, (unsigned char) bones[i].z, (unsigned char) bones[i].w);
+		}
+		break;
+	}
+	// bone weights
+	std::vector<f4>().swap(this->boneWeights);
+	std::vector<us4>().swap(this->boneWeights16);
+	std::vector<ub4>().swap(this->boneWeights8);
+	unsigned int quantized[4];
+	switch (weightFormat) {
+	case BoneWeightFormat::Float32: weights.swap(this->boneWeights); break;
+	case BoneWeightFormat::UNorm16:
+		this->boneWeights16.resize(numbVerts);
+		for (unsigned int i = 0; i < numbVerts; i++) {
+			QuantizeWeights(weights[i], 65535, quantized);
+			this->boneWeights16[i] = us4((unsigned short) quantized[0], (unsigned short) quantized[1], (unsigned short) quantized[2], (unsigned short) quantized[3]);
+		}
+		break;
+	case BoneWeightFormat::UNorm8:
+		this->boneWeights8.resize(numbVerts);
+		for (unsigned int i = 0; i < numbVerts; i++) {
+			QuantizeWeights(weights[i], 255, quantized);
+			this->boneWeights8[i] = ub4((unsigned char) quantized[0], (unsigned char) quantized[1], (unsigned char) quantized[2], (unsigned char) quantized[3]);
+		}
+		break;
+	}
+	this->boneIndexFormat = indexFormat;
+	this->boneWeightFormat = weightFormat;
+	return true;
+}
+
+void MeshData::Skin(const std::vector<mat4f>& posedBones, std::vector<f3>& positionsOut, std::vector<f3>& normalsOut) const {
+	this->Skin(posedBones, positionsOut, normalsOut, NULL);
+}
+
+/// <summary>
+/// Vertices per skinning job. A chunk's input streams and output vertices (about 80 bytes a vertex) fit in a core's L2 cache,
+/// and a chunk is big enough that the cost of scheduling the job disappears.
+/// </summary>
+static const unsigned int skinningChunkSize = 1024;
+
+void MeshData::Skin(const std::vector<mat4f>& posedBones, std::vector<f3>& positionsOut, std::vector<f3>& normalsOut, jobs::JobSystem* jobSystem) const {
+	unsigned int numbVerts = this->positions.size();
+	if (positionsOut.size() != numbVerts) { positionsOut.resize(numbVerts); }
+	if (normalsOut.size() != numbVerts) { normalsOut.resize(numbVerts); }
+	if (numbVerts == 0) { return; }
+	f3* positionsWrite = &positionsOut[0];
+	f3* normalsWrite = &normalsOut[0];
+	if (this->skinningStreams.Size() != numbVerts) {
+		// the vertex data changed without the streams being rebuilt
+		this->SkinReference(posedBones, 0, numbVerts, positionsWrite, normalsWrite);
+		return;
+	}
+	SkinningKernel kernel = GetSkinningKernel();
+	const mat4f* palette = &posedBones[0];
+	if (jobSystem == NULL || numbVerts <= skinningChunkSize) {
+		SkinVertices(kernel, this->skinningStreams, palette, 0, numbVerts, positionsWrite, normalsWrite);
+	} else {
+		// every vertex is written by exactly one chunk, so the chunks don't need to synchronize
+		const SkinningStreams& streams = this->skinningStreams;
+		auto skinChunk = [&](unsigned int begin, unsigned int end) {
+			SkinVertices(kernel, streams, palette, begin, end, positionsWrite, normalsWrite);
+		};
+		jobSystem->ParallelFor(numbVerts, skinningChunkSize, skinChunk);
+	}
+}
+
+void MeshData::SkinReference(const std::vector<mat4f>& posedBones, unsigned int begin, unsigned int end, f3* positionsOut, f3* normalsOut) const {
+	// skin every vertex
+	for (unsigned int i = begin; i < end; i++) {
+		i4 bones; // which bones affect this vertex
+		f4 weights; // how much the bones affect the vertex. Invalid bones will have a weight of zero
+		this->GetInfluences(i, bones, weights);
+		const f3& vertex = this->positions[i];
+		f3 posedVertX = multiplyPoint(posedBones[bones.x], vertex);
+		f3 posedVertY = multiplyPoint(posedBones[bones.y], vertex);
+		f3 posedVertZ = multiplyPoint(posedBones[bones.z], vertex);
+		f3 posedVertW = multiplyPoint(posedBones[bones.w], vertex);
+		positionsOut[i] = (posedVertX * weights.x) +
+						  (posedVertY * weights.y) +
+						  (posedVertZ * weights.z) +
+						  (posedVertW * weights.w);
+		const f3& normal = this->normals[i];
+		f3 posedNormX = multiplyVector(posedBones[bones.x], normal);
+		f3 posedNormY = multiplyVector(posedBones[bones.y], normal);
+		f3 posedNormZ = multiplyVector(posedBones[bones.z], normal);
+		f3 posedNormW = multiplyVector(posedBones[bones.w], normal);
+		normalsOut[i] = (posedNormX * weights.x) +
+						(posedNormY * weights.y) +
+						(posedNormZ * weights.z) +
+						(posedNormW * weights.w);
+	}
+}
+
+void MeshData::Skin(const std::vector<transforms::DualQuaternion>& palette, std::vector<f3>& positionsOut, std::vector<f3>& normalsOut, jobs::JobSystem* jobSystem) const {
+	unsigned int numbVerts = this->positions.size();
+	if (positionsOut.size() != numbVerts) { positionsOut.resize(numbVerts); }
+	if (normalsOut.size() != numbVerts) { normalsOut.resize(numbVerts); }
+	if (numbVerts == 0) { return; }
+	f3* positionsWrite = &positionsOut[0];
+	f3* normalsWrite = &normalsOut[0];
+	if (this->skinningStreams.Size() != numbVerts) {
+		// the vertex data changed without the streams being rebuilt
+		this->SkinReference(palette, 0, numbVerts, positionsWrite, normalsWrite);
+		return;
+	}
+	SkinningKernel kernel = GetSkinningKernel();
+	const transforms::DualQuaternion* dualQuats = &palette[0];
+	if (jobSystem == NULL || numbVerts <= skinningChunkSize) {
+		SkinVerticesDualQuaternion(kernel, this->skinningStreams, dualQuats, 0, numbVerts, positionsWrite, normalsWrite);
+	} else {
+		const SkinningStreams& streams = this->skinningStreams;
+		auto skinChunk = [&](unsigned int begin, unsigned int end) {
+			SkinVerticesDualQuaternion(kernel, streams, dualQuats, begin, end, positionsWrite, normalsWrite);
+		};
+		jobSystem->ParallelFor(numbVerts, skinningChunkSize, skinChunk);
+	}
+}
+
+void MeshData::SkinReference(const std::vector<transforms::DualQuaternion>& palette, unsigned int begin, unsigned int end, f3* positionsOut, f3* normalsOut) const {
+	for (unsigned int i = begin; i < end; i++) {
+		i4 bones;
+		f4 weights;
+		this->GetInfluences(i, bones, weights);
+		const transforms::DualQuaternion& first = palette[bones.x];
+		transforms::DualQuaternion blended = first * weights.x;
+		for (unsigned int influence = 1; influence < 4; influence++) {
+			const transforms::DualQuaternion& other = palette[bones.v[influence]];
+			// neighborhood the rotations, like skinned_dual_quat_vert.glsl
+			float weight = transforms::dot(first, other) < 0.0f ? -weights.v[influence] : weights.v[influence];
+			blended = blended + other * weight;
+		}
+		transforms::normalize(blended);
+		positionsOut[i] = transforms::applyPoint(blended, this->positions[i]);
+		normalsOut[i] = transforms::applyVector(blended, this->normals[i]);
+	}
+}
+
+void MeshData::UpdateSkinningStreams() {
+	this->BuildSkinningStreams(this->skinningStreams);
+}
+
+bool MeshData::HasSkinningStreams() const {
+	return this->positions.size() > 0 && this->skinningStreams.Size() == this->positions.size();
+}
+
+void MeshData::ClearSkinningStreams() {
+	this->skinningStreams = SkinningStreams();
+}
+
+void MeshData::BuildSkinningStreams(SkinningStreams& streamsOut) const {
+	if (this->boneIndexFormat == BoneIndexFormat::Int32 && this->boneWeightFormat == BoneWeightFormat::Float32) {
+		streamsOut.Build(this->positions, this->normals, this->boneIndices, this->boneWeights);
+		return;
+	}
+	// the kernels read floats, so compact meshes are decoded into the streams
+	unsigned int numbVerts = this->positions.size();
+	std::vector<i4> bones(numbVerts);
+	std::vector<f4> weights(numbVerts);
+	bool hasSkinningData = (this->boneIndices.size() + this->boneIndices16.size() + this->boneIndices8.size()) == numbVerts &&
+		(this->boneWeights.size() + this->boneWeights16.size() + this->boneWeights8.size()) == numbVerts;
+	if (hasSkinningData) {
+		for (unsigned int i = 0; i < numbVerts; i++) {
+			this->GetInfluences(i, bones[i], weights[i]);
+		}
+	}
+	streamsOut.Build(this->positions, this->normals, bones, weights);
+}
+
+static const char* KernelName(SkinningKernel kernel) {
+	switch (kernel) {
+	case SkinningKernel::Scalar: return "scalar";
+	case SkinningKernel::SSE: return "SSE";
+	case SkinningKernel::AVX2: return "AVX2";
+	}
+	return "unknown";
+}
+
+/// <summary>
+/// Compare a kernel's skinned vertices with the reference loop's, printing the first vertex that is off by more than rounding.
+/// </summary>
+/// <returns>True if every vertex matches</returns>
+static bool MatchesReference(const char* method, SkinningKernel kernel, const std::vector<f3>& positions, const std::vector<f3>& normals, const std::vector<f3>& referencePositions, const std::vector<f3>& referenceNormals) {
+	const float tolerance = 1e-3f;
+	unsigned int numbVerts = positions.size();
+	for (unsigned int i = 0; i < numbVerts; i++) {
+		f3 positionError = positions[i] - referencePositions[i];
+		f3 normalError = normals[i] - referenceNormals[i];
+		float scale = 1.0f + fabsf(referencePositions[i].x) + fabsf(referencePositions[i].y) + fabsf(referencePositions[i].z);
+		float error = fabsf(positionError.x) + fabsf(positionError.y) + fabsf(positionError.z);
+		float normalScale = 1.0f + fabsf(referenceNormals[i].x) + fabsf(referenceNormals[i].y) + fabsf(referenceNormals[i].z);
+		float normalErrorSum = fabsf(normalError.x) + fabsf(normalError.y) + fabsf(normalError.z);
+		if (error > tolerance * scale || normalErrorSum > tolerance * normalScale) {
+			std::cout << "the " << KernelName(kernel) << " " << method << " skinning kernel doesn't match the reference skinning at vertex " << i << "\n";
+			return false;
+		}
+	}
+	return true;
+}
+
+unsigned int MeshData::VerifySkinningKernels(const std::vector<mat4f>& posedBones) const {
+	SkinningStreams streams;
+	this->BuildSkinningStreams(streams);
+	unsigned int numbVerts = streams.Size();
+	if (numbVerts == 0) { return 0; } // nothing the kernels can skin
+	// the kernels blend the matrices before transforming, the reference blends the transformed vertices, so only expect rounding level differences
+	std::vector<f3> referencePositions(numbVerts), referenceNormals(numbVerts);
+	this->SkinReference(posedBones, 0, numbVerts, &referencePositions[0], &referenceNormals[0]);
+	std::vector<f3> positionsOut(numbVerts), normalsOut(numbVerts);
+	unsigned int numbFailed = 0;
+	unsigned int widest = (unsigned int) GetWidestSkinningKernel();
+	for (unsigned int i = 0; i <= widest; i++) {
+		SkinningKernel kernel = (SkinningKernel) i;
+		SkinVertices(kernel, streams, &posedBones[0], 0, numbVerts, &positionsOut[0], &normalsOut[0]);
+		if (!MatchesReference("linear blend", kernel, positionsOut, normalsOut, referencePositions, referenceNormals)) { numbFailed++; }
+	}
+	return numbFailed;
+}
+
+unsigned int MeshData::VerifySkinningKernels(const std::vector<transforms::DualQuaternion>& palette) const {
+	SkinningStreams streams;
+	this->BuildSkinningStreams(streams);
+	unsigned int numbVerts = streams.Size();
+	if (numbVerts == 0) { return 0; }
+	std::vector<f3> referencePositions(numbVerts), referenceNormals(numbVerts);
+	this->SkinReference(palette, 0, numbVerts, &referencePositions[0], &referenceNormals[0]);
+	std::vector<f3> positionsOut(numbVerts), normalsOut(numbVerts);
+	unsigned int numbFailed = 0;
+	unsigned int widest = (unsigned int) GetWidestSkinningKernel();
+	for (unsigned int i = 0; i <= widest; i++) {
+		SkinningKernel kernel = (SkinningKernel) i;
+		SkinVerticesDualQuaternion(kernel, streams, &palette[0], 0, numbVerts, &positionsOut[0], &normalsOut[0]);
+		if (!MatchesReference("dual quaternion", kernel, positionsOut, normalsOut, referencePositions, referenceNormals)) { numbFailed++; }
+	}
+	return numbFailed;
+}
+
+template<typename T>
+static void ReorderVertices(std::vector<T>& data, const std::vector<unsigned int>& newIndexOf) {
+	if (data.size() != newIndexOf.size()) { return; } // the attribute isn't per vertex, leave it alone
+	std::vector<T> reordered(data.size());
+	for (unsigned int i = 0; i < data.size(); i++) {
+		reordered[newIndexOf[i]] = data[i];
+	}
+	data.swap(reordered);
+}
+
+void MeshData::SortVerticesByInfluenceCount() {
+	BoneIndexFormat indexFormat = this->boneIndexFormat;
+	BoneWeightFormat weightFormat = this->boneWeightFormat;
+	if (indexFormat != BoneIndexFormat::Int32 || weightFormat != BoneWeightFormat::Float32) {
+		// sort the full precision data, then put it back into the compact format. Requantizing gives back the same integers.
+		if (!this->SetSkinningFormat(BoneIndexFormat::Int32, BoneWeightFormat::Float32)) { return; }
+		this->SortVerticesByInfluenceCount();
+		this->SetSkinningFormat(indexFormat, weightFormat);
+		return;
+	}
+	unsigned int numbVerts = this->positions.size();
+	if (numbVerts == 0 || this->boneIndices.size() != numbVerts || this->boneWeights.size() != numbVerts) { return; }
+	// move the weighted influences to the front, so a vertex that uses n bones only needs its first n slots
+	unsigned int groupSize[4] = { 0, 0, 0, 0 };
+	for (unsigned int i = 0; i < numbVerts; i++) {
+		i4 bones;
+		f4 weights;
+		unsigned int used = 0;
+		for (unsigned int slot = 0; slot < 4; slot++) {
+			if (this->boneWeights[i].v[slot] == 0.0f) { continue; }
+			bones.v[used] = this->boneIndices[i].v[slot];
+			weights.v[used] = this->boneWeights[i].v[slot];
+			used++;
+		}
+		this->boneIndices[i] = bones;
+		this->boneWeights[i] = weights;
+		groupSize[InfluenceCount(weights) - 1]++;
+	}
+	// counting sort, stable so vertices that were close together stay close together
+	unsigned int next[4];
+	next[0] = 0;
+	for (unsigned int group = 1; group < 4; group++) {
+		next[group] = next[group - 1] + groupSize[group - 1];
+	}
+	std::vector<unsigned int> newIndexOf(numbVerts);
+	for (unsigned int i = 0; i < numbVerts; i++) {
+		newIndexOf[i] = next[InfluenceCount(this->boneWeights[i]) - 1]++;
+	}
+	ReorderVertices(this->positions, newIndexOf);
+	ReorderVertices(this->normals, newIndexOf);
+	ReorderVertices(this->textureCoords, newIndexOf);
+	ReorderVertices(this->boneIndices, newIndexOf);
+	ReorderVertices(this->boneWeights, newIndexOf);
+	if (this->vertexIndices.size() == 0) {
+		// the mesh was drawn in vertex order, index it so the triangles survive the reorder
+		this->vertexIndices = newIndexOf;
+	} else {
+		unsigned int numbIndices = this->vertexIndices.size();
+		for (unsigned int i = 0; i < numbIndices; i++) {
+			this->vertexIndices[i] = newIndexOf[this->vertexIndices[i]];
+		}
+	}
+}
+
+template<typename T>
+static void RemapVertexArray(std::vector<T>& data, const std::vector<unsigned int>& newIndexOf, unsigned int numbVertsAfter) {
+	if (data.size() != newIndexOf.size()) { return; } // the attribute isn't per vertex, leave it alone
+	std::vector<T> remapped(numbVertsAfter);
+	for (unsigned int i = 0; i < data.size(); i++) {
+		if (newIndexOf[i] >= numbVertsAfter) { continue; }
+		remapped[newIndexOf[i]] = data[i];
+	}
+	data.swap(remapped);
+}
+
+void MeshData::RemapVertices(const std::vector<unsigned int>& newIndexOf, unsigned int numbVertsAfter) {
+	RemapVertexArray(this->positions, newIndexOf, numbVertsAfter);
+	RemapVertexArray(this->normals, newIndexOf, numbVertsAfter);
+	RemapVertexArray(this->textureCoords, newIndexOf, numbVertsAfter);
+	RemapVertexArray(this->boneIndices, newIndexOf, numbVertsAfter);
+	RemapVertexArray(this->boneWeights, newIndexOf, numbVertsAfter);
+	RemapVertexArray(this->boneIndices16, newIndexOf, numbVertsAfter);
+	RemapVertexArray(this->boneIndices8, newIndexOf, numbVertsAfter);
+	RemapVertexArray(this->boneWeights16, newIndexOf, numbVertsAfter);
+	RemapVertexArray(this->boneWeights8, newIndexOf, numbVertsAfter);
+}
+
+bool MeshData::HasValidTriangles() const {
+	unsigned int numbIndices = this->vertexIndices.size();
+	if (numbIndices == 0 || numbIndices % 3 != 0) { return false; }
+	unsigned int numbVerts = this->positions.size();
+	for (unsigned int i = 0; i < numbIndices; i++) {
+		if (this->vertexIndices[i] >= numbVerts) {
+			std::cout << "mesh optimization: vertex index " << this->vertexIndices[i] << " is out of range, the mesh is left unchanged\n";
+			return false;
+		}
+	}
+	return true;
+}
+
+template<typename T>
+static unsigned long long FingerprintAttribute(const std::vector<T>& data, unsigned int vertex, unsigned int numbVerts, unsigned long long fingerprint) {
+	static_assert(sizeof(T) % 4 == 0, "vertex attributes are hashed as four byte words");
+	if (data.size() != numbVerts) { return fingerprint; }
+	return Fingerprint(&data[vertex], sizeof(T) / 4, fingerprint);
+}
+
+template<typename T>
+static bool IsSameAttribute(const std::vector<T>& data, unsigned int a, unsigned int b, unsigned int numbVerts) {
+	if (data.size() != numbVerts) { return true; }
+	return memcmp(&data[a], &data[b], sizeof(T)) == 0;
+}
+
+unsigned long long MeshData::FingerprintVertex(unsigned int vertex) const {
+	unsigned int numbVerts = this->positions.size();
+	unsigned long long fingerprint = FingerprintSeed;
+	fingerprint = FingerprintAttribute(this->positions, vertex, numbVerts, fingerprint);
+	fingerprint = FingerprintAttribute(this->normals, vertex, numbVerts, fingerprint);
+	fingerprint = FingerprintAttribute(this->textureCoords, vertex, numbVerts, fingerprint);
+	fingerprint = FingerprintAttribute(this->boneIndices, vertex, numbVerts, fingerprint);
+	fingerprint = FingerprintAttribute(this->boneWeights, vertex, numbVerts, fingerprint);
+	fingerprint = FingerprintAttribute(this->boneIndices16, vertex, numbVerts, fingerprint);
+	fingerprint = FingerprintAttribute(this->boneIndices8, vertex, numbVerts, fingerprint);
+	fingerprint = FingerprintAttribute(this->boneWeights16, vertex, numbVerts, fingerprint);
+	fingerprint = FingerprintAttribute(this->boneWeights8, vertex, numbVerts, fingerprint);
+	return fingerprint;
+}
+
+bool MeshData::IsSameVertex(unsigned int a, unsigned int b) const {
+	unsigned int numbVerts = this->positions.size();
+	return IsSameAttribute(this->positions, a, b, numbVerts) &&
+		IsSameAttribute(this->normals, a, b, numbVerts) &&
+		IsSameAttribute(this->textureCoords, a, b, numbVerts) &&
+		IsSameAttribute(this->boneIndices, a, b, numbVerts) &&
+		IsSameAttribute(this->boneWeights, a, b, numbVerts) &&
+		IsSameAttribute(this->boneIndices16, a, b, numbVerts) &&
+		IsSameAttribute(this->boneIndices8, a, b, numbVerts) &&
+		IsSameAttribute(this->boneWeights16, a, b, numbVerts) &&
+		IsSameAttribute(this->boneWeights8, a, b, numbVerts);
+}
+
+void MeshData::WeldVertices() {
+	unsigned int numbVerts = this->positions.size();
+	if (numbVerts == 0) { return; }
+	if (this->vertexIndices.size() > 0 && !this->HasValidTriangles()) { return; }
+	// sort the vertices by fingerprint, duplicates end up next to each other with the first copy in front
+	std::vector<std::pair<unsigned long long, unsigned int>> byFingerprint(numbVerts);
+	for (unsigned int i = 0; i < numbVerts; i++) {
+		byFingerprint[i] = std::make_pair(this->FingerprintVertex(i), i);
+	}
+	std::sort(byFingerprint.begin(), byFingerprint.end());
+	std::vector<unsigned int> weldedTo(numbVerts);
+	unsigned int runStart = 0;
+	for (unsigned int i = 0; i < numbVerts; i++) {
+		if (byFingerprint[i].first != byFingerprint[runStart].first) { runStart = i; }
+		unsigned int vertex = byFingerprint[i].second;
+		weldedTo[vertex] = vertex;
+		// different vertices can share a fingerprint, compare against every earlier copy in the run
+		for (unsigned int j = runStart; j < i; j++) {
+			unsigned int other = byFingerprint[j].second;
+			if (weldedTo[other] == other && this->IsSameVertex(vertex, other)) {
+				weldedTo[vertex] = other;
+				break;
+			}
+		}
+	}
+	// the first copy of each vertex keeps its place in the order
+	std::vector<unsigned int> newIndexOf(numbVerts);
+	unsigned int numbWelded = 0;
+	for (unsigned int i = 0; i < numbVerts; i++) {
+		newIndexOf[i] = weldedTo[i] == i ? numbWelded++ : newIndexOf[weldedTo[i]];
+	}
+	if (this->vertexIndices.size() == 0) {
+		// the mesh was drawn in vertex order, index it so the triangles survive the weld
+		this->vertexIndices = newIndexOf;
+	} else {
+		unsigned int numbIndices = this->vertexIndices.size();
+		for (unsigned int i = 0; i < numbIndices; i++) {
+			this->vertexIndices[i] = newIndexOf[this->vertexIndices[i]];
+		}
+	}
+	if (numbWelded != numbVerts) {
+		this->RemapVertices(newIndexOf, numbWelded);
+	}
+}
+
+// Tom Forsyth's "Linear-Speed Vertex Cache Optimisation" scoring, with the constants from the paper
+static const unsigned int vertexCacheSize = 32;
+
+static float VertexCacheScore(int cachePosition, unsigned int numbTrianglesLeft) {
+	if (numbTrianglesLeft == 0) { return -1.0f; }
+	float score = 0.0f;
+	if (cachePosition >= 0) {
+		if (cachePosition < 3) {
+			// the triangle that was just drawn, a fixed score so the next triangle doesn't always reuse the same edge
+			score = 0.75f;
+		} else {
+			score = powf(1.0f - (cachePosition - 3) / (float) (vertexCacheSize - 3), 1.5f);
+		}
+	}
+	// vertices with few triangles left are finished off first, so they don't have to come back into the cache later
+	score += 2.0f * powf((float) numbTrianglesLeft, -0.5f);
+	return score;
+}
+
+void MeshData::OptimizeVertexCache() {
+	if (!this->HasValidTriangles()) { return; }
+	unsigned int numbIndices = this->vertexIndices.size();
+	unsigned int numbTriangles = numbIndices / 3;
+	unsigned int numbVerts = this->positions.size();
+	const std::vector<unsigned int>& indices = this->vertexIndices;
+	// every vertex's triangles, trianglesOf[firstTriangle[v], firstTriangle[v] + numbTrianglesLeft[v]) are the ones not drawn yet
+	std::vector<unsigned int> numbTrianglesLeft(numbVerts, 0);
+	for (unsigned int i = 0; i < numbIndices; i++) {
+		numbTrianglesLeft[indices[i]]++;
+	}
+	std::vector<unsigned int> firstTriangle(numbVerts, 0);
+	for (unsigned int v = 1; v < numbVerts; v++) {
+		firstTriangle[v] = firstTriangle[v - 1] + numbTrianglesLeft[v - 1];
+	}
+	std::vector<unsigned int> trianglesOf(numbIndices);
+	std::vector<unsigned int> filled(numbVerts, 0);
+	for (unsigned int i = 0; i < numbIndices; i++) {
+		unsigned int v = indices[i];
+		trianglesOf[firstTriangle[v] + filled[v]++] = i / 3;
+	}
+	std::vector<int> cachePosition(numbVerts, -1);
+	std::vector<float> vertexScore(numbVerts);
+	for (unsigned int v = 0; v < numbVerts; v++) {
+		vertexScore[v] = VertexCacheScore(-1, numbTrianglesLeft[v]);
+	}
+	std::vector<float> triangleScore(numbTriangles);
+	std::vector<bool> isDrawn(numbTriangles, false);
+	int bestTriangle = -1;
+	float bestScore = -1.0f;
+	for (unsigned int t = 0; t < numbTriangles; t++) {
+		triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+		if (triangleScore[t] > bestScore) {
+			bestScore = triangleScore[t];
+			bestTriangle = t;
+		}
+	}
+	std::vector<unsigned int> optimized;
+	optimized.reserve(numbIndices);
+	unsigned int cache[vertexCacheSize + 3];
+	unsigned int numbCached = 0;
+	unsigned int nextUndrawn = 0;
+	while (bestTriangle >= 0) {
+		unsigned int triangle = bestTriangle;
+		isDrawn[triangle] = true;
+		const unsigned int* corners = &indices[triangle * 3];
+		for (unsigned int c = 0; c < 3; c++) {
+			unsigned int v = corners[c];
+			optimized.push_back(v);
+			// swap the triangle out of the vertex's undrawn triangles
+			unsigned int* begin = &trianglesOf[firstTriangle[v]];
+			unsigned int last = numbTrianglesLeft[v] - 1;
+			for (unsigned int k = 0; k <= last; k++) {
+				if (begin[k] == triangle) {
+					begin[k] = begin[last];
+					begin[last] = triangle;
+					break;
+				}
+			}
+			numbTrianglesLeft[v]--;
+		}
+		// the triangle's vertices move to the front of the cache, the rest move back and the oldest fall out
+		unsigned int newCache[vertexCacheSize + 3];
+		unsigned int numbNewCached = 0;
+		for (unsigned int c = 0; c < 3; c++) {
+			bool isRepeat = false;
+			for (unsigned int k = 0; k < numbNewCached; k++) {
+				if (newCache[k] == corners[c]) { isRepeat = true; }
+			}
+			if (!isRepeat) { newCache[numbNewCached++] = corners[c]; }
+		}
+		for (unsigned int k = 0; k < numbCached; k++) {
+			unsigned int v = cache[k];
+			if (v != corners[0] && v != corners[1] && v != corners[2]) { newCache[numbNewCached++] = v; }
+		}
+		// rescore the vertices whose cache position changed, and the undrawn triangles that use them
+		bestTriangle = -1;
+		bestScore = -1.0f;
+		for (unsigned int k = 0; k < numbNewCached; k++) {
+			unsigned int v = newCache[k];
+			cachePosition[v] = k < vertexCacheSize ? (int) k : -1;
+			vertexScore[v] = VertexCacheScore(cachePosition[v], numbTrianglesLeft[v]);
+		}
+		for (unsigned int k = 0; k < numbNewCached; k++) {
+			unsigned int v = newCache[k];
+			for (unsigned int n = 0; n < numbTrianglesLeft[v]; n++) {
+				unsigned int t = trianglesOf[firstTriangle[v] + n];
+				triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+				if (triangleScore[t] > bestScore) {
+					bestScore = triangleScore[t];
+					bestTriangle = t;
+				}
+			}
+		}
+		numbCached = numbNewCached < vertexCacheSize ? numbNewCached : vertexCacheSize;
+		memcpy(cache, newCache, numbCached * sizeof(unsigned int));
+		if (bestTriangle < 0) {
+			// nothing in the cache has triangles left, start again from the next undrawn triangle
+			while (nextUndrawn < numbTriangles && isDrawn[nextUndrawn]) { nextUndrawn++; }
+			if (nextUndrawn < numbTriangles) { bestTriangle = nextUndrawn; }
+		}
+	}
+	this->vertexIndices.swap(optimized);
+}
+
+void MeshData::OptimizeVertexFetch() {
+	if (!this->HasValidTriangles()) { return; }
+	unsigned int numbVerts = this->positions.size();
+	// number the vertices in the order the triangles first use them, so drawing reads the vertex arrays front to back
+	std::vector<unsigned int> newIndexOf(numbVerts, UINT_MAX);
+	unsigned int numbUsed = 0;
+	unsigned int numbIndices = this->vertexIndices.size();
+	for (unsigned int i = 0; i < numbIndices; i++) {
+		unsigned int& index = this->vertexIndices[i];
+		if (newIndexOf[index] == UINT_MAX) { newIndexOf[index] = numbUsed++; }
+		index = newIndexOf[index];
+	}
+	// vertices no triangle uses are never drawn, but would still be skinned
+	this->RemapVertices(newIndexOf, numbUsed);
+}
+
+void MeshData::BuildBoneBounds(const std::vector<mat4f>& inverseBindPose, std::vector<Bounds>& boneBoundsOut) const {
+	unsigned int numbBones = inverseBindPose.size();
+	if (boneBoundsOut.size() < numbBones) {
+		boneBoundsOut.resize(numbBones);
+	}
+	unsigned int numbVerts = this->positions.size();
+	bool hasSkinningData = (this->boneIndices.size() + this->boneIndices16.size() + this->boneIndices8.size()) == numbVerts &&
+		(this->boneWeights.size() + this->boneWeights16.size() + this->boneWeights8.size()) == numbVerts;
+	if (!hasSkinningData) { return; }
+	for (unsigned int i = 0; i < numbVerts; i++) {
+		i4 bones;
+		f4 weights;
+		this->GetInfluences(i, bones, weights);
+		for (unsigned int influence = 0; influence < 4; influence++) {
+			// an unweighted slot doesn't move the vertex, its bone doesn't have to cover it
+			if (weights.v[influence] <= 0.0f) { continue; }
+			int bone = bones.v[influence];
+			if (bone < 0 || bone >= (int) numbBones) { continue; }
+			boneBoundsOut[bone].Grow(multiplyPoint(inverseBindPose[bone], this->positions[i]));
+		}
+	}
+}
+
+}
@@ -0,0 +1,210 @@
+#pragma once
+#include <vector>
+#include "../Vector2.h"
+#include "../Vector3.h"
+#include "../Vector4.h"
+#include "../Mat4f.h"
+#include "SkinningKernel.h"
+#include "Bounds.h"
+#include "../transforms/DualQuaternion.h"
+#include "../jobs/JobSystem.h"
+
+namespace render {
+
+	/// <summary>
+	/// How a mesh stores its per vertex bone indices, on the CPU and on the GPU.
+	/// </summary>
+	enum class BoneIndexFormat {
+		Int32, // i4, 16 bytes a vertex
+		UInt16, // us4, 8 bytes a vertex, rigs with up to 65536 bones
+		UInt8 // ub4, 4 bytes a vertex, rigs with up to 256 bones
+	};
+
+	/// <summary>
+	/// How a mesh stores its per vertex bone weights, on the CPU and on the GPU.
+	/// The normalized formats store each weight as a fraction of the integer range and always sum to exactly one.
+	/// </summary>
+	enum class BoneWeightFormat {
+		Float32, // f4, 16 bytes a vertex
+		UNorm16, // us4, 8 bytes a vertex, steps of 1/65535
+		UNorm8 // ub4, 4 bytes a vertex, steps of 1/255
+	};
+
+	/// <summary>
+	/// The CPU side of a mesh, its vertices and the skinning that runs on them.
+	/// Doesn't know about OpenGL, so meshes can be loaded and skinned in server processes and benchmarks without a GL context.
+	/// render::Mesh pairs one of these with the GPU buffers it is uploaded to.
+	/// </summary>
+	class MeshData {
+	protected:
+		std::vector<f3> positions;
+		std::vector<f3> normals;
+		std::vector<f2> textureCoords;
+		std::vector<i4> boneIndices;
+		std::vector<f4> boneWeights;
+		// Vertex indices are optional.
+		std::vector<unsigned int> vertexIndices;
+		// Compact skinning data, only one index array and one weight array is in use at a time, see SetSkinningFormat
+		std::vector<us4> boneIndices16;
+		std::vector<ub4> boneIndices8;
+		std::vector<us4> boneWeights16;
+		std::vector<ub4> boneWeights8;
+		BoneIndexFormat boneIndexFormat;
+		BoneWeightFormat boneWeightFormat;
+		/// <summary>
+		/// SIMD friendly copy of the vertex data, see UpdateSkinningStreams
+		/// </summary>
+		SkinningStreams skinningStreams;
+	protected:
+		/// <summary>
+		/// The original skinning loop, transforms the vertex by each bone and blends the results. Used when there are no skinning streams, and to check the SIMD kernels.
+		/// </summary>
+		void SkinReference(const std::vector<mat4f>& posedBones, unsigned int begin, unsigned int end, f3* positionsOut, f3* normalsOut) const;
+		/// <summary>
+		/// Dual quaternion skin one vertex at a time with transforms::DualQuaternion. Used when there are no skinning streams, and to check the SIMD kernels.
+		/// </summary>
+		void SkinReference(const std::vector<transforms::DualQuaternion>& palette, unsigned int begin, unsigned int end, f3* positionsOut, f3* normalsOut) const;
+		/// <summary>
+		/// Copy the vertex data into SIMD friendly streams, decoding compact bone data to the floats the kernels read.
+		/// </summary>
+		void BuildSkinningStreams(SkinningStreams& streamsOut) const;
+		/// <summary>
+		/// Move every per vertex array's vertex 'i' to newIndexOf[i], vertices moved to numbVertsAfter or past it are dropped.
+		/// </summary>
+		void RemapVertices(const std::vector<unsigned int>& newIndexOf, unsigned int numbVertsAfter);
+		/// <summary>
+		/// True if the vertex indices are a triangle list that only uses vertices the mesh has.
+		/// </summary>
+		bool HasValidTriangles() const;
+		/// <summary>
+		/// Hash of every per vertex attribute of a vertex, see IsSameVertex
+		/// </summary>
+		unsigned long long FingerprintVertex(unsigned int vertex) const;
+		/// <summary>
+		/// True if the two vertices have bit for bit the same attributes
+		/// </summary>
+		bool IsSameVertex(unsigned int a, unsigned int b) const;
+	public:
+		MeshData();
+	public:
+		std::vector<f3>& GetPositions();
+		std::vector<f3>& GetNormals();
+		std::vector<f2>& GetTextureCoords();
+		std::vector<i4>& GetBoneIndices();
+		std::vector<f4>& GetBoneWeights();
+		std::vector<unsigned int>& GetVertexIndices();
+		// read only access, so one mesh can be shared by many threads
+		const std::vector<f3>& GetPositions() const;
+		const std::vector<f3>& GetNormals() const;
+		const std::vector<f2>& GetTextureCoords() const;
+		const std::vector<i4>& GetBoneIndices() const;
+		const std::vector<f4>& GetBoneWeights() const;
+		const std::vector<unsigned int>& GetVertexIndices() const;
+		const std::vector<us4>& GetBoneIndices16() const;
+		const std::vector<ub4>& GetBoneIndices8() const;
+		const std::vector<us4>& GetBoneWeights16() const;
+		const std::vector<ub4>& GetBoneWeights8() const;
+		BoneIndexFormat GetBoneIndexFormat() const;
+		BoneWeightFormat GetBoneWeightFormat() const;
+		/// <summary>
+		/// Convert the mesh's bone indices and weights to another storage format. Converting to a compact format frees the i4/f4 arrays
+		/// (GetBoneIndices and GetBoneWeights become empty), converting back to Int32/Float32 restores them. Call UpdateSkinningStreams afterwards.
+		/// Weights are normalized to sum to one before they are quantized, leftover steps go to the weights that lost the most to rounding.
+		/// </summary>
+		/// <param name="indexFormat"></param>
+		/// <param name="weightFormat"></param>
+		/// <returns>False if a bone index doesn't fit in the index format, the mesh is left unchanged</returns>
+		bool SetSkinningFormat(BoneIndexFormat indexFormat, BoneWeightFormat weightFormat);
+		/// <summary>
+		/// Read a vertex's bones and weights, whatever format they are stored in.
+		/// </summary>
+		void GetInfluences(unsigned int vertex, i4& bonesOut, f4& weightsOut) const;
+	public:
+		/// <summary>
+		/// Perform CPU side mesh skinning with precalculated skinning transforms, writing the skinned vertices into caller owned arrays.
+		/// Doesn't modify the mesh, so many threads can skin the same mesh at once.
+		/// </summary>
+		/// <param name="posedBones">The result of each bone: [animatedPose[bone] * invBindPose[bone]]</param>
+		/// <param name="positionsOut">Resized to the number of vertices in the mesh</param>
+		/// <param name="normalsOut">Resized to the number of vertices in the mesh</param>
+		void Skin(const std::vector<mat4f>& posedBones, std::vector<f3>& positionsOut, std::vector<f3>& normalsOut) const;
+		/// <summary>
+		/// Skin into caller owned arrays, splitting the vertices into chunks that are skinned in parallel.
+		/// The arrays are only resized if they don't already hold one vertex each, so skinning into the same arrays every frame doesn't allocate.
+		/// </summary>
+		/// <param name="posedBones">The result of each bone: [animatedPose[bone] * invBindPose[bone]]</param>
+		/// <param name="positionsOut"></param>
+		/// <param name="normalsOut"></param>
+		/// <param name="jobSystem">Skins on the calling thread if NULL. Can be called from inside a job.</param>
+		void Skin(const std::vector<mat4f>& posedBones, std::vector<f3>& positionsOut, std::vector<f3>& normalsOut, jobs::JobSystem* jobSystem) const;
+		/// <summary>
+		/// Dual quaternion skin into caller owned arrays, the CPU version of skinned_dual_quat_vert.glsl.
+		/// Dual quaternions don't carry scale, so bone scaling is ignored, but joints don't lose volume when they twist.
+		/// </summary>
+		/// <param name="palette">The result of each bone: [invBindPose[bone] * animatedPose[bone]], see Pose::ToDualQuaternionSkinningPalette</param>
+		/// <param name="positionsOut">Only resized if it doesn't already hold one vertex each</param>
+		/// <param name="normalsOut">Only resized if it doesn't already hold one vertex each</param>
+		/// <param name="jobSystem">Skins on the calling thread if NULL. Can be called from inside a job.</param>
+		void Skin(const std::vector<transforms::DualQuaternion>& palette, std::vector<f3>& positionsOut, std::vector<f3>& normalsOut, jobs::JobSystem* jobSystem) const;
+		/// <summary>
+		/// Rebuild the skinning streams that the SIMD skinning kernels read from, a SIMD friendly copy of the vertices.
+		/// Only meshes that are skinned on the CPU need them, without them Skin falls back to the slower reference loop.
+		/// Call it after changing the vertex data, render::Mesh builds them on its first CPU skin after SyncOpenGL.
+		/// </summary>
+		void UpdateSkinningStreams();
+		/// <summary>
+		/// True if the skinning streams were built for the mesh's current number of vertices
+		/// </summary>
+		bool HasSkinningStreams() const;
+		/// <summary>
+		/// Free the skinning streams, e.g. when they are out of date or the mesh is only skinned on the GPU.
+		/// </summary>
+		void ClearSkinningStreams();
+		/// <summary>
+		/// Skin with every kernel the CPU supports and compare each with the reference skinning loop, for checking the SIMD kernels
+		/// on a real mesh and pose. Slow, it skins the whole mesh once per kernel on the calling thread and allocates.
+		/// Prints the first vertex each failing kernel gets wrong.
+		/// </summary>
+		/// <param name="posedBones">The result of each bone: [animatedPose[bone] * invBindPose[bone]]</param>
+		/// <returns>The number of kernels that don't match the reference</returns>
+		unsigned int VerifySkinningKernels(const std::vector<mat4f>& posedBones) const;
+		/// <summary>
+		/// VerifySkinningKernels for the dual quaternion kernels.
+		/// </summary>
+		/// <param name="palette">The result of each bone: [invBindPose[bone] * animatedPose[bone]], see Pose::ToDualQuaternionSkinningPalette</param>
+		/// <returns>The number of kernels that don't match the reference</returns>
+		unsigned int VerifySkinningKernels(const std::vector<transforms::DualQuaternion>& palette) const;
+		/// <summary>
+		/// Load time optimization, reorders the vertices so vertices that use one bone come first, then two, three and four bones.
+		/// Skinning then runs a kernel that only blends as many bones as each group needs.
+		/// Each vertex's weighted influences are moved to its first slots, and the vertex indices are remapped to the new order
+		/// (a mesh without indices gets indices that keep its original triangles). Call UpdateSkinningStreams afterwards.
+		/// </summary>
+		void SortVerticesByInfluenceCount();
+		/// <summary>
+		/// Load time optimization, merges vertices whose attributes are exactly the same into one vertex, so it is only skinned once.
+		/// glTF exporters often repeat a vertex for each triangle that uses it. A mesh without indices gets indices that keep its triangles.
+		/// Call UpdateSkinningStreams afterwards.
+		/// </summary>
+		void WeldVertices();
+		/// <summary>
+		/// Load time optimization, reorders the triangles so the GPU's post transform cache can reuse recently shaded vertices (Forsyth's algorithm).
+		/// Only for indexed triangle lists, the vertices themselves don't move.
+		/// </summary>
+		void OptimizeVertexCache();
+		/// <summary>
+		/// Load time optimization, renumbers the vertices in the order the triangles use them, so drawing and skinning read memory front to back.
+		/// Vertices that no triangle uses are removed. Run it after OptimizeVertexCache, and before SortVerticesByInfluenceCount which keeps
+		/// this order inside each of its groups. Call UpdateSkinningStreams afterwards.
+		/// </summary>
+		void OptimizeVertexFetch();
+		/// <summary>
+		/// Load time, grow each bone's box around the vertices it influences, measured in the bone's space.
+		/// The boxes are used by SkinnedBounds to bound the skinned mesh without skinning it.
+		/// Call it for each of a character's meshes with the same array to get boxes that cover all of them.
+		/// </summary>
+		/// <param name="inverseBindPose">Takes vertices into each bone's space, see Armature::GetInverseBindPose</param>
+		/// <param name="boneBoundsOut">Resized to one box per bone if it is smaller. Bones without vertices are left empty.</param>
+		void BuildBoneBounds(const std::vector<mat4f>& inverseBindPose, std::vector<Bounds>& boneBoundsOut) const;
+	};
+}
@@ -0,0 +1,438 @@
+#include "SkinningKernel.h"
+#include <atomic>
+#include <cmath>
+#include "../SIMD.h"
+
+namespace render {
+
+	SkinningStreams::SkinningStreams() {
+		for (unsigned int group = 0; group < 4; group++) { this->influenceEnd[group] = 0; }
+	}
+
+	void SkinningStreams::Build(const std::vector<f3>& positions, const std::vector<f3>& normals, const std::vector<i4>& boneIndices, const std::vector<f4>& boneWeights) {
+		unsigned int numbVerts = positions.size();
+		if (numbVerts == 0 || normals.size() != numbVerts || boneIndices.size() != numbVerts || boneWeights.size() != numbVerts) {
+			this->Clear();
+			return;
+		}
+		this->positionX.resize(numbVerts);
+		this->positionY.resize(numbVerts);
+		this->positionZ.resize(numbVerts);
+		this->normalX.resize(numbVerts);
+		this->normalY.resize(numbVerts);
+		this->normalZ.resize(numbVerts);
+		for (unsigned int influence = 0; influence < 4; influence++) {
+			this->boneIndex[influence].resize(numbVerts);
+			this->boneWeight[influence].resize(numbVerts);
+		}
+		for (unsigned int i = 0; i < numbVerts; i++) {
+			this->positionX[i] = positions[i].x;
+			this->positionY[i] = positions[i].y;
+			this->positionZ[i] = positions[i].z;
+			this->normalX[i] = normals[i].x;
+			this->normalY[i] = normals[i].y;
+			this->normalZ[i] = normals[i].z;
+			for (unsigned int influence = 0; influence < 4; influence++) {
+				this->boneIndex[influence][i] = boneIndices[i].v[influence];
+				this->boneWeight[influence][i] = boneWeights[i].v[influence];
+			}
+		}
+		// the specialized kernels can only be used if the vertices are sorted by how many influences they use (see Mesh::SortVerticesByInfluenceCount)
+		unsigned int previousCount = 1;
+		bool isSorted = true;
+		for (unsigned int group = 0; group < 4; group++) { this->influenceEnd[group] = 0; }
+		for (unsigned int i = 0; i < numbVerts && isSorted; i++) {
+			unsigned int count = InfluenceCount(boneWeights[i]);
+			if (count < previousCount) { isSorted = false; }
+			for (unsigned int group = count - 1; group < 4; group++) { this->influenceEnd[group] = i + 1; }
+			previousCount = count;
+		}
+		if (!isSorted) {
+			this->influenceEnd[0] = this->influenceEnd[1] = this->influenceEnd[2] = 0;
+		}
+		this->influenceEnd[3] = numbVerts;
+	}
+
+	unsigned int InfluenceCount(const f4& boneWeights) {
+		// the last slot with a weight, so the specialized kernels never drop a weighted bone
+		for (unsigned int influence = 4; influence > 1; influence--) {
+			if (boneWeights.v[influence - 1] != 0.0f) { return influence; }
+		}
+		return 1;
+	}
+
+	void SkinningStreams::Clear() {
+		for (unsigned int group = 0; group < 4; group++) { this->influenceEnd[group] = 0; }
+		this->positionX.clear();
+		this->positionY.clear();
+		this->positionZ.clear();
+		this->normalX.clear();
+		this->normalY.clear();
+		this->normalZ.clear();
+		for (unsigned int influence = 0; influence < 4; influence++) {
+			this->boneIndex[influence].clear();
+			this->boneWeight[influence].clear();
+		}
+	}
+
+	unsigned int SkinningStreams::Size() const {
+		return this->positionX.size();
+	}
+
+	// === cpu detection ===
+
+	SkinningKernel GetWidestSkinningKernel() {
+		switch (GetSIMDLevel()) {
+		case SIMDLevel::AVX2: return SkinningKernel::AVX2;
+		case SIMDLevel::SSE: return SkinningKernel::SSE;
+		default: return SkinningKernel::Scalar;
+		}
+	}
+
+	static SkinningKernel ClampToSupported(SkinningKernel kernel) {
+		SkinningKernel widest = GetWidestSkinningKernel();
+		return (int) kernel > (int) widest ? widest : kernel;
+	}
+
+	// read by every skinning thread, only written when the user picks a kernel
+	static std::atomic<int> selectedKernel((int) ClampToSupported(SkinningKernel::SSE));
+
+	SkinningKernel GetSkinningKernel() {
+		return (SkinningKernel) selectedKernel.load(std::memory_order_relaxed);
+	}
+
+	void SetSkinningKernel(SkinningKernel kernel) {
+		selectedKernel.store((int) ClampToSupported(kernel), std::memory_order_relaxed);
+	}
+
+	// === kernels ===
+
+	// Each kernel is specialized on the number of influences it blends, so vertices with fewer bones skip the unused matrices.
+	// Influences are summed in slot order, adding a zero weighted matrix doesn't change the sum, so every specialization gives
+	// the same result as the four influence kernel.
+
+	template<unsigned int INFLUENCES>
+	static void SkinScalar(const SkinningStreams& streams, const mat4f* palette, unsigned int begin, unsigned int end, f3* positionsOut, f3* normalsOut) {
+		// only the top three rows of the skinning matrices are needed
+		static const unsigned int elements[12] = { 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14 };
+		for (unsigned int i = begin; i < end; i++) {
+			const float* matrix[INFLUENCES];
+			float weight[INFLUENCES];
+			for (unsigned int influence = 0; influence < INFLUENCES; influence++) {
+				matrix[influence] = palette[streams.boneIndex[influence][i]].v;
+				weight[influence] = streams.boneWeight[influence][i];
+			}
+			float m[16];
+			for (unsigned int k = 0; k < 12; k++) {
+				unsigned int e = elements[k];
+				float sum = matrix[0][e] * weight[0];
+				for (unsigned int influence = 1; influence < INFLUENCES; influence++) {
+					sum = sum + matrix[influence][e] * weight[influence];
+				}
+				m[e] = sum;
+			}
+			float px = streams.positionX[i], py = streams.positionY[i], pz = streams.positionZ[i];
+			float nx = streams.normalX[i], ny = streams.normalY[i], nz = streams.normalZ[i];
+			positionsOut[i] = f3(
+				m[0] * px + m[4] * py + m[8] * pz + m[12],
+				m[1] * px + m[5] * py + m[9] * pz + m[13],
+				m[2] * px + m[6] * py + m[10] * pz + m[14]);
+			normalsOut[i] = f3(
+				m[0] * nx + m[4] * ny + m[8] * nz,
+				m[1] * nx + m[5] * ny + m[9] * nz,
+				m[2] * nx + m[6] * ny + m[10] * nz);
+		}
+	}
+
+#if defined(SIMD_X86)
+	template<unsigned int INFLUENCES>
+	static void SkinSSE(const SkinningStreams& streams, const mat4f* palette, unsigned int begin, unsigned int end, f3* positionsOut, f3* normalsOut) {
+		for (unsigned int i = begin; i < end; i++) {
+			const float* matrix[INFLUENCES];
+			__m128 weight[INFLUENCES];
+			for (unsigned int influence = 0; influence < INFLUENCES; influence++) {
+				matrix[influence] = palette[streams.boneIndex[influence][i]].v;
+				weight[influence] = _mm_set1_ps(streams.boneWeight[influence][i]);
+			}
+			// blend the matrices a column at a time
+			__m128 column[4];
+			for (unsigned int c = 0; c < 4; c++) {
+				__m128 sum = _mm_mul_ps(_mm_loadu_ps(matrix[0] + c * 4), weight[0]);
+				for (unsigned int influence = 1; influence < INFLUENCES; influence++) {
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(matrix[influence] + c * 4), weight[influence]));
+				}
+				column[c] = sum;
+			}
+			__m128 normal = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(column[0], _mm_set1_ps(streams.normalX[i])),
+				_mm_mul_ps(column[1], _mm_set1_ps(streams.normalY[i]))),
+				_mm_mul_ps(column[2], _mm_set1_ps(streams.normalZ[i])));
+			__m128 position = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(column[0], _mm_set1_ps(streams.positionX[i])),
+				_mm_mul_ps(column[1], _mm_set1_ps(streams.positionY[i]))),
+				_mm_mul_ps(column[2], _mm_set1_ps(streams.positionZ[i]))),
+				column[3]);
+			// f3 is only three floats wide, so a four float store would run into the next vertex
+			float result[4];
+			_mm_storeu_ps(result, position);
+			positionsOut[i] = f3(result);
+			_mm_storeu_ps(result, normal);
+			normalsOut[i] = f3(result);
+		}
+	}
+
+	template<unsigned int INFLUENCES>
+	SIMD_TARGET_AVX2
+	static void SkinAVX2(const SkinningStreams& streams, const mat4f* palette, unsigned int begin, unsigned int end, f3* positionsOut, f3* normalsOut) {
+		static const int elements[12] = { 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14 };
+		const float* base = palette[0].v;
+		unsigned int i = begin;
+		for (; i + 8 <= end; i += 8) {
+			// offset of each vertex's matrices into the palette, in floats
+			__m256i offset[INFLUENCES];
+			__m256 weight[INFLUENCES];
+			for (unsigned int influence = 0; influence < INFLUENCES; influence++) {
+				offset[influence] = _mm256_slli_epi32(_mm256_loadu_si256((const __m256i*) &streams.boneIndex[influence][i]), 4);
+				weight[influence] = _mm256_loadu_ps(&streams.boneWeight[influence][i]);
+			}
+			// one register per matrix element, each lane holds a different vertex's blended matrix
+			__m256 m[16];
+			for (unsigned int k = 0; k < 12; k++) {
+				const float* element = base + elements[k];
+				__m256 sum = _mm256_mul_ps(_mm256_i32gather_ps(element, offset[0], 4), weight[0]);
+				for (unsigned int influence = 1; influence < INFLUENCES; influence++) {
+					sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_i32gather_ps(element, offset[influence], 4), weight[influence]));
+				}
+				m[elements[k]] = sum;
+			}
+			__m256 px = _mm256_loadu_ps(&streams.positionX[i]);
+			__m256 py = _mm256_loadu_ps(&streams.positionY[i]);
+			__m256 pz = _mm256_loadu_ps(&streams.positionZ[i]);
+			__m256 nx = _mm256_loadu_ps(&streams.normalX[i]);
+			__m256 ny = _mm256_loadu_ps(&streams.normalY[i]);
+			__m256 nz = _mm256_loadu_ps(&streams.normalZ[i]);
+			float result[6][8];
+			for (unsigned int row = 0; row < 3; row++) {
+				__m256 position = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+					_mm256_mul_ps(m[row], px),
+					_mm256_mul_ps(m[4 + row], py)),
+					_mm256_mul_ps(m[8 + row], pz)),
+					m[12 + row]);
+				__m256 normal = _mm256_add_ps(_mm256_add_ps(
+					_mm256_mul_ps(m[row], nx),
+					_mm256_mul_ps(m[4 + row], ny)),
+					_mm256_mul_ps(m[8 + row], nz));
+				_mm256_storeu_ps(result[row], position);
+				_mm256_storeu_ps(result[3 + row], normal);
+			}
+			// back to the mesh's interleaved layout
+			for (unsigned int lane = 0; lane < 8; lane++) {
+				positionsOut[i + lane] = f3(result[0][lane], result[1][lane], result[2][lane]);
+				normalsOut[i + lane] = f3(result[3][lane], result[4][lane], result[5][lane]);
+			}
+		}
+		// leftover vertices that don't fill a block
+		SkinSSE<INFLUENCES>(streams, palette, i, end, positionsOut, normalsOut);
+	}
+#endif
+
+	template<unsigned int INFLUENCES>
+	static void SkinRange(SkinningKernel kernel, const SkinningStreams& streams, const mat4f* palette, unsigned int begin, unsigned int end, f3* positionsOut, f3* normalsOut) {
+		if (begin >= end) { return; }
+#if defined(SIMD_X86)
+		if (kernel == SkinningKernel::AVX2) {
+			SkinAVX2<INFLUENCES>(streams, palette, begin, end, positionsOut, normalsOut);
+			return;
+		}
+		if (kernel == SkinningKernel::SSE) {
+			SkinSSE<INFLUENCES>(streams, palette, begin, end, positionsOut, normalsOut);
+			return;
+		}
+#endif
+		SkinScalar<INFLUENCES>(streams, palette, begin, end, positionsOut, normalsOut);
+	}
+
+	void SkinVertices(SkinningKernel kernel, const SkinningStreams& streams, const mat4f* palette, unsigned int begin, unsigned int end, f3* positionsOut, f3* normalsOut) {
+		if (end > streams.Size()) { end = streams.Size(); }
+		if (begin >= end) { return; }
+		// never run a kernel the cpu can't execute
+		kernel = ClampToSupported(kernel);
+		// clip the range against each influence count's group of vertices
+		unsigned int groupBegin = 0;
+		for (unsigned int group = 0; group < 4; group++) {
+			unsigned int groupEnd = streams.influenceEnd[group];
+			unsigned int first = begin > groupBegin ? begin : groupBegin;
+			unsigned int last = end < groupEnd ? end : groupEnd;
+			switch (group) {
+			case 0: SkinRange<1>(kernel, streams, palette, first, last, positionsOut, normalsOut); break;
+			case 1: SkinRange<2>(kernel, streams, palette, first, last, positionsOut, normalsOut); break;
+			case 2: SkinRange<3>(kernel, streams, palette, first, last, positionsOut, normalsOut); break;
+			case 3: SkinRange<4>(kernel, streams, palette, first, last, positionsOut, normalsOut); break;
+			}
+			groupBegin = groupEnd;
+		}
+	}
+
+	// === dual quaternion kernels ===
+
+	// same cut off as transforms::normalize, a blend this close to zero is left as it is
+	static const float dualQuatEpsilon = 0.00001f;
+
+	template<unsigned int INFLUENCES>
+	static void SkinDualQuatScalar(const SkinningStreams& streams, const transforms::DualQuaternion* palette, unsigned int begin, unsigned int end, f3* positionsOut, f3* normalsOut) {
+		for (unsigned int i = begin; i < end; i++) {
+			const float* first = palette[streams.boneIndex[0][i]].v;
+			float weight = streams.boneWeight[0][i];
+			float q[8];
+			for (unsigned int k = 0; k < 8; k++) { q[k] = first[k] * weight; }
+			for (unsigned int influence = 1; influence < INFLUENCES; influence++) {
+				const float* other = palette[streams.boneIndex[influence][i]].v;
+				weight = streams.boneWeight[influence][i];
+				// neighborhood the rotations, see ../rotation/quaternion.h
+				float neighborhood = (first[0] * other[0] + first[1] * other[1]) + (first[2] * other[2] + first[3] * other[3]);
+				if (neighborhood < 0.0f) { weight = -weight; }
+				for (unsigned int k = 0; k < 8; k++) { q[k] = q[k] + other[k] * weight; }
+			}
+			float squared = q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3];
+			if (squared >= dualQuatEpsilon) {
+				float invMag = 1.0f / sqrtf(squared);
+				for (unsigned int k = 0; k < 8; k++) { q[k] = q[k] * invMag; }
+			}
+			float rx = q[0], ry = q[1], rz = q[2], rw = q[3];
+			float dx = q[4], dy = q[5], dz = q[6], dw = q[7];
+			// the vector part of conjugate(real) * dual * 2, see transforms::applyPoint
+			float tx = (dx * rw - dy * rz + dz * ry - dw * rx) * 2.0f;
+			float ty = (dx * rz + dy * rw - dz * rx - dw * ry) * 2.0f;
+			float tz = (dy * rx - dx * ry + dz * rw - dw * rz) * 2.0f;
+			// rotate: v * 2 dot(v, p) + p * (s * s - dot(v, v)) + cross(v, p) * 2 s
+			float realSquared = rw * rw - (rx * rx + ry * ry + rz * rz);
+			float twoW = rw * 2.0f;
+			float px = streams.positionX[i], py = streams.positionY[i], pz = streams.positionZ[i];
+			float pDot = (rx * px + ry * py + rz * pz) * 2.0f;
+			positionsOut[i] = f3(
+				rx * pDot + px * realSquared + (ry * pz - rz * py) * twoW + tx,
+				ry * pDot + py * realSquared + (rz * px - rx * pz) * twoW + ty,
+				rz * pDot + pz * realSquared + (rx * py - ry * px) * twoW + tz);
+			float nx = streams.normalX[i], ny = streams.normalY[i], nz = streams.normalZ[i];
+			float nDot = (rx * nx + ry * ny + rz * nz) * 2.0f;
+			normalsOut[i] = f3(
+				rx * nDot + nx * realSquared + (ry * nz - rz * ny) * twoW,
+				ry * nDot + ny * realSquared + (rz * nx - rx * nz) * twoW,
+				rz * nDot + nz * realSquared + (rx * ny - ry * nx) * twoW);
+		}
+	}
+
+#if defined(SIMD_X86)
+	template<unsigned int INFLUENCES>
+	static void SkinDualQuatSSE(const SkinningStreams& streams, const transforms::DualQuaternion* palette, unsigned int begin, unsigned int end, f3* positionsOut, f3* normalsOut) {
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 two = _mm_set1_ps(2.0f);
+		const __m128 signBit = _mm_set1_ps(-0.0f);
+		const __m128 epsilon = _mm_set1_ps(dualQuatEpsilon);
+		unsigned int i = begin;
+		for (; i + 4 <= end; i += 4) {
+			// q[component] holds that component of four vertices' blended dual quaternions
+			__m128 q[8];
+			__m128 first[4];
+			for (unsigned int influence = 0; influence < INFLUENCES; influence++) {
+				const int* bone = &streams.boneIndex[influence][i];
+				const float* dq0 = palette[bone[0]].v;
+				const float* dq1 = palette[bone[1]].v;
+				const float* dq2 = palette[bone[2]].v;
+				const float* dq3 = palette[bone[3]].v;
+				// each dual quaternion is loaded as a row, transposing turns the rows into one register per component
+				__m128 rx = _mm_loadu_ps(dq0), ry = _mm_loadu_ps(dq1), rz = _mm_loadu_ps(dq2), rw = _mm_loadu_ps(dq3);
+				__m128 dx = _mm_loadu_ps(dq0 + 4), dy = _mm_loadu_ps(dq1 + 4), dz = _mm_loadu_ps(dq2 + 4), dw = _mm_loadu_ps(dq3 + 4);
+				_MM_TRANSPOSE4_PS(rx, ry, rz, rw);
+				_MM_TRANSPOSE4_PS(dx, dy, dz, dw);
+				__m128 weight = _mm_loadu_ps(&streams.boneWeight[influence][i]);
+				if (influence == 0) {
+					first[0] = rx; first[1] = ry; first[2] = rz; first[3] = rw;
+					q[0] = _mm_mul_ps(rx, weight); q[1] = _mm_mul_ps(ry, weight); q[2] = _mm_mul_ps(rz, weight); q[3] = _mm_mul_ps(rw, weight);
+					q[4] = _mm_mul_ps(dx, weight); q[5] = _mm_mul_ps(dy, weight); q[6] = _mm_mul_ps(dz, weight); q[7] = _mm_mul_ps(dw, weight);
+					continue;
+				}
+				__m128 neighborhood = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(first[0], rx), _mm_mul_ps(first[1], ry)),
+					_mm_add_ps(_mm_mul_ps(first[2], rz), _mm_mul_ps(first[3], rw)));
+				weight = _mm_xor_ps(weight, _mm_and_ps(_mm_cmplt_ps(neighborhood, zero), signBit));
+				q[0] = _mm_add_ps(q[0], _mm_mul_ps(rx, weight)); q[1] = _mm_add_ps(q[1], _mm_mul_ps(ry, weight));
+				q[2] = _mm_add_ps(q[2], _mm_mul_ps(rz, weight)); q[3] = _mm_add_ps(q[3], _mm_mul_ps(rw, weight));
+				q[4] = _mm_add_ps(q[4], _mm_mul_ps(dx, weight)); q[5] = _mm_add_ps(q[5], _mm_mul_ps(dy, weight));
+				q[6] = _mm_add_ps(q[6], _mm_mul_ps(dz, weight)); q[7] = _mm_add_ps(q[7], _mm_mul_ps(dw, weight));
+			}
+			// normalize, lanes under the cut off are scaled by one
+			__m128 squared = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(q[0], q[0]), _mm_mul_ps(q[1], q[1])), _mm_mul_ps(q[2], q[2])), _mm_mul_ps(q[3], q[3]));
+			__m128 isLongEnough = _mm_cmpge_ps(squared, epsilon);
+			__m128 invMag = _mm_div_ps(one, _mm_sqrt_ps(squared));
+			invMag = _mm_or_ps(_mm_and_ps(isLongEnough, invMag), _mm_andnot_ps(isLongEnough, one));
+			__m128 rx = _mm_mul_ps(q[0], invMag), ry = _mm_mul_ps(q[1], invMag), rz = _mm_mul_ps(q[2], invMag), rw = _mm_mul_ps(q[3], invMag);
+			__m128 dx = _mm_mul_ps(q[4], invMag), dy = _mm_mul_ps(q[5], invMag), dz = _mm_mul_ps(q[6], invMag), dw = _mm_mul_ps(q[7], invMag);
+			__m128 tx = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(dx, rw), _mm_mul_ps(dy, rz)), _mm_mul_ps(dz, ry)), _mm_mul_ps(dw, rx)), two);
+			__m128 ty = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(_mm_add_ps(_mm_mul_ps(dx, rz), _mm_mul_ps(dy, rw)), _mm_mul_ps(dz, rx)), _mm_mul_ps(dw, ry)), two);
+			__m128 tz = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(dy, rx), _mm_mul_ps(dx, ry)), _mm_mul_ps(dz, rw)), _mm_mul_ps(dw, rz)), two);
+			__m128 realSquared = _mm_sub_ps(_mm_mul_ps(rw, rw), _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)), _mm_mul_ps(rz, rz)));
+			__m128 twoW = _mm_mul_ps(rw, two);
+			// rotates four vectors, adding the translation if there is one
+			auto rotate = [&](__m128 x, __m128 y, __m128 z, __m128 out[3]) {
+				__m128 twoDot = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, x), _mm_mul_ps(ry, y)), _mm_mul_ps(rz, z)), two);
+				out[0] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, twoDot), _mm_mul_ps(x, realSquared)), _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(ry, z), _mm_mul_ps(rz, y)), twoW));
+				out[1] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ry, twoDot), _mm_mul_ps(y, realSquared)), _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(rz, x), _mm_mul_ps(rx, z)), twoW));
+				out[2] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rz, twoDot), _mm_mul_ps(z, realSquared)), _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(rx, y), _mm_mul_ps(ry, x)), twoW));
+			};
+			__m128 position[3];
+			__m128 normal[3];
+			rotate(_mm_loadu_ps(&streams.positionX[i]), _mm_loadu_ps(&streams.positionY[i]), _mm_loadu_ps(&streams.positionZ[i]), position);
+			rotate(_mm_loadu_ps(&streams.normalX[i]), _mm_loadu_ps(&streams.normalY[i]), _mm_loadu_ps(&streams.normalZ[i]), normal);
+			position[0] = _mm_add_ps(position[0], tx);
+			position[1] = _mm_add_ps(position[1], ty);
+			position[2] = _mm_add_ps(position[2], tz);
+			float result[6][4];
+			for (unsigned int axis = 0; axis < 3; axis++) {
+				_mm_storeu_ps(result[axis], position[axis]);
+				_mm_storeu_ps(result[3 + axis], normal[axis]);
+			}
+			for (unsigned int lane = 0; lane < 4; lane++) {
+				positionsOut[i + lane] = f3(result[0][lane], result[1][lane], result[2][lane]);
+				normalsOut[i + lane] = f3(result[3][lane], result[4][lane], result[5][lane]);
+			}
+		}
+		// leftover vertices that don't fill a block
+		SkinDualQuatScalar<INFLUENCES>(streams, palette, i, end, positionsOut, normalsOut);
+	}
+#endif
+
+	template<unsigned int INFLUENCES>
+	static void SkinDualQuatRange(SkinningKernel kernel, const SkinningStreams& streams, const transforms::DualQuaternion* palette, unsigned int begin, unsigned int end, f3* positionsOut, f3* normalsOut) {
+		if (begin >= end) { return; }
+#if defined(SIMD_X86)
+		// there's no AVX2 dual quaternion kernel, eight wide gathers of 8 floats each cost more than they save
+		if (kernel != SkinningKernel::Scalar) {
+			SkinDualQuatSSE<INFLUENCES>(streams, palette, begin, end, positionsOut, normalsOut);
+			return;
+		}
+#endif
+		SkinDualQuatScalar<INFLUENCES>(streams, palette, begin, end, positionsOut, normalsOut);
+	}
+
+	void SkinVerticesDualQuaternion(SkinningKernel kernel, const SkinningStreams& streams, const transforms::DualQuaternion* palette, unsigned int begin, unsigned int end, f3* positionsOut, f3* normalsOut) {
+		if (end > streams.Size()) { end = streams.Size(); }
+		if (begin >= end) { return; }
+		kernel = ClampToSupported(kernel);
+		unsigned int groupBegin = 0;
+		for (unsigned int group = 0; group < 4; group++) {
+			unsigned int groupEnd = streams.influenceEnd[group];
+			unsigned int first = begin > groupBegin ? begin : groupBegin;
+			unsigned int last = end < groupEnd ? end : groupEnd;
+			switch (group) {
+			case 0: SkinDualQuatRange<1>(kernel, streams, palette, first, last, positionsOut, normalsOut); break;
+			case 1: SkinDualQuatRange<2>(kernel, streams, palette, first, last, positionsOut, normalsOut); break;
+			case 2: SkinDualQuatRange<3>(kernel, streams, palette, first, last, positionsOut, normalsOut); break;
+			case 3: SkinDualQuatRange<4>(kernel, streams, palette, first, last, positionsOut, normalsOut); break;
+			}
+			groupBegin = groupEnd;
+		}
+	}
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <vector>
+#include "../Vector3.h"
+#include "../Vector4.h"
+#include "../Mat4f.h"
+#include "../transforms/DualQuaternion.h"
+
+namespace render {
+
+	/// <summary>
+	/// A mesh's skinning inputs stored as separate streams (structure of arrays), so blocks of vertices can be loaded straight into SIMD registers.
+	/// </summary>
+	struct SkinningStreams {
+		std::vector<float> positionX;
+		std::vector<float> positionY;
+		std::vector<float> positionZ;
+		std::vector<float> normalX;
+		std::vector<float> normalY;
+		std::vector<float> normalZ;
+		/// <summary>
+		/// boneIndex[influence][vertex], four influences per vertex
+		/// </summary>
+		std::vector<int> boneIndex[4];
+		std::vector<float> boneWeight[4];
+		/// <summary>
+		/// Vertices [influenceEnd[n - 1], influenceEnd[n]) only use their first n + 1 influences.
+		/// Only meaningful when the vertices are sorted by influence count, otherwise every vertex is in the four influence group.
+		/// </summary>
+		unsigned int influenceEnd[4];
+		SkinningStreams();
+		/// <summary>
+		/// Copy a mesh's vertex data into streams. Clears the streams if the arrays don't all have one entry per vertex.
+		/// </summary>
+		void Build(const std::vector<f3>& positions, const std::vector<f3>& normals, const std::vector<i4>& boneIndices, const std::vector<f4>& boneWeights);
+		void Clear();
+		unsigned int Size() const;
+	};
+
+	/// <summary>
+	/// The number of influences a vertex needs, one more than the last slot with a non zero weight. At least one.
+	/// </summary>
+	unsigned int InfluenceCount(const f4& boneWeights);
+
+	enum class SkinningKernel {
+		Scalar, // portable fallback
+		SSE, // four wide columns, one vertex at a time
+		AVX2 // eight vertices at a time, matrices are gathered
+	};
+
+	/// <summary>
+	/// The widest kernel the CPU running the program supports. Checked once and cached.
+	/// </summary>
+	SkinningKernel GetWidestSkinningKernel();
+	/// <summary>
+	/// The kernel Mesh::Skin uses. Defaults to SSE when available: gathering eight vertices' matrices costs more than the
+	/// wider math saves on the machines we've measured, so the AVX2 kernel has to be asked for.
+	/// </summary>
+	SkinningKernel GetSkinningKernel();
+	/// <summary>
+	/// Choose the kernel Mesh::Skin uses, a kernel the CPU doesn't support falls back to the widest one it does.
+	/// </summary>
+	void SetSkinningKernel(SkinningKernel kernel);
+
+	/// <summary>
+	/// Linear blend skin a range of vertices.
+	/// Every vertex's four skinning matrices are blended by weight into one matrix first, then the position and normal are transformed by it.
+	/// Vertices are skinned by a kernel specialized for their group's influence count.
+	/// All kernels use the same order of operations, so they agree with each other to the last bit unless the compiler fuses the scalar multiply adds.
+	/// </summary>
+	/// <param name="kernel">Falls back to a slower kernel if the CPU doesn't support it</param>
+	/// <param name="streams">The vertices to skin</param>
+	/// <param name="palette">Skinning matrices, [posed bone * inverse bind pose] per bone</param>
+	/// <param name="begin">First vertex to skin</param>
+	/// <param name="end">One past the last vertex to skin</param>
+	/// <param name="positionsOut">Skinned positions, indexed by vertex</param>
+	/// <param name="normalsOut">Skinned normals, indexed by vertex</param>
+	void SkinVertices(SkinningKernel kernel, const SkinningStreams& streams, const mat4f* palette, unsigned int begin, unsigned int end, f3* positionsOut, f3* normalsOut);
+
+	/// <summary>
+	/// Dual quaternion skin a range of vertices.
+	/// Every vertex's dual quaternions are blended by weight (each flipped into the first influence's neighborhood), normalized, then applied to the position and normal.
+	/// Dual quaternions can't scale, a pose that scales its bones should be skinned with SkinVertices.
+	/// The SSE kernel skins four vertices at a time with one vertex per lane, it is also used when the AVX2 kernel is asked for.
+	/// The kernels agree with each other to the last bit unless the compiler fuses the scalar multiply adds.
+	/// </summary>
+	/// <param name="kernel">Falls back to a slower kernel if the CPU doesn't support it</param>
+	/// <param name="streams">The vertices to skin</param>
+	/// <param name="palette">Skinning dual quaternions, [inverse bind pose * posed bone] per bone, see Pose::ToDualQuaternionSkinningPalette</param>
+	/// <param name="begin">First vertex to skin</param>
+	/// <param name="end">One past the last vertex to skin</param>
+	/// <param name="positionsOut">Skinned positions, indexed by vertex</param>
+	/// <param name="normalsOut">Skinned normals, indexed by vertex</param>
+	void SkinVerticesDualQuaternion(SkinningKernel kernel, const SkinningStreams& streams, const transforms::DualQuaternion* palette, unsigned int begin, unsigned int end, f3* positionsOut, f3* normalsOut);
+}
@@ -10,7 +10,9 @@ uniform mat4 inverseBindPose[120]; // matrix to go from model space to bone loca
 in vec3 position;
 in vec3 normal;
 in vec2 textureCoordinate;
+// bone weights may be floats, or 8/16 bit unsigned normalized integers (render::BoneWeightFormat) which OpenGL converts to [0,1] floats
 in vec4 boneWeights; // 'invalid' bones will have zero weight, eliminating their influence in the skinning calculation
+// bone indices may be 32 bit ints, or 8/16 bit unsigned ints (render::BoneIndexFormat) which OpenGL widens to ints
 in ivec4 boneIndices;
 // output attributes, passing data down the pipeline to help the fragment shader perform lighting calculations
 out vec3 world_normal; // The vertex normal in world space